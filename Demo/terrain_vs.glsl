@@ -3,6 +3,38 @@
 uniform mat4 view_world_xform;
 uniform mat4 projection_xform;
 
+// 0 for full precision vertices, 1 for vertices quantised relative to the bounds of their patch, 2 for height only.
+uniform int vertex_format = 0;
+uniform int vertices_per_patch = 1;
+
+// Height only vertices rebuild X and Z from their position within the grid of their patch.
+uniform int patch_divisor = 1;
+uniform vec2 vertex_spacing = vec2(1.0);
+
+// Two texels per patch, the origin of its bounds followed by their extent. The W components hold the X and Z
+// co-ordinates of the first vertex of the patch, patches may be stored in any order.
+uniform samplerBuffer patch_transforms;
+
+// 0 to draw patches, 1 to draw CDLOD nodes and 2 to draw clipmap levels. Every node draws the same grid, placing it using the X and Z co-ordinates
+// of its first vertex and the number of vertices between each point of the grid. Heights are read from a texture with
+// one texel per vertex and vertices morph into the grid of the next level as their distance nears the end of the range.
+uniform int render_mode = 0;
+uniform sampler2D height_map;
+uniform vec2 height_map_size = vec2(1.0);
+uniform vec3 node_transform = vec3(0.0, 0.0, 1.0);
+uniform vec2 morph_range = vec2(0.0, 1.0);
+uniform vec3 camera_position = vec3(0.0);
+
+// 2 to draw clipmap levels. Every level draws the same grid of clipmap_size points, placed using the X and Z
+// co-ordinates of its first vertex and the number of vertices between each point. The W component holds how many points
+// from the outer edge of the level vertices begin to morph into the level beyond. Each level stores its heights in
+// clipmap_heights wrapped around the size of the grid, level_storage holds where the first point is stored and the
+// index of the first height of the level.
+uniform samplerBuffer clipmap_heights;
+uniform int clipmap_size = 1;
+uniform vec4 level_transform = vec4(0.0, 0.0, 1.0, 0.0);
+uniform ivec3 level_storage = ivec3(0);
+
 layout(location=0)
 in vec3 vertex_position;
 
@@ -13,11 +45,106 @@ out vec3 varying_position;
 out vec3 varying_normal;
 out vec3 varying_colour;
 
+vec3 octahedral_decode(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+    if (normal.z < 0.0)
+    {
+        normal.xy = (1.0 - abs(encoded.yx)) * vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+    }
+
+    return normalize(normal);
+}
+
+float sample_height(vec2 vertex)
+{
+    return texture(height_map, (vertex + 0.5) / height_map_size).r;
+}
+
+float clipmap_height(ivec2 point)
+{
+    ivec2 wrapped = (level_storage.xy + point) % clipmap_size;
+    return texelFetch(clipmap_heights, level_storage.z + wrapped.x + wrapped.y * clipmap_size).r;
+}
+
 void main(void)
 {
-	varying_normal = mat3(view_world_xform) * vertex_normal;
-    varying_colour = vertex_normal * 0.5 + 0.5;
-    vec4 view_position = view_world_xform * vec4(vertex_position, 1.0);
+    vec3 position = vertex_position;
+    vec3 normal = vertex_normal;
+
+    if (render_mode == 1)
+    {
+        // Points beyond the edge of the terrain are clamped to it.
+        vec2 last_vertex = height_map_size - 1.0;
+        vec2 grid_vertex = node_transform.xy + vertex_position.xz * node_transform.z;
+        vec2 vertex = min(grid_vertex, last_vertex);
+        vec3 unmorphed = vec3(vertex.x * vertex_spacing.x, sample_height(vertex), vertex.y * vertex_spacing.y);
+
+        // Odd points of the grid slide onto their even neighbour, leaving the grid of the next level when fully morphed.
+        float morph = clamp((distance(unmorphed, camera_position) - morph_range.x) / (morph_range.y - morph_range.x), 0.0, 1.0);
+        vec2 odd = fract(vertex_position.xz * 0.5) * 2.0;
+
+        vertex = min(grid_vertex - odd * node_transform.z * morph, last_vertex);
+        position = vec3(vertex.x * vertex_spacing.x, sample_height(vertex), vertex.y * vertex_spacing.y);
+
+        // The normal is found from the slope of the heights around the vertex, one point of the grid away.
+        float grid_step = node_transform.z;
+        float slope_x = (sample_height(vertex + vec2(grid_step, 0.0)) - sample_height(vertex - vec2(grid_step, 0.0))) / (2.0 * grid_step * vertex_spacing.x);
+        float slope_z = (sample_height(vertex + vec2(0.0, grid_step)) - sample_height(vertex - vec2(0.0, grid_step))) / (2.0 * grid_step * vertex_spacing.y);
+
+        normal = normalize(vec3(-slope_x, 1.0, -slope_z));
+    }
+
+    else if (render_mode == 2)
+    {
+        // Points near the outer edge of the level slide onto their even neighbour, which lies on the grid of the level
+        // beyond, so the edge is fully morphed where the levels meet. Points beyond the edge of the terrain are clamped.
+        ivec2 point = ivec2(vertex_position.xz);
+        ivec2 odd = point & 1;
+        int last_point = clipmap_size - 1;
+        int border = min(min(point.x, point.y), min(last_point - point.x, last_point - point.y));
+        float morph = level_transform.w > 0.0 ? clamp((level_transform.w - float(border)) / level_transform.w, 0.0, 1.0) : 0.0;
+
+        vec2 vertex = clamp(level_transform.xy + (vec2(point) - vec2(odd) * morph) * level_transform.z, vec2(0.0), height_map_size - 1.0);
+        position = vec3(vertex.x * vertex_spacing.x, mix(clipmap_height(point), clipmap_height(point - odd), morph), vertex.y * vertex_spacing.y);
+
+        // The slope is found from the neighbouring points, which are only stored within the level.
+        ivec2 before = max(point - 1, ivec2(0));
+        ivec2 after = min(point + 1, ivec2(last_point));
+        float slope_x = (clipmap_height(ivec2(after.x, point.y)) - clipmap_height(ivec2(before.x, point.y))) / (float(after.x - before.x) * level_transform.z * vertex_spacing.x);
+        float slope_z = (clipmap_height(ivec2(point.x, after.y)) - clipmap_height(ivec2(point.x, before.y))) / (float(after.y - before.y) * level_transform.z * vertex_spacing.y);
+
+        normal = normalize(vec3(-slope_x, 1.0, -slope_z));
+    }
+
+    else if (vertex_format != 0)
+    {
+        // gl_VertexID includes the base vertex so it identifies the patch which owns the vertex, even when stitching.
+        int patch_index = gl_VertexID / vertices_per_patch;
+        vec4 origin = texelFetch(patch_transforms, patch_index * 2);
+        vec4 extent = texelFetch(patch_transforms, patch_index * 2 + 1);
+
+        if (vertex_format == 2)
+        {
+            int local_index = gl_VertexID - patch_index * vertices_per_patch;
+            int grid_x = int(origin.w) + local_index % patch_divisor;
+            int grid_z = int(extent.w) + local_index / patch_divisor;
+
+            position = vec3(grid_x * vertex_spacing.x, origin.y + vertex_position.x * extent.y, grid_z * vertex_spacing.y);
+        }
+
+        else
+        {
+            position = origin.xyz + vertex_position * extent.xyz;
+        }
+
+        normal = octahedral_decode(vertex_normal.xy);
+    }
+
+	varying_normal = mat3(view_world_xform) * normal;
+    varying_colour = normal * 0.5 + 0.5;
+    vec4 view_position = view_world_xform * vec4(position, 1.0);
     varying_position = view_position.xyz;
     gl_Position = projection_xform * view_position;
 }
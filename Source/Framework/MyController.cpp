@@ -4,7 +4,7 @@
 #include <iostream>
 
 MyController::
-MyController()
+MyController(const std::vector<std::string>& arguments)
 {
     camera_move_speed_[0] = 0;
     camera_move_speed_[1] = 0;
@@ -15,6 +15,22 @@ MyController()
     scene_ = std::make_shared<SceneModel::Context>();
     view_ = std::make_shared<MyView>();
     view_->setScene(scene_);
+
+    // the terrain is drawn as patches without benchmarks unless the options say otherwise
+    for (const auto& argument : arguments) {
+        if (argument == "--cdlod") {
+            view_->setRenderMode(Terrain::RenderMode::CDLOD);
+        }
+        else if (argument == "--clipmap") {
+            view_->setRenderMode(Terrain::RenderMode::Clipmap);
+        }
+        else if (argument == "--benchmark") {
+            view_->setBenchmarking(true);
+        }
+        else {
+            std::cout << "Unknown option: " << argument << std::endl;
+        }
+    }
 }
 
 MyController::
@@ -31,6 +47,9 @@ windowControlWillStart(std::shared_ptr<tygra::Window> window)
     std::cout << "  F2: Toggle shading mode" << std::endl;
 	std::cout << "  F3: Reduce camera movement speed" << std::endl;
 	std::cout << "  F4: Increase camera movement speed" << std::endl;
+    std::cout << "  --cdlod: Draw the terrain with CDLOD nodes" << std::endl;
+    std::cout << "  --clipmap: Draw the terrain with a geometry clipmap" << std::endl;
+    std::cout << "  --benchmark: Measure raycasting and validate the culling on start up" << std::endl;
 }
 
 void MyController::
@@ -2,6 +2,8 @@
 
 #include <SceneModel/Context.hpp>
 #include <tygra/WindowControlDelegate.hpp>
+#include <string>
+#include <vector>
 
 class MyView;
 
@@ -9,7 +11,7 @@ class MyController : public tygra::WindowControlDelegate
 {
 public:
 	
-    MyController();
+    explicit MyController(const std::vector<std::string>& arguments);
 
     ~MyController();
 
@@ -2,6 +2,7 @@
 
 
 // STL headers.
+#include <cstddef>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -12,6 +13,7 @@
 
 
 // Personal headers.
+#include <Renderer/QuantisedVertex.hpp>
 #include <Renderer/Vertex.hpp>
 
 
@@ -33,14 +35,24 @@ MeshPool& MeshPool::operator= (MeshPool&& move)
         // Delete the old data.
         clear();
 
-        m_vao       = move.m_vao;
-        m_vertices  = move.m_vertices;
-        m_elements  = move.m_elements;
+        m_vao             = move.m_vao;
+        m_vertices        = move.m_vertices;
+        m_elements        = move.m_elements;
+        m_patchTransforms = move.m_patchTransforms;
+        m_patchTexture    = move.m_patchTexture;
+        m_heights         = move.m_heights;
+        m_heightsTexture  = move.m_heightsTexture;
+        m_format          = move.m_format;
 
         // Reset primitives.
-        move.m_vao      = 0;
-        move.m_vertices = 0;
-        move.m_elements = 0;
+        move.m_vao             = 0;
+        move.m_vertices        = 0;
+        move.m_elements        = 0;
+        move.m_patchTransforms = 0;
+        move.m_patchTexture    = 0;
+        move.m_heights         = 0;
+        move.m_heightsTexture  = 0;
+        move.m_format          = VertexFormat::Float;
     }
 
     return *this;
@@ -54,6 +66,32 @@ MeshPool::~MeshPool()
 }
 
 
+/////////////
+// Getters //
+/////////////
+
+size_t MeshPool::getVertexSize (const VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::Float:
+            return sizeof (Vertex);
+
+        case VertexFormat::Quantised16:
+            return sizeof (QuantisedVertex16);
+
+        case VertexFormat::Quantised8:
+            return sizeof (QuantisedVertex8);
+
+        case VertexFormat::HeightOnly:
+            return sizeof (HeightVertex);
+
+        default:
+            throw std::invalid_argument ("MeshPool::getVertexSize(), given vertex format does not exist.");
+    }
+}
+
+
 /////////////////////
 // Data management //
 /////////////////////
@@ -67,6 +105,10 @@ void MeshPool::generate()
     glGenVertexArrays (1, &m_vao);
     glGenBuffers (1, &m_vertices);
     glGenBuffers (1, &m_elements);
+    glGenBuffers (1, &m_patchTransforms);
+    glGenTextures (1, &m_patchTexture);
+    glGenBuffers (1, &m_heights);
+    glGenTextures (1, &m_heightsTexture);
 }
 
 
@@ -76,15 +118,21 @@ void MeshPool::clear()
     glDeleteVertexArrays (1, &m_vao);
     glDeleteBuffers (1, &m_vertices);
     glDeleteBuffers (1, &m_elements);
+    glDeleteBuffers (1, &m_patchTransforms);
+    glDeleteTextures (1, &m_patchTexture);
+    glDeleteBuffers (1, &m_heights);
+    glDeleteTextures (1, &m_heightsTexture);
 }
 
 
-void MeshPool::initialiseVAO (const GLuint program)
+void MeshPool::initialiseVAO (const GLuint program, const VertexFormat format)
 {
     // Obtain the attribute pointer locations we'll be using to construct the VAO.
     GLint position { glGetAttribLocation (program, "vertex_position") },
           normal   { glGetAttribLocation (program, "vertex_normal") };
 
+    m_format = format;
+
     // Initialise the VAO.
     glBindVertexArray (m_vao);
 
@@ -98,9 +146,43 @@ void MeshPool::initialiseVAO (const GLuint program)
     // Begin creating the vertex attribute pointer from the interleaved buffer.
     glBindBuffer (GL_ARRAY_BUFFER, m_vertices);
 
-    // Set the properties of each attribute pointer.
-    glVertexAttribPointer (position, 3, GL_FLOAT, GL_FALSE, sizeof (Vertex), TGL_BUFFER_OFFSET (0));
-    glVertexAttribPointer (normal,   3, GL_FLOAT, GL_FALSE, sizeof (Vertex), TGL_BUFFER_OFFSET (12));
+    // Set the properties of each attribute pointer. Quantised values are normalised so the shader receives fractions of
+    // the patch extent and an encoded normal between -1 and 1. Missing components default to zero, so a height only
+    // vertex arrives in the X component of the position.
+    const auto stride = (GLint) getVertexSize (format);
+
+    switch (format)
+    {
+        case VertexFormat::Float:
+            glVertexAttribPointer (position, 3, GL_FLOAT, GL_FALSE, stride, TGL_BUFFER_OFFSET (offsetof (Vertex, position)));
+            glVertexAttribPointer (normal,   3, GL_FLOAT, GL_FALSE, stride, TGL_BUFFER_OFFSET (offsetof (Vertex, normal)));
+            break;
+
+        case VertexFormat::Quantised16:
+            glVertexAttribPointer (position, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, TGL_BUFFER_OFFSET (offsetof (QuantisedVertex16, position)));
+            glVertexAttribPointer (normal,   2, GL_SHORT,          GL_TRUE, stride, TGL_BUFFER_OFFSET (offsetof (QuantisedVertex16, normal)));
+            break;
+
+        case VertexFormat::Quantised8:
+            glVertexAttribPointer (position, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, TGL_BUFFER_OFFSET (offsetof (QuantisedVertex8, position)));
+            glVertexAttribPointer (normal,   2, GL_BYTE,           GL_TRUE, stride, TGL_BUFFER_OFFSET (offsetof (QuantisedVertex8, normal)));
+            break;
+
+        case VertexFormat::HeightOnly:
+            glVertexAttribPointer (position, 1, GL_UNSIGNED_SHORT, GL_TRUE, stride, TGL_BUFFER_OFFSET (offsetof (HeightVertex, height)));
+            glVertexAttribPointer (normal,   2, GL_BYTE,           GL_TRUE, stride, TGL_BUFFER_OFFSET (offsetof (HeightVertex, normal)));
+            break;
+
+        default:
+            throw std::invalid_argument ("MeshPool::initialiseVAO(), given vertex format does not exist.");
+    }
+
+    // Texture buffers aren't part of the VAO but the association between the texture and buffer only needs making once.
+    glBindTexture (GL_TEXTURE_BUFFER, m_patchTexture);
+    glTexBuffer (GL_TEXTURE_BUFFER, GL_RGBA32F, m_patchTransforms);
+    glBindTexture (GL_TEXTURE_BUFFER, m_heightsTexture);
+    glTexBuffer (GL_TEXTURE_BUFFER, GL_R32F, m_heights);
+    glBindTexture (GL_TEXTURE_BUFFER, 0);
 
     // Unbind all buffers.
     glBindVertexArray (0);
@@ -111,11 +193,13 @@ void MeshPool::initialiseVAO (const GLuint program)
 
 void MeshPool::fillData (const BufferType buffer, const size_t size, const void* const data)
 {
-    // Simply allocate the data using glBindBuffer.
+    // Simply allocate the data using glBindBuffer. The heights are rewritten a section at a time whilst drawing.
+    const auto usage = buffer == BufferType::Heights ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+
     const auto bufferData = [=] (const GLuint buffer, const GLenum target)
     {
         glBindBuffer (target, buffer);
-        glBufferData (target, size, data, GL_STATIC_DRAW);
+        glBufferData (target, size, data, usage);
         glBindBuffer (target, 0);
 
         // Ensure we have the allocated memory.
@@ -161,6 +245,14 @@ void MeshPool::performBufferOperation (const BufferType buffer, const BufferOper
             operation (m_elements, GL_ELEMENT_ARRAY_BUFFER);
             break;
 
+        case BufferType::PatchTransforms:
+            operation (m_patchTransforms, GL_TEXTURE_BUFFER);
+            break;
+
+        case BufferType::Heights:
+            operation (m_heights, GL_TEXTURE_BUFFER);
+            break;
+
         default:
             throw std::invalid_argument ("MeshPool::performBufferOperation(), given buffer does not exist.");
     }
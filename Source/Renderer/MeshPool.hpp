@@ -17,8 +17,22 @@ using GLuint    = unsigned int;
 /// </summary>
 enum class BufferType : int
 {
-    Vertices = 0, //!< Specifies the vertices VBO.
-    Elements = 1  //!< Specifies the elements VBO.
+    Vertices        = 0,    //!< Specifies the vertices VBO.
+    Elements        = 1,    //!< Specifies the elements VBO.
+    PatchTransforms = 2,    //!< Specifies the texture buffer containing the origin and extent of each patch.
+    Heights         = 3     //!< Specifies the texture buffer containing heights which are updated whilst drawing.
+};
+
+
+/// <summary>
+/// Determines how each vertex is stored in the vertices VBO.
+/// </summary>
+enum class VertexFormat : int
+{
+    Float       = 0,    //!< A full precision Vertex, 24 bytes.
+    Quantised16 = 1,    //!< A QuantisedVertex16 relative to its patch bounds, 12 bytes.
+    Quantised8  = 2,    //!< A QuantisedVertex8 relative to its patch bounds, 8 bytes.
+    HeightOnly  = 3     //!< A HeightVertex, X and Z are rebuilt from the vertex index, 4 bytes.
 };
 
 
@@ -57,6 +71,18 @@ class MeshPool final
         /// <summary> Gets the ID of the VBO used to store element data for all meshes contained. </summary>
         const GLuint& getElementsVBO() const    { return m_elements; }
 
+        /// <summary> Gets the ID of the texture buffer containing the origin and extent of each patch. </summary>
+        const GLuint& getPatchTexture() const   { return m_patchTexture; }
+
+        /// <summary> Gets the ID of the texture buffer containing the heights, one R32F texel each. </summary>
+        const GLuint& getHeightsTexture() const { return m_heightsTexture; }
+
+        /// <summary> Gets the format the VAO was last initialised with. </summary>
+        VertexFormat getVertexFormat() const    { return m_format; }
+
+        /// <summary> Gets how many bytes a single vertex occupies in the given format. </summary>
+        static size_t getVertexSize (const VertexFormat format);
+
 
         /////////////////////
         // Data management //
@@ -68,11 +94,18 @@ class MeshPool final
         /// <summary> Deletes the buffers and VAO associated with the MeshPool </summary>
         void clear();
 
-        /// <summary> Initialises the VAO ready for renderering. </summary>
+        /// <summary> 
+        /// Initialises the VAO ready for renderering. Quantised formats read the origin and extent of each patch from the 
+        /// patch transforms buffer, two RGBA32F texels per patch, through the texture given by getPatchTexture().
+        /// </summary>
         /// <param name="program"> The program to obtain attribute location from. </param>
-        void initialiseVAO (const GLuint program);
+        /// <param name="format"> How each vertex is stored in the vertices VBO. </param>
+        void initialiseVAO (const GLuint program, const VertexFormat format = VertexFormat::Float);
 
-        /// <summary> Fills the desired buffer with the given data. This will completely wipe the previous contents. </summary>
+        /// <summary> 
+        /// Fills the desired buffer with the given data. This will completely wipe the previous contents. The heights 
+        /// buffer is expected to be modified regularly, every other buffer is expected to be written once.
+        /// </summary>
         /// <param name="buffer"> The buffer to fill with data. </param>
         /// <param name="size"> The amount of data to allocate in bytes. </param>
         /// <param name="data"> A pointer to the data to fill the buffer with. This can be a nullptr. </param>
@@ -105,9 +138,14 @@ class MeshPool final
         // Internal data //
         ///////////////////
 
-        GLuint  m_vao         { 0 };    //!< The vertex array object to bind when drawing from the pool.
-        GLuint  m_vertices    { 0 };    //!< A buffer containing the attributes of each vertex for every mesh stored.
-        GLuint  m_elements    { 0 };    //!< An elements index buffer for every mesh.
+        GLuint          m_vao               { 0 };                      //!< The vertex array object to bind when drawing from the pool.
+        GLuint          m_vertices          { 0 };                      //!< A buffer containing the attributes of each vertex for every mesh stored.
+        GLuint          m_elements          { 0 };                      //!< An elements index buffer for every mesh.
+        GLuint          m_patchTransforms   { 0 };                      //!< A buffer containing the origin and extent of each patch.
+        GLuint          m_patchTexture      { 0 };                      //!< A texture buffer which lets shaders read the patch transforms.
+        GLuint          m_heights           { 0 };                      //!< A buffer containing heights which are updated whilst drawing.
+        GLuint          m_heightsTexture    { 0 };                      //!< A texture buffer which lets shaders read the heights.
+        VertexFormat    m_format            { VertexFormat::Float };    //!< How each vertex is stored.
 };
 
 #endif
\ No newline at end of file
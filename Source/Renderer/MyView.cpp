@@ -3,7 +3,10 @@
 
 // STL headers.
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <random>
 #include <vector>
 
 
@@ -173,8 +176,8 @@ void MyView::terrainLoading()
                 height = m_scene->getTerrainSizeY(),    
                 depth  = m_scene->getTerrainSizeZ();
 
-    // Use this to control the scale of the terrain. Shrink can be set to 1 which will produce an 8Kx8K grid,
-    // this will work perfectly but the frame rate will be too low due to lack of frustum culling.
+    // Use this to control the scale of the terrain. Shrink can be set to 1 which will produce an 8Kx8K grid, patches
+    // off-screen or behind hills are culled so it draws fine, but it takes four times the memory and loading time.
     const auto  shrink       = 2U,
                 terrainWidth = (unsigned int) width / shrink,
                 terrainDepth = (unsigned int) depth / shrink;
@@ -185,6 +188,11 @@ void MyView::terrainLoading()
     // Load the height map with the desired values.
     const HeightMap heightMap { file, scale };
 
+    const auto& timings = heightMap.getLoadTimings();
+
+    std::cout << "Height map loaded: " << timings.decodeMilliseconds << "ms decoding, " 
+              << timings.convertMilliseconds << "ms converting." << std::endl;
+
     // Time for some noise. We'll use the industry standard 1/f noise with 2 lacunarity.
     const auto lacunarity  = 2.f,
                gain        = 1 / lacunarity;
@@ -194,8 +202,317 @@ void MyView::terrainLoading()
                heightNoise = NoiseArgs (2U, 0.025f, lacunarity, gain, scale.y * 0.0087f);
 
     // Build the terrain and get it ready for rendering.
+    // Quantised vertices take half the memory of full precision vertices with no visible difference, likewise strips
+    // of 16-bit indices take a quarter of the memory of 32-bit triangle lists. Morton ordered patches are drawn in runs.
+    // Clusters of 8x8 quads let the camera skip the parts of each patch which are off-screen or facing away.
+    // Patches hidden behind hills are skipped by testing them against the horizon and a CPU depth buffer.
+    // Patches are also decimated to within a small fraction of the height of the terrain for drawing at a distance,
+    // the result is baked next to the height map so later runs only load it.
+    // The CDLOD and clipmap modes can be chosen from the command line instead, they draw a grid of their own so the
+    // vertex format, element mode, clusters, decimation and sorting above don't apply to them.
+    m_terrain.setVertexFormat (VertexFormat::Quantised16);
+    m_terrain.setElementMode (Terrain::ElementMode::Strips16);
+    m_terrain.setPatchLayout (Terrain::PatchLayout::Morton);
+    m_terrain.setClusterSize (8);
+    m_terrain.setHorizonCulling (true);
+    m_terrain.setOcclusionCulling (true);
+    m_terrain.setPatchSorting (true);
+    m_terrain.setOverdrawEstimation (m_benchmark);
+    m_terrain.setRenderMode (m_renderMode);
+    m_terrain.setDecimationError (scale.y * 0.001f);
+    m_terrain.setDecimationBakeFile (file + ".decimated");
     m_terrain.buildFromHeightMap (heightMap, normalNoise, heightNoise, terrainWidth, terrainDepth);
     m_terrain.prepareForRender (m_terrainShader);
+
+    // Show how much the triangle list templates gained from vertex cache optimisation. ACMR is the number of vertices
+    // transformed per triangle and ATVR is the number of times each vertex is transformed, lower is better for both.
+    for (const auto& report : m_terrain.getVertexCacheReport())
+    {
+        std::cout << "Vertex cache, " << report.name << " template: "
+                  << "FIFO ACMR " << report.fifoBefore.acmr << " -> " << report.fifoAfter.acmr 
+                  << ", ATVR " << report.fifoBefore.atvr << " -> " << report.fifoAfter.atvr
+                  << ", LRU ACMR " << report.lruBefore.acmr << " -> " << report.lruAfter.acmr 
+                  << ", ATVR " << report.lruBefore.atvr << " -> " << report.lruAfter.atvr << std::endl;
+    }
+
+    // Show how many triangles decimation removed from the patches of this map.
+    const auto& decimation = m_terrain.getDecimator().getStatistics();
+
+    if (decimation.trianglesBefore > 0)
+    {
+        std::cout << "Decimation, " << file << ": " << decimation.trianglesBefore << " -> " << decimation.trianglesAfter 
+                  << " triangles (" << 100.0 * decimation.trianglesAfter / decimation.trianglesBefore << "%), " 
+                  << decimation.vertices << " vertices, " << decimation.error << " max error, " 
+                  << (decimation.loaded ? "loaded in " : "decimated in ") << decimation.milliseconds << "ms." << std::endl;
+    }
+
+    // Validating and measuring the culling flips the renderer state every frame and casting thousands of rays takes a
+    // while, so they're only done when asked for.
+    if (m_benchmark)
+    {
+        benchmarkRaycasting();
+        benchmarkCulling();
+    }
+}
+
+
+////////////////
+// Benchmarks //
+////////////////
+
+void MyView::benchmarkRaycasting()
+{
+    // Measure picking performance by casting a batch of rays from above the terrain at random angles.
+    const auto scale     = glm::vec3 (m_scene->getTerrainSizeX(), m_scene->getTerrainSizeY(), -m_scene->getTerrainSizeZ());
+    const auto raycaster = m_terrain.getRaycaster();
+    const auto rayCount  = 1U << 16;
+    
+    std::mt19937 generator { 0 };
+    std::uniform_real_distribution<float> positionX { 0.f, scale.x }, positionZ { scale.z, 0.f }, slope { -1.f, 1.f };
+
+    std::vector<HeightRaycaster::Ray> rays (rayCount);
+    std::vector<HeightRaycaster::Hit> hits (rayCount);
+
+    for (auto& ray : rays)
+    {
+        ray = { glm::vec3 (positionX (generator), scale.y * 2.f, positionZ (generator)), 
+                glm::vec3 (slope (generator), -1.f, slope (generator)) };
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    raycaster.cast (rays.data(), rays.size(), hits.data());
+    const auto seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+
+    const auto hitCount = std::count_if (hits.cbegin(), hits.cend(), [] (const HeightRaycaster::Hit& hit) { return hit.hit; });
+
+    std::cout << "Raycast benchmark: " << rayCount << " rays, " << hitCount << " hits in " << seconds * 1000.0 << "ms, " 
+              << (unsigned int) (rayCount / seconds) << " rays/sec." << std::endl;
+}
+
+
+void MyView::benchmarkCulling()
+{
+    // Measure patch and cluster culling along a recorded path, circling the centre of the terrain whilst skimming the
+    // surface.
+    const auto  scale       = glm::vec3 (m_scene->getTerrainSizeX(), m_scene->getTerrainSizeY(), -m_scene->getTerrainSizeZ());
+    const auto  heightQuery = m_terrain.getHeightQuery();
+    const auto  raycaster   = m_terrain.getRaycaster();
+    const auto& camera      = m_scene->getCamera();
+    const auto  projection  = glm::perspective (camera.getVerticalFieldOfViewInDegrees(), 16.f / 9.f, 
+                                                camera.getNearPlaneDistance(), camera.getFarPlaneDistance());
+    const auto  keyframes   = 64U;
+    const auto  pixelHeight = 1080.f;
+    const auto  centre      = glm::vec3 (scale.x * 0.5f, 0.f, scale.z * 0.5f);
+    const auto  radius      = glm::vec3 (scale.x * 0.35f, 0.f, scale.z * 0.35f);
+
+    size_t visiblePatches { 0 }, nodesVisited { 0 }, flatMismatches { 0 }, horizonTested { 0 }, horizonOccluded { 0 }, occlusionTested { 0 }, occlusionOccluded { 0 }, 
+           occluderTriangles { 0 }, shapesOccluded { 0 }, falseOcclusions { 0 }, clusters { 0 }, frustumCulled { 0 }, backFacingCulled { 0 }, trianglesBefore { 0 }, trianglesAfter { 0 },
+           lodVisited { 0 }, lodSelected { 0 }, lodDraws { 0 }, lodTriangles { 0 }, sortedRuns { 0 }, 
+           sortedDraws { 0 }, unsortedDraws { 0 };
+
+    std::vector<unsigned int> flatVisible { };
+
+    // Only the patches mode culls the patches, the others select their own geometry.
+    const auto patchMode = m_terrain.getRenderMode() == Terrain::RenderMode::Patches;
+
+    // The culling and sorting are switched off to validate them so remember how they were configured.
+    const auto cullHorizon   = m_terrain.getHorizonCulling(),
+               cullOcclusion = m_terrain.getOcclusionCulling(),
+               sortPatches   = m_terrain.getPatchSorting();
+
+    // The shapes sit on the surface so they can be tested against the occlusion buffer.
+    const auto& shapePositions = m_scene->getAllShapePositions();
+    std::vector<glm::vec3> shapes (shapePositions.size());
+
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        shapes[i] = glm::vec3 (shapePositions[i].x, 0.f, -shapePositions[i].y);
+
+        if (heightQuery.isValid())
+        {
+            heightQuery.sample (&shapes[i].x, &shapes[i].z, 1, &shapes[i].y);
+        }
+    }
+
+    // Samples a grid of points over the surface of a patch, counting those which can be seen from the camera.
+    const auto countVisibleSamples = [&] (const PatchBounds& bounds, const unsigned int patch, const glm::vec3& camera, const util::Frustum& frustum)
+    {
+        const auto samples = 8U;
+        const auto minimum = bounds.getMinimum (patch),
+                   maximum = bounds.getMaximum (patch);
+
+        size_t visibleSamples { 0 };
+
+        for (auto z = 0U; z <= samples; ++z)
+        {
+            for (auto x = 0U; x <= samples; ++x)
+            {
+                auto point = glm::vec3 (minimum.x + (maximum.x - minimum.x) * x / samples, 0.f, 
+                                        minimum.z + (maximum.z - minimum.z) * z / samples);
+
+                heightQuery.sample (&point.x, &point.z, 1, &point.y);
+
+                // Stop just short of the surface so the ray can't hit the point itself.
+                if (frustum.intersects (point, point) && !raycaster.isOccluded (camera, glm::mix (camera, point, 0.999f)))
+                {
+                    ++visibleSamples;
+                }
+            }
+        }
+
+        return visibleSamples;
+    };
+    double cullSeconds { 0.0 }, flatSeconds { 0.0 }, rasteriseMilliseconds { 0.0 }, testMilliseconds { 0.0 }, 
+           sortMilliseconds { 0.0 }, estimateMilliseconds { 0.0 }, overdrawBefore { 0.0 }, overdrawAfter { 0.0 };
+
+    for (auto frame = 0U; frame < keyframes; ++frame)
+    {
+        const auto angle    = frame * 6.2831853f / keyframes;
+        auto       position = centre + radius * glm::vec3 (std::cos (angle), 0.f, std::sin (angle));
+        const auto ahead    = centre + radius * glm::vec3 (std::cos (angle + 0.3f), 0.f, std::sin (angle + 0.3f));
+
+        if (heightQuery.isValid())
+        {
+            heightQuery.sample (&position.x, &position.z, 1, &position.y);
+        }
+
+        position.y += scale.y * 0.25f;
+
+        const auto projectionView = projection * glm::lookAt (position, ahead, glm::vec3 (0.f, 1.f, 0.f));
+        const auto cullStart      = std::chrono::steady_clock::now();
+
+        m_terrain.cull (projectionView, position, pixelHeight);
+
+        const auto cullEnd = std::chrono::steady_clock::now();
+
+        cullSeconds += std::chrono::duration<double> (cullEnd - cullStart).count();
+
+        for (const auto& shape : shapes)
+        {
+            shapesOccluded += m_terrain.isOccluded (shape - glm::vec3 (0.5f, 0.f, 0.5f), shape + glm::vec3 (0.5f, 1.f, 0.5f));
+        }
+
+        occluderTriangles     += m_terrain.getOcclusionStatistics().triangles;
+        rasteriseMilliseconds += m_terrain.getOcclusionStatistics().rasteriseMilliseconds;
+        lodVisited            += m_terrain.getLodQuadtree().getStatistics().nodesVisited;
+        lodSelected           += m_terrain.getLodQuadtree().getStatistics().nodesSelected;
+        lodDraws              += m_terrain.getLodQuadtree().getStatistics().draws;
+        lodTriangles          += m_terrain.getLodQuadtree().getStatistics().triangles;
+
+        // The CDLOD and clipmap modes don't cull the patches, only the occluders are rasterised for the shapes.
+        if (!patchMode)
+        {
+            continue;
+        }
+
+        // Testing every patch individually should find exactly the same patches as the quadtree, which is checked below
+        // once the horizon and occlusion culling are switched off.
+        m_terrain.getPatchBounds().cull (util::Frustum { projectionView }, flatVisible);
+
+        flatSeconds += std::chrono::duration<double> (std::chrono::steady_clock::now() - cullEnd).count();
+
+        const auto& statistics = m_terrain.getClusterStatistics();
+        visiblePatches   += m_terrain.getVisiblePatchCount();
+        nodesVisited     += m_terrain.getPatchQuadtree().getStatistics().nodesVisited;
+        horizonTested    += m_terrain.getHorizonStatistics().tested;
+        horizonOccluded  += m_terrain.getHorizonStatistics().occluded;
+        occlusionTested   += m_terrain.getOcclusionStatistics().tested;
+        occlusionOccluded += m_terrain.getOcclusionStatistics().occluded;
+        testMilliseconds      += m_terrain.getOcclusionStatistics().testMilliseconds;
+        sortMilliseconds      += m_terrain.getSortStatistics().sortMilliseconds;
+        estimateMilliseconds  += m_terrain.getSortStatistics().estimateMilliseconds;
+        overdrawBefore        += m_terrain.getSortStatistics().overdrawBefore;
+        overdrawAfter         += m_terrain.getSortStatistics().overdrawAfter;
+        sortedRuns            += m_terrain.getSortStatistics().runs;
+        sortedDraws           += m_terrain.countPatchDraws();
+        clusters         += statistics.clusters;
+        frustumCulled    += statistics.frustumCulled;
+        backFacingCulled += statistics.backFacingCulled;
+        trianglesBefore  += statistics.trianglesBefore;
+        trianglesAfter   += statistics.trianglesAfter;
+
+        // Sorting whole runs front to back shouldn't need any more draws than leaving the patches in the order they're stored.
+        m_terrain.setPatchSorting (false);
+        m_terrain.cull (projectionView, position, pixelHeight);
+        m_terrain.setPatchSorting (sortPatches);
+
+        unsortedDraws += m_terrain.countPatchDraws();
+
+        // Validate the horizon and occlusion buffer by casting rays at every patch they removed, none of them should
+        // reach their target. The visible patches are sorted front to back so they must be put back in order first.
+        auto withOcclusion = m_terrain.getVisiblePatches();
+        std::sort (withOcclusion.begin(), withOcclusion.end());
+
+        m_terrain.setHorizonCulling (false);
+        m_terrain.setOcclusionCulling (false);
+        m_terrain.cull (projectionView, position, pixelHeight);
+        m_terrain.setHorizonCulling (cullHorizon);
+        m_terrain.setOcclusionCulling (cullOcclusion);
+
+        // With only the frustum left the quadtree should find exactly the same patches as testing every patch.
+        auto frustumOnly = m_terrain.getVisiblePatches();
+        std::sort (frustumOnly.begin(), frustumOnly.end());
+        std::sort (flatVisible.begin(), flatVisible.end());
+
+        flatMismatches += frustumOnly != flatVisible;
+
+        for (const auto patch : m_terrain.getVisiblePatches())
+        {
+            if (!std::binary_search (withOcclusion.cbegin(), withOcclusion.cend(), patch))
+            {
+                falseOcclusions += countVisibleSamples (m_terrain.getPatchBounds(), patch, position, util::Frustum { projectionView });
+            }
+        }
+
+        m_terrain.cull (projectionView, position, pixelHeight);
+    }
+
+    if (!patchMode)
+    {
+        std::cout << "Occlusion culling: " << shapesOccluded / keyframes << " of " << shapes.size() << " shapes per frame hidden, "
+                  << occluderTriangles / keyframes << " occluder triangles rasterised in " << rasteriseMilliseconds / keyframes 
+                  << "ms per frame." << std::endl;
+    }
+
+    else
+    {
+        std::cout << "Patch culling: " << keyframes << " frames, " << visiblePatches / keyframes << " visible and " 
+                  << m_terrain.getPatchCount() - visiblePatches / keyframes << " culled of " << m_terrain.getPatchCount() 
+                  << " patches per frame." << std::endl;
+
+        std::cout << "Patch quadtree: " << nodesVisited / keyframes << " nodes visited per frame, testing every patch took " 
+                  << flatSeconds * 1000.0 / keyframes << "ms per frame and disagreed in " << flatMismatches << " frames." << std::endl;
+
+        std::cout << "Horizon culling: " << horizonOccluded / keyframes << " of " << horizonTested / keyframes 
+                  << " patches per frame hidden by nearer terrain." << std::endl;
+
+        std::cout << "Occlusion culling: " << occlusionOccluded / keyframes << " of " << occlusionTested / keyframes 
+                  << " patches and " << shapesOccluded / keyframes << " of " << shapes.size() << " shapes per frame hidden, "
+                  << occluderTriangles / keyframes << " occluder triangles rasterised in " << rasteriseMilliseconds / keyframes 
+                  << "ms and tested in " << testMilliseconds / keyframes << "ms per frame, " << falseOcclusions 
+                  << " visible samples on hidden patches." << std::endl;
+
+        std::cout << "Patch sorting: " << sortedRuns / keyframes << " runs sorted front to back in " << sortMilliseconds / keyframes 
+                  << "ms per frame, " << unsortedDraws / keyframes << " -> " << sortedDraws / keyframes << " draws per frame, estimated overdraw " 
+                  << overdrawBefore / keyframes << " -> " << overdrawAfter / keyframes << " estimated in " 
+                  << estimateMilliseconds / keyframes << "ms per frame." << std::endl;
+
+        std::cout << "Cluster culling: " << clusters / keyframes << " clusters per frame, "
+                  << frustumCulled / keyframes << " outside the frustum, " << backFacingCulled / keyframes << " facing away, "
+                  << trianglesBefore / keyframes << " -> " << trianglesAfter / keyframes << " triangles per frame in " 
+                  << cullSeconds * 1000.0 / keyframes << "ms per frame including the quadtree." << std::endl;
+    }
+
+    if (m_terrain.getRenderMode() == Terrain::RenderMode::CDLOD)
+    {
+        const auto& pyramid = m_terrain.getHeightPyramid();
+        const auto  full    = (size_t) (pyramid.getWidth() - 1) * (pyramid.getDepth() - 1) * 2;
+
+        std::cout << "CDLOD: " << lodSelected / keyframes << " of " << lodVisited / keyframes << " nodes visited drawn with " 
+                  << lodDraws / keyframes << " draws, " << lodTriangles / keyframes << " triangles per frame instead of " 
+                  << full << " in the whole terrain at full resolution, culled in " << cullSeconds * 1000.0 / keyframes 
+                  << "ms per frame." << std::endl;
+    }
 }
 
 
@@ -269,6 +586,7 @@ void MyView::windowViewRender (std::shared_ptr<tygra::Window> window)
     glUniformMatrix4fv(view_world_xform_id, 1, GL_FALSE,
                        glm::value_ptr(view_world_xform));
 
+    m_terrain.cull(projection_xform * view_xform, camera_pos, (float)viewport[3]);
     m_terrain.draw();
     //glBindVertexArray(m_terrainMesh.vao);
     //glDrawElements(GL_TRIANGLES, m_terrainMesh.element_count, GL_UNSIGNED_INT, 0);
@@ -287,9 +605,35 @@ void MyView::windowViewRender (std::shared_ptr<tygra::Window> window)
 
     glBindVertexArray(m_cubeVAO);
 
-    for (const auto& pos : m_scene->getAllShapePositions())
+    // Sit each shape on the terrain surface, querying every position in one batch.
+    const auto& positions = m_scene->getAllShapePositions();
+    std::vector<float> shape_x (positions.size()), shape_z (positions.size()), 
+                       shape_heights (positions.size(), 64.f);
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        shape_x[i] = positions[i].x;
+        shape_z[i] = -positions[i].y;
+    }
+
+    const auto heightQuery = m_terrain.getHeightQuery();
+
+    if (heightQuery.isValid())
     {
-        world_xform = glm::translate(glm::mat4(1), glm::vec3(pos.x, 64, -pos.y));
+        heightQuery.sample(shape_x.data(), shape_z.data(), positions.size(), shape_heights.data());
+    }
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        // Skip shapes hidden behind the terrain, the cube spans a unit around its base.
+        const auto shape_base = glm::vec3(shape_x[i], shape_heights[i], shape_z[i]);
+
+        if (m_terrain.isOccluded(shape_base - glm::vec3(0.5f, 0.f, 0.5f), shape_base + glm::vec3(0.5f, 1.f, 0.5f)))
+        {
+            continue;
+        }
+
+        world_xform = glm::translate(glm::mat4(1), glm::vec3(shape_x[i], shape_heights[i], shape_z[i]));
         view_world_xform = view_xform * world_xform;
 
         view_world_xform_id = glGetUniformLocation(m_shapesShader,
@@ -52,6 +52,14 @@ class MyView final : public tygra::WindowViewDelegate
         /// </summary>
         void toggleShading() { m_shadeNormals = ++m_shadeNormals % shadingModesAvailable; }
 
+        /// <summary> Set how the terrain is drawn, this must be called before the window starts to have any effect. </summary>
+        /// <param name="mode"> The render mode to build the terrain with. </param>
+        void setRenderMode (const Terrain::RenderMode mode) { m_renderMode = mode; }
+
+        /// <summary> Set whether the terrain is measured and validated once it's loaded, this must be called before the window starts. </summary>
+        /// <param name="benchmark"> Whether to run the benchmarks. </param>
+        void setBenchmarking (const bool benchmark) { m_benchmark = benchmark; }
+
     private:
 
         ////////////////////
@@ -68,6 +76,20 @@ class MyView final : public tygra::WindowViewDelegate
         void terrainLoading();
 
 
+        ////////////////
+        // Benchmarks //
+        ////////////////
+
+        /// <summary> Measures picking performance by casting a batch of rays at the terrain from random points above it. </summary>
+        void benchmarkRaycasting();
+
+        /// <summary> 
+        /// Measures patch culling along a recorded path and validates the horizon and occlusion culling by casting rays at
+        /// every patch they remove. The culling is switched on and off each frame so this is only run when asked for.
+        /// </summary>
+        void benchmarkCulling();
+
+
         //////////////
         // Clean up //
         //////////////
@@ -100,6 +122,8 @@ class MyView final : public tygra::WindowViewDelegate
 	    GLuint                                      m_cubeVBO       { 0 };          //!< The ID of the VBO containing the vertices of a cube.
 
         int                                         m_shadeNormals  { 0 };          //!< Determines whether the terrain should be shaded in white or in pastel with its normal vector.
+        Terrain::RenderMode                         m_renderMode    { Terrain::RenderMode::Patches };   //!< How the terrain is drawn, the patches unless asked otherwise.
+        bool                                        m_benchmark     { false };      //!< Whether the terrain is measured and validated once it's loaded.
         
         std::shared_ptr<const SceneModel::Context>  m_scene         { nullptr };    //!< A poiner to the context used for camera information when rendering the scene.
 
@@ -0,0 +1,117 @@
+#ifndef QUANTISED_VERTEX_3GP_HPP
+#define QUANTISED_VERTEX_3GP_HPP
+
+
+// STL headers.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Personal headers.
+#include <Renderer/Vertex.hpp>
+#include <Utility/Octahedral.hpp>
+
+
+/// <summary>
+/// A vertex stored relative to the bounds of its patch. Each position component is a 16-bit fraction of the patch extent
+/// and the normal is octahedral encoded into two signed components, NormalType decides their precision. The vertex
+/// shader rebuilds the world position using the origin and extent of the patch which owns the vertex. Vertices are
+/// aligned to four bytes so each one starts on a boundary the GPU can fetch efficiently.
+/// </summary>
+template <typename NormalType>
+struct alignas (4) QuantisedVertex final
+{
+    //////////
+    // Data //
+    //////////
+
+    uint16_t    position[3];    //!< The position within the patch bounds, 0 is the origin and 65535 is the far corner.
+    NormalType  normal[2];      //!< The octahedral encoded normal, scaled to fill the range of the type.
+
+
+    //////////////////////
+    // Public interface //
+    //////////////////////
+
+    /// <summary> Quantises a vertex relative to the bounds of its patch. </summary>
+    /// <param name="vertex"> The full precision vertex. </param>
+    /// <param name="origin"> The minimum corner of the patch bounds. </param>
+    /// <param name="inverseExtent"> One over the size of the patch bounds on each axis, zero if the patch is flat on that axis. </param>
+    static QuantisedVertex quantise (const Vertex& vertex, const glm::vec3& origin, const glm::vec3& inverseExtent)
+    {
+        const auto positionMax = 65535.f,
+                   normalMax   = (float) std::numeric_limits<NormalType>::max();
+
+        const auto relative = (vertex.position - origin) * inverseExtent;
+        const auto encoded  = util::octahedralEncode (vertex.normal);
+
+        QuantisedVertex quantised;
+
+        for (auto i = 0; i < 3; ++i)
+        {
+            quantised.position[i] = (uint16_t) std::lround (std::min (std::max (relative[i], 0.f), 1.f) * positionMax);
+        }
+
+        for (auto i = 0; i < 2; ++i)
+        {
+            quantised.normal[i] = (NormalType) std::lround (std::min (std::max (encoded[i], -1.f), 1.f) * normalMax);
+        }
+
+        return quantised;
+    }
+};
+
+
+/// <summary> 12 bytes per vertex, including two bytes of padding. </summary>
+using QuantisedVertex16 = QuantisedVertex<int16_t>;
+
+/// <summary> 8 bytes per vertex, a third of the size of a full precision Vertex. </summary>
+using QuantisedVertex8  = QuantisedVertex<int8_t>;
+
+
+/// <summary>
+/// The smallest vertex, only the height is stored because the X and Z co-ordinates are rebuilt by the vertex shader from
+/// the position of the vertex within the grid of its patch. The height is a 16-bit fraction of the height range of the
+/// patch and the normal is octahedral encoded into two bytes, four bytes in total.
+/// </summary>
+struct alignas (4) HeightVertex final
+{
+    //////////
+    // Data //
+    //////////
+
+    uint16_t    height;     //!< The height within the patch bounds, 0 is the lowest height and 65535 is the highest.
+    int8_t      normal[2];  //!< The octahedral encoded normal.
+
+
+    //////////////////////
+    // Public interface //
+    //////////////////////
+
+    /// <summary> Quantises the height and normal of a vertex relative to the height range of its patch. </summary>
+    /// <param name="vertex"> The full precision vertex. </param>
+    /// <param name="origin"> The minimum corner of the patch bounds. </param>
+    /// <param name="inverseExtent"> One over the size of the patch bounds on each axis, zero if the patch is flat on that axis. </param>
+    static HeightVertex quantise (const Vertex& vertex, const glm::vec3& origin, const glm::vec3& inverseExtent)
+    {
+        // Reuse the full quantisation so the height and normal are encoded identically.
+        const auto quantised = QuantisedVertex8::quantise (vertex, origin, inverseExtent);
+
+        HeightVertex result;
+
+        result.height    = quantised.position[1];
+        result.normal[0] = quantised.normal[0];
+        result.normal[1] = quantised.normal[1];
+
+        return result;
+    }
+};
+
+
+#endif // QUANTISED_VERTEX_3GP_HPP
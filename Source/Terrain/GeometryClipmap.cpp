@@ -0,0 +1,282 @@
+#include "GeometryClipmap.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+
+// Personal headers.
+#include <Terrain/HeightSource.hpp>
+#include <Utility/ElementCreation.hpp>
+
+
+
+namespace
+{
+    /// <summary> Rounds down to the nearest even number. </summary>
+    int floorEven (const float value)
+    {
+        return (int) std::floor (value * 0.5f) * 2;
+    }
+}
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+GeometryClipmap::GeometryClipmap (const unsigned int size)
+    : m_size (size)
+{
+    // Each level must hold an odd number of quads on either side of the centre so that the hole of every ring can only
+    // be placed two ways on each axis.
+    assert (size >= 15 && ((size + 1) & size) == 0);
+}
+
+
+GeometryClipmap::GeometryClipmap (GeometryClipmap&& move)
+{
+    *this = std::move (move);
+}
+
+
+GeometryClipmap& GeometryClipmap::operator= (GeometryClipmap&& move)
+{
+    if (this != &move)
+    {
+        m_heights    = std::move (move.m_heights);
+        m_levels     = std::move (move.m_levels);
+        m_sections   = std::move (move.m_sections);
+        m_size       = move.m_size;
+        m_filled     = move.m_filled;
+        m_statistics = move.m_statistics;
+
+        // Reset primitives.
+        move.m_filled = false;
+    }
+
+    return *this;
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+unsigned int GeometryClipmap::getLevelsToCover (const unsigned int width, const unsigned int depth) const
+{
+    // The coarsest level reaches at least half of its quads from the camera in every direction.
+    const auto furthest = std::max (width, depth);
+
+    auto levels = 1U;
+
+    while ((size_t) (m_size - 1) / 2 << (levels - 1) < furthest)
+    {
+        ++levels;
+    }
+
+    return levels;
+}
+
+
+size_t GeometryClipmap::getIndex (const unsigned int level, const int x, const int z) const
+{
+    const auto size  = (int) m_size,
+               wrapX = (x % size + size) % size,
+               wrapZ = (z % size + size) % size;
+
+    return (size_t) level * m_size * m_size + wrapX + (size_t) wrapZ * m_size;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void GeometryClipmap::build (const unsigned int levelCount)
+{
+    clear();
+
+    m_heights.resize ((size_t) levelCount * m_size * m_size);
+    m_levels.resize (levelCount);
+}
+
+
+void GeometryClipmap::clear()
+{
+    m_heights.clear();
+    m_levels.clear();
+    m_sections.clear();
+
+    m_filled     = false;
+    m_statistics = Statistics { };
+}
+
+
+void GeometryClipmap::update (const glm::vec2& cameraVertex, const HeightSource& source)
+{
+    m_sections.clear();
+    m_statistics = Statistics { };
+
+    if (m_levels.empty())
+    {
+        return;
+    }
+
+    // Levels are measured in quads. The finest level is centred on the camera and begins on an even vertex, so its
+    // even points lie on the grid of the level beyond. A level fills half of the quads of the level beyond it, leaving
+    // an odd number of quads for the ring around it, so the ring is one quad wider on one side. The side is chosen so
+    // the level beyond also begins on one of its even points.
+    const auto size   = (int) m_size,
+               half   = (size - 1) / 2,
+               offset = (half - 1) / 2;
+
+    Level placement { };
+    placement.x     = floorEven (cameraVertex.x - half);
+    placement.z     = floorEven (cameraVertex.y - half);
+    placement.shape = solidTemplate;
+
+    for (auto index = 0U; index < m_levels.size(); ++index)
+    {
+        auto&      level  = m_levels[index];
+        const auto shiftX = placement.x - level.x,
+                   shiftZ = placement.z - level.z;
+
+        if (!m_filled || std::abs (shiftX) >= size || std::abs (shiftZ) >= size)
+        {
+            read (index, placement.x, placement.z, size, size, source);
+            ++m_statistics.levelsMoved;
+        }
+
+        else if (shiftX != 0 || shiftZ != 0)
+        {
+            // Rows entering the level span every column, columns entering only need the rows which were kept.
+            const auto keptZ  = std::max (level.z, placement.z),
+                       kept   = size - std::abs (shiftZ);
+
+            if (shiftZ != 0)
+            {
+                read (index, placement.x, shiftZ > 0 ? level.z + size : placement.z, size, std::abs (shiftZ), source);
+            }
+
+            if (shiftX != 0)
+            {
+                read (index, shiftX > 0 ? level.x + size : placement.x, keptZ, std::abs (shiftX), kept, source);
+            }
+
+            ++m_statistics.levelsMoved;
+        }
+
+        level = placement;
+
+        // Find where the next level begins.
+        const auto firstX = placement.x / 2,
+                   firstZ = placement.z / 2,
+                   ringX  = (firstX - offset) % 2 == 0 ? offset : offset + 1,
+                   ringZ  = (firstZ - offset) % 2 == 0 ? offset : offset + 1;
+
+        placement.x     = firstX - ringX;
+        placement.z     = firstZ - ringZ;
+        placement.shape = (unsigned int) ((ringX - offset) + (ringZ - offset) * 2);
+    }
+
+    m_filled = true;
+
+    m_statistics.sections = m_sections.size();
+}
+
+
+void GeometryClipmap::addElements (std::vector<unsigned int>& elements, const unsigned int shape) const
+{
+    assert (shape < templateCount);
+
+    // The level inside covers half of the quads on each axis, starting after the narrow side of the ring.
+    const auto quads  = m_size - 1,
+               half   = quads / 2,
+               offset = (half - 1) / 2,
+               holeX  = offset + (shape & 1),
+               holeZ  = offset + (shape >> 1 & 1);
+
+    for (auto z = 0U; z < quads; ++z)
+    {
+        for (auto x = 0U; x < quads; ++x)
+        {
+            if (shape != solidTemplate && x >= holeX && x < holeX + half && z >= holeZ && z < holeZ + half)
+            {
+                continue;
+            }
+
+            util::lowerTriangle (elements, x + z * m_size, 1, m_size, false);
+            util::upperTriangle (elements, x + z * m_size, 1, m_size, false);
+        }
+    }
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+void GeometryClipmap::read (const unsigned int level, const int x, const int z, const int width, const int depth, const HeightSource& source)
+{
+    assert (width <= (int) m_size && depth <= (int) m_size);
+
+    const auto lastX = (int) source.getWidth() - 1,
+               lastZ = (int) source.getHeight() - 1,
+               scale = 1 << level;
+
+    for (auto row = z; row < z + depth; ++row)
+    {
+        const auto sourceZ = (size_t) std::min (std::max (row * scale, 0), lastZ);
+
+        for (auto column = x; column < x + width; ++column)
+        {
+            const auto sourceX = (size_t) std::min (std::max (column * scale, 0), lastX);
+
+            m_heights[getIndex (level, column, row)] = source.getElevation (sourceX, sourceZ);
+        }
+
+        // A whole row is contiguous wherever it begins, otherwise the run may wrap around to the start of the row.
+        const auto rowStart = getIndex (level, 0, row),
+                   first    = getIndex (level, x, row);
+
+        if (width == (int) m_size)
+        {
+            addSection (rowStart, m_size);
+        }
+
+        else
+        {
+            const auto before = std::min ((size_t) width, rowStart + m_size - first);
+
+            addSection (first, before);
+
+            if (before < (size_t) width)
+            {
+                addSection (rowStart, width - before);
+            }
+        }
+    }
+
+    m_statistics.heights += (size_t) width * depth;
+}
+
+
+void GeometryClipmap::addSection (const size_t offset, const size_t count)
+{
+    if (!m_sections.empty() && m_sections.back().offset + m_sections.back().count == offset)
+    {
+        m_sections.back().count += count;
+        return;
+    }
+
+    Section section { };
+    section.offset = offset;
+    section.count  = count;
+
+    m_sections.push_back (section);
+}
@@ -0,0 +1,168 @@
+#ifndef GEOMETRY_CLIPMAP_3GP_HPP
+#define GEOMETRY_CLIPMAP_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Forward declarations.
+class HeightSource;
+
+
+/// <summary>
+/// A geometry clipmap of nested square grids centred on the camera. Every level is a grid of the same number of points,
+/// the finest level spaces them one vertex apart and each level beyond spaces them twice as far, leaving a hole where
+/// the level inside it is drawn. Each level stores its heights toroidally so that as the camera moves only the rows and
+/// columns entering the level are read from the height source and uploaded, the rest of the heights keep their place.
+/// The cost of each update and draw depends on the size of the grid and the number of levels, never on the size of the
+/// terrain. The heights are kept on the CPU and the sections changed by each update are listed for uploading.
+/// </summary>
+class GeometryClipmap final
+{
+    public:
+
+        /// <summary> How many points wide and deep each level is by default. </summary>
+        static const unsigned int defaultSize = 255;
+
+        /// <summary> How many element templates the levels are drawn with, a ring for each position of its hole and a solid grid. </summary>
+        static const unsigned int templateCount = 5;
+
+        /// <summary> The template drawn by the finest level, which has nothing inside it. </summary>
+        static const unsigned int solidTemplate = 4;
+
+        /// <summary>
+        /// Where a level is placed by the last call to update().
+        /// </summary>
+        struct Level final
+        {
+            int             x       { 0 };  //!< The X co-ordinate of the first point, in points of the level from the first vertex of the terrain.
+            int             z       { 0 };  //!< The Z co-ordinate of the first point, in points of the level from the first vertex of the terrain.
+            unsigned int    shape   { 0 };  //!< The element template to draw, which places the hole under the level inside.
+        };
+
+        /// <summary>
+        /// A contiguous run of heights which changed during the last call to update().
+        /// </summary>
+        struct Section final
+        {
+            size_t  offset  { 0 };  //!< The index of the first height.
+            size_t  count   { 0 };  //!< How many heights changed.
+        };
+
+        /// <summary>
+        /// The amount of work done by the last call to update().
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  levelsMoved { 0 };  //!< How many levels read new heights.
+            size_t  sections    { 0 };  //!< How many sections need uploading.
+            size_t  heights     { 0 };  //!< How many heights were read from the source and need uploading.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates an empty clipmap, the size must be one less than a power of two. </summary>
+        /// <param name="size"> How many points wide and deep each level is. </param>
+        GeometryClipmap (const unsigned int size = defaultSize);
+
+        GeometryClipmap (GeometryClipmap&& move);
+        GeometryClipmap& operator= (GeometryClipmap&& move);
+
+        GeometryClipmap (const GeometryClipmap& copy)               = default;
+        GeometryClipmap& operator= (const GeometryClipmap& copy)    = default;
+        ~GeometryClipmap()                                          = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets how many points wide and deep each level is. </summary>
+        unsigned int getSize() const                        { return m_size; }
+
+        /// <summary> Gets how many levels there are, the finest is first. </summary>
+        unsigned int getLevelCount() const                  { return (unsigned int) m_levels.size(); }
+
+        /// <summary> Gets how many points from its outer edge a level begins to morph into the grid of the level beyond it. </summary>
+        float getMorphWidth() const                         { return (float) ((m_size - 1) / 10); }
+
+        /// <summary> Gets where every level was placed by the last call to update(). </summary>
+        const std::vector<Level>& getLevels() const         { return m_levels; }
+
+        /// <summary> Gets the heights of every level, each level stores its points row by row wrapped around its size. </summary>
+        const std::vector<float>& getHeights() const        { return m_heights; }
+
+        /// <summary> Gets every section of heights which changed during the last call to update(). </summary>
+        const std::vector<Section>& getSections() const     { return m_sections; }
+
+        /// <summary> Gets the amount of work done by the last call to update(). </summary>
+        const Statistics& getStatistics() const             { return m_statistics; }
+
+        /// <summary> Gets how many levels are needed so the coarsest reaches the edge of a terrain from any point on it. </summary>
+        /// <param name="width"> How many vertices wide the terrain is. </param>
+        /// <param name="depth"> How many vertices deep the terrain is. </param>
+        unsigned int getLevelsToCover (const unsigned int width, const unsigned int depth) const;
+
+        /// <summary> Gets the index of the height of a point within the storage of its level. </summary>
+        /// <param name="level"> The level containing the point. </param>
+        /// <param name="x"> The X co-ordinate of the point, in points of the level from the first vertex of the terrain. </param>
+        /// <param name="z"> The Z co-ordinate of the point, in points of the level from the first vertex of the terrain. </param>
+        size_t getIndex (const unsigned int level, const int x, const int z) const;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Allocates the storage of every level, every height is read by the next call to update(). </summary>
+        /// <param name="levelCount"> How many levels to create. </param>
+        void build (const unsigned int levelCount);
+
+        /// <summary> Removes every level. </summary>
+        void clear();
+
+        /// <summary> Centres every level on the camera, reading the heights of the points which enter each level. </summary>
+        /// <param name="cameraVertex"> The X and Z position of the camera, in vertices from the first vertex of the terrain. </param>
+        /// <param name="source"> Provides the height of every vertex, points beyond its edge are clamped to it. </param>
+        void update (const glm::vec2& cameraVertex, const HeightSource& source);
+
+        /// <summary> Adds the triangles of an element template to the given vector, every quad uses the same diagonal. </summary>
+        /// <param name="elements"> The vector to add to, indices refer to the points of a level stored row by row. </param>
+        /// <param name="shape"> The template to add, either a ring or the solid grid. </param>
+        void addElements (std::vector<unsigned int>& elements, const unsigned int shape) const;
+
+    private:
+
+        /// <summary> Reads the heights of a rectangle of points of a level and lists the sections they occupy. </summary>
+        /// <param name="level"> The level containing the points. </param>
+        /// <param name="x"> The X co-ordinate of the first point, in points of the level. </param>
+        /// <param name="z"> The Z co-ordinate of the first point, in points of the level. </param>
+        /// <param name="width"> How many points wide the rectangle is, no more than the size. </param>
+        /// <param name="depth"> How many points deep the rectangle is, no more than the size. </param>
+        /// <param name="source"> Provides the height of every vertex. </param>
+        void read (const unsigned int level, const int x, const int z, const int width, const int depth, const HeightSource& source);
+
+        /// <summary> Lists a section of heights, joining it to the last section when they're contiguous. </summary>
+        /// <param name="offset"> The index of the first height. </param>
+        /// <param name="count"> How many heights there are. </param>
+        void addSection (const size_t offset, const size_t count);
+
+
+        std::vector<float>      m_heights       { };                //!< The toroidally stored heights of every level.
+        std::vector<Level>      m_levels        { };                //!< Where each level was last placed, the finest is first.
+        std::vector<Section>    m_sections      { };                //!< The heights changed by the last update.
+        unsigned int            m_size          { defaultSize };    //!< How many points wide and deep each level is.
+        bool                    m_filled        { false };          //!< Whether every level holds the heights it was last placed over.
+        Statistics              m_statistics    { };                //!< The amount of work done by the last update.
+};
+
+
+#endif // GEOMETRY_CLIPMAP_3GP_HPP
@@ -2,7 +2,15 @@
 
 
 // STL headers.
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 
@@ -10,14 +18,144 @@
 #include <tygra/FileHelper.hpp>
 
 
+// Personal headers.
+#include <Utility/MappedFile.hpp>
+#include <Utility/Parallel.hpp>
+#include <Utility/SIMD.hpp>
+
+
+
+namespace
+{
+    /// <summary>
+    /// The header at the start of a self-describing raw height map. Every field is a little-endian 32-bit value.
+    /// </summary>
+    struct RawHeader final
+    {
+        char        magic[4];   //!< Always "HMAP".
+        uint32_t    version;    //!< The version of the header, currently 1.
+        uint32_t    format;     //!< The HeightMap::Format of every height.
+        uint32_t    width;      //!< How many heights make up a row.
+        uint32_t    height;     //!< How many rows there are.
+        uint32_t    dataOffset; //!< How many bytes from the start of the file the heights begin.
+    };
+
+    const char      rawMagic[4] = { 'H', 'M', 'A', 'P' };
+    const uint32_t  rawVersion  = 1;
+
+
+    /// <summary>
+    /// Converts a row of 8-bit pixels into heights. Ideally this would use every channel in the image but unfortunately
+    /// the ICA would have us use only the red channel, the original red * channels / (255 * channels) reduces to red / 255.
+    /// </summary>
+    /// <param name="pixels"> The first pixel of the row. </param>
+    /// <param name="channels"> How many bytes make up each pixel, the red channel is the first. </param>
+    /// <param name="count"> How many pixels make up the row. </param>
+    /// <param name="format"> How each height should be stored. </param>
+    /// <param name="output"> Where to write the heights. </param>
+    void convertRow (const uint8_t* const pixels, const unsigned int channels, const unsigned int count, 
+                     const HeightMap::Format format, uint8_t* const output)
+    {
+        // Multiplying by 257 maps 0 - 255 onto 0 - 65535 exactly, floats use the reciprocal rather than dividing.
+        const auto toUInt16 = 257U;
+        const auto toFloat  = 1.f / 255.f;
+
+        auto x = 0U;
+
+        #if defined (UTIL_SIMD_SSE) || defined (UTIL_SIMD_AVX)
+
+            // Eight pixels at a time, the red channel of each is masked out according to the stride between pixels.
+            // Three channel images don't divide evenly into registers so they use the scalar loop.
+            if (channels == 1 || channels == 2 || channels == 4)
+            {
+                const auto zero      = _mm_setzero_si128();
+                const auto lowByte16 = _mm_set1_epi16 (0x00FF),
+                           lowByte32 = _mm_set1_epi32 (0x000000FF),
+                           scale16   = _mm_set1_epi16 ((short) toUInt16);
+                const auto scaleFloat = _mm_set1_ps (toFloat);
+
+                for (; x + 8 <= count; x += 8)
+                {
+                    const auto source = pixels + x * channels;
+
+                    __m128i red;
+
+                    if (channels == 1)
+                    {
+                        red = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) source), zero);
+                    }
+
+                    else if (channels == 2)
+                    {
+                        red = _mm_and_si128 (_mm_loadu_si128 ((const __m128i*) source), lowByte16);
+                    }
+
+                    else
+                    {
+                        red = _mm_packs_epi32 (_mm_and_si128 (_mm_loadu_si128 ((const __m128i*) source), lowByte32),
+                                               _mm_and_si128 (_mm_loadu_si128 ((const __m128i*) (source + 16)), lowByte32));
+                    }
+
+                    if (format == HeightMap::Format::UInt16)
+                    {
+                        _mm_storeu_si128 ((__m128i*) (output + x * sizeof (uint16_t)), _mm_mullo_epi16 (red, scale16));
+                    }
+
+                    else
+                    {
+                        const auto low  = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (red, zero)),
+                                   high = _mm_cvtepi32_ps (_mm_unpackhi_epi16 (red, zero));
+
+                        _mm_storeu_ps ((float*) (output + x * sizeof (float)), _mm_mul_ps (low, scaleFloat));
+                        _mm_storeu_ps ((float*) (output + (x + 4) * sizeof (float)), _mm_mul_ps (high, scaleFloat));
+                    }
+                }
+            }
+
+        #endif
+
+        // Finish off whatever the SIMD loop couldn't handle.
+        for (; x < count; ++x)
+        {
+            const auto red = pixels[x * channels];
+
+            if (format == HeightMap::Format::UInt16)
+            {
+                const auto sample = (uint16_t) (red * toUInt16);
+                std::memcpy (output + x * sizeof (uint16_t), &sample, sizeof (sample));
+            }
+
+            else
+            {
+                const auto sample = red * toFloat;
+                std::memcpy (output + x * sizeof (float), &sample, sizeof (sample));
+            }
+        }
+    }
+
+
+    /// <summary> Gets the lower-case extension of a file, including the dot. </summary>
+    std::string extensionOf (const std::string& file)
+    {
+        const auto dot = file.find_last_of ('.');
+        auto extension = dot == std::string::npos ? std::string { } : file.substr (dot);
+
+        std::transform (extension.begin(), extension.end(), extension.begin(), [] (const char c) { return (char) std::tolower (c); });
+
+        return extension;
+    }
+}
+
 
 //////////////////
 // Constructors //
 //////////////////
 
-HeightMap::HeightMap (const std::string& file, const glm::vec3& worldScale)
+HeightMap::HeightMap (const std::string& file, const glm::vec3& worldScale, const Format format)
 {
-    if (!loadFromPNG (file, worldScale))
+    const auto loaded = extensionOf (file) == ".png" ? loadFromPNG (file, worldScale, format) : loadFromRaw (file, worldScale);
+
+    if (!loaded)
     {
         throw std::invalid_argument ("HeightMap::HeightMap(), unable to load from the given file location: \"" + file + "\"");
     }
@@ -34,9 +172,21 @@ HeightMap& HeightMap::operator= (HeightMap&& move)
 {
     if (this != &move)
     {
-        m_width  = move.m_width;
-        m_height = move.m_height;
-        m_data   = std::move (move.m_data);
+        m_width        = move.m_width;
+        m_height       = move.m_height;
+        m_worldScale   = move.m_worldScale;
+        m_format       = move.m_format;
+        m_sampleScale  = move.m_sampleScale;
+        m_data         = std::move (move.m_data);
+        m_mapping      = std::move (move.m_mapping);
+        m_mappedOffset = move.m_mappedOffset;
+        m_loadTimings  = move.m_loadTimings;
+
+        // Reset primitives.
+        move.m_width        = 0;
+        move.m_height       = 0;
+        move.m_sampleScale  = 0.f;
+        move.m_mappedOffset = 0;
     }
 
     return *this;
@@ -47,7 +197,7 @@ HeightMap& HeightMap::operator= (HeightMap&& move)
 // Operators //
 ///////////////
 
-const glm::vec3& HeightMap::operator[] (const size_t index) const
+glm::vec3 HeightMap::operator[] (const size_t index) const
 {
     return getPoint (index);
 }
@@ -57,87 +207,248 @@ const glm::vec3& HeightMap::operator[] (const size_t index) const
 // Getters and setters //
 /////////////////////////
 
-const glm::vec3& HeightMap::getPoint (const size_t x, const size_t y) const
+float HeightMap::getElevation (const size_t x, const size_t y) const
+{
+    return getElevation (x + y * m_width);
+}
+
+
+float HeightMap::getElevation (const size_t index) const
 {
     // Ensure we are accessing valid data.
-    assert (x + y * m_width < m_data.size());
+    assert (index < (size_t) m_width * m_height);
+
+    // memcpy avoids alignment and aliasing issues and compiles down to a single load.
+    if (m_format == Format::UInt16)
+    {
+        uint16_t sample { 0 };
+        std::memcpy (&sample, samples() + index * sizeof (uint16_t), sizeof (uint16_t));
+
+        return sample * m_sampleScale;
+    }
 
-    return m_data[x + y * m_width];
+    float sample { 0.f };
+    std::memcpy (&sample, samples() + index * sizeof (float), sizeof (float));
+
+    return sample * m_sampleScale;
 }
 
 
-const glm::vec3& HeightMap::getPoint (const size_t index) const
+void HeightMap::readElevations (const size_t x, const size_t y, const size_t width, const size_t height, float* const output) const
 {
     // Ensure we are accessing valid data.
-    assert (index < m_data.size());
+    assert (x + width <= m_width && y + height <= m_height);
+
+    // Avoid a virtual call per height by reading whole rows directly.
+    for (size_t row = 0; row < height; ++row)
+    {
+        const auto first = x + (y + row) * m_width;
+
+        for (size_t column = 0; column < width; ++column)
+        {
+            output[column + row * width] = getElevation (first + column);
+        }
+    }
+}
+
 
-    return m_data[index];
+glm::vec3 HeightMap::getPoint (const size_t index) const
+{
+    return getPoint (index % m_width, index / m_width);
 }
 
 
-bool HeightMap::loadFromPNG (const std::string& file, const glm::vec3& worldScale)
+bool HeightMap::loadFromPNG (const std::string& file, const glm::vec3& worldScale, const Format format)
 {
     // Ensure valid parameters!
     assert (worldScale.x != 0.f && worldScale.y != 0.f && worldScale.z != 0.f);
 
     // Load the height map, we only handle 8-bit per colour (256 possible values).
+    const auto start     = std::chrono::steady_clock::now();
     const auto heightMap = tygra::imageFromPNG (file);
+    const auto decoded   = std::chrono::steady_clock::now();
 
     if (heightMap.containsData() && heightMap.bytesPerComponent() == 1)
     {
         // Calculate the amount of data we need to create and update our member variables.
-        m_width      = heightMap.width();
-        m_height     = heightMap.height();
-        m_worldScale = worldScale;
+        m_width       = heightMap.width();
+        m_height      = heightMap.height();
+        m_worldScale  = worldScale;
+        m_format      = format;
+
+        // Quantised heights span zero to the world height, floats are normalised.
+        m_sampleScale = format == Format::UInt16 ? worldScale.y / std::numeric_limits<uint16_t>::max() : worldScale.y;
+
+        // We own the heights now, so any previously mapped file can be released.
+        m_mapping.reset();
+        m_mappedOffset = 0;
+
+        const auto sampleSize = format == Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
 
-        m_data.reserve (m_width * m_height);
+        // Size the output upfront so that every row can be written independently.
+        m_data.resize (m_width * m_height * sampleSize);
 
         // The width and height must be divisible by four for the height map to be valid.
         assert (m_width % 4 == 0 && m_height % 4 == 0);
 
-        // Create the heightmap from the image data.
-        auto       image    = (const uint8_t*) heightMap.pixels();
+        // Create the heightmap from the image data, one row per task.
+        const auto image    = (const uint8_t*) heightMap.pixels();
+        const auto channels = (unsigned int) heightMap.componentsPerPixel();
+        const auto width    = m_width;
+        const auto output   = m_data.data();
 
-        const auto channels  = heightMap.componentsPerPixel();
-        const auto maxValues = glm::vec3 (m_width - 1, 255.f * channels, m_height - 1);
-                                
-        for (auto z = 0U; z < m_height; ++z)
+        util::parallelFor (0, m_height, [=] (const size_t z)
         {
-            for (auto x = 0U; x < m_width; ++x)
-            {
-                // Use all colour channels, this gives a potential 1021 steps instead of 256 steps of height.
-                auto accumlator = 0U;
+            convertRow (image + z * width * channels, channels, width, format, output + z * width * sampleSize);
+        }, 64);
 
-                for (auto i = 0U; i < channels; ++i)
-                {
-                    // Ideally this would use every channel in the image but unfortunately the ICA would have me place
-                    // a silly if statement here so that we only obtain the red channel.
-                    if (i == 0)
-                    {
-                        accumlator += *image;
-                        accumlator *= channels;
-                    }
+        const auto converted = std::chrono::steady_clock::now();
 
-                    // Ideal solution here:
-                    // accumlator += *image;
-                    ++image;
-                }
+        m_loadTimings.decodeMilliseconds  = std::chrono::duration<double, std::milli> (decoded - start).count();
+        m_loadTimings.convertMilliseconds = std::chrono::duration<double, std::milli> (converted - decoded).count();
+
+        return true;
+    }
+
+    return false;
+}
 
-                // Normalise the X, Y and Z values to get scaled co-ordinates.
-                const auto coordinates = glm::vec3 (x          / maxValues.x,
-                                                    accumlator / maxValues.y,
-                                                    z          / maxValues.z);
 
-                // Put it all together and you get the world position!
-                const auto position = coordinates * m_worldScale;
+bool HeightMap::loadFromRaw (const std::string& file, const glm::vec3& worldScale)
+{
+    // Ensure valid parameters!
+    assert (worldScale.x != 0.f && worldScale.y != 0.f && worldScale.z != 0.f);
 
-                // Update the internal data and increment the pointer.
-                m_data.push_back (position);
-            }
+    const auto start   = std::chrono::steady_clock::now();
+    auto       mapping = std::make_shared<util::MappedFile> (file);
+
+    if (!mapping->isOpen())
+    {
+        return false;
+    }
+
+    const auto fileSize = mapping->getSize();
+
+    auto format      = Format::UInt16;
+    auto width       = 0U,
+         height      = 0U;
+    auto dataOffset  = (size_t) 0;
+
+    RawHeader header { };
+
+    if (fileSize >= sizeof (RawHeader))
+    {
+        std::memcpy (&header, mapping->getData(), sizeof (RawHeader));
+    }
+
+    // Self-describing files tell us everything.
+    if (std::equal (rawMagic, rawMagic + 4, header.magic))
+    {
+        if (header.version != rawVersion || header.format > (uint32_t) Format::Float || header.dataOffset < sizeof (RawHeader))
+        {
+            return false;
         }
 
-        return true;
+        format     = (Format) header.format;
+        width      = header.width;
+        height     = header.height;
+        dataOffset = header.dataOffset;
     }
 
-    return false;
-}
\ No newline at end of file
+    // Headerless files are square so the dimensions come from the file size.
+    else
+    {
+        const auto extension = extensionOf (file);
+
+        if (extension == ".r32")
+        {
+            format = Format::Float;
+        }
+
+        else if (extension != ".r16" && extension != ".raw")
+        {
+            return false;
+        }
+
+        const auto sampleSize = format == Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
+        const auto samples    = fileSize / sampleSize;
+
+        width  = (unsigned int) std::lround (std::sqrt ((double) samples));
+        height = width;
+    }
+
+    // The header is untrusted so the dimensions are capped before anything is multiplied by them.
+    if (width < 4 || height < 4 || width > maxDimension || height > maxDimension || dataOffset > fileSize)
+    {
+        return false;
+    }
+
+    // The file must actually contain every height it claims to. The size is worked out in 64 bits because a 32-bit
+    // size_t could wrap around to something which fits.
+    const auto sampleSize = format == Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
+    const auto dataSize   = (uint64_t) width * height * sampleSize;
+
+    if (dataSize > std::numeric_limits<size_t>::max() || dataSize > (uint64_t) (fileSize - dataOffset) || 
+        (dataOffset == 0 && dataSize != fileSize))
+    {
+        return false;
+    }
+
+    // The width and height must be divisible by four for the height map to be valid.
+    if (width % 4 != 0 || height % 4 != 0)
+    {
+        return false;
+    }
+
+    m_width        = width;
+    m_height       = height;
+    m_worldScale   = worldScale;
+    m_format       = format;
+    m_sampleScale  = format == Format::UInt16 ? worldScale.y / std::numeric_limits<uint16_t>::max() : worldScale.y;
+
+    // The heights stay in the file, drop any we own.
+    m_data.clear();
+    m_data.shrink_to_fit();
+
+    m_mapping      = std::move (mapping);
+    m_mappedOffset = dataOffset;
+
+    // Nothing is decoded or converted, mapping the file is the only cost.
+    m_loadTimings.decodeMilliseconds  = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+    m_loadTimings.convertMilliseconds = 0.0;
+
+    return true;
+}
+
+
+bool HeightMap::saveToRaw (const std::string& file) const
+{
+    std::ofstream output { file, std::ios::binary };
+
+    if (!output)
+    {
+        return false;
+    }
+
+    const auto sampleSize = m_format == Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
+
+    RawHeader header { };
+
+    std::copy (rawMagic, rawMagic + 4, header.magic);
+    header.version    = rawVersion;
+    header.format     = (uint32_t) m_format;
+    header.width      = m_width;
+    header.height     = m_height;
+    header.dataOffset = sizeof (RawHeader);
+
+    output.write ((const char*) &header, sizeof (RawHeader));
+    output.write ((const char*) samples(), (std::streamsize) m_width * m_height * sampleSize);
+
+    return (bool) output;
+}
+
+
+const uint8_t* HeightMap::samples() const
+{
+    return m_mapping ? m_mapping->getData() + m_mappedOffset : m_data.data();
+}
@@ -3,6 +3,9 @@
 
 
 // STL headers.
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 
@@ -10,30 +13,61 @@
 #include <glm/gtc/type_ptr.hpp>
 
 
+// Personal headers.
+#include <Terrain/HeightSource.hpp>
+
+
+// Forward declarations.
+namespace util { class MappedFile; }
+
+
 /// <summary>
-/// A basic class which loads a height map from a file and stores the control points for a 3D terrain.
+/// A basic class which loads a height map from a file and stores the control points for a 3D terrain. Only the height of
+/// each point is stored, the X and Z co-ordinates are reconstructed from the grid position and world scale on demand.
+/// Raw height maps are memory-mapped and used in place, copies of a mapped height map share the same mapping.
 /// </summary>
-class HeightMap final
+class HeightMap final : public HeightSource
 {
     public:
 
+        /// <summary>
+        /// Determines how each height is stored in memory.
+        /// </summary>
+        enum class Format : int
+        {
+            UInt16 = 0, //!< Two bytes per height, quantised to 65536 steps between zero and the world height.
+            Float  = 1  //!< Four bytes per height, normalised so that 1 is the world height.
+        };
+
+
+        /// <summary>
+        /// How long the most recent load took, split into obtaining the pixels and converting them into heights.
+        /// </summary>
+        struct LoadTimings final
+        {
+            double decodeMilliseconds   { 0.0 };    //!< Time spent decoding the PNG or mapping the raw file.
+            double convertMilliseconds  { 0.0 };    //!< Time spent converting pixels into heights.
+        };
+
+
         /////////////////////////////////
         // Constructors and destructor //
         /////////////////////////////////
 
         /// <summary> 
-        /// Constructs a HeightMap object from an image file. 
+        /// Constructs a HeightMap object from a file. PNG files are decoded, anything else is mapped as a raw height map.
         /// </summary>
-        /// <param name="file"> The file location of the image to load. </param>
+        /// <param name="file"> The file location of the height map to load. </param>
         /// <param name="worldScale"> The dimensions of the final terrain. </param>
-        HeightMap (const std::string& file, const glm::vec3& worldScale);
+        /// <param name="format"> How each height should be stored when decoding a PNG. Raw files keep their own format. </param>
+        HeightMap (const std::string& file, const glm::vec3& worldScale, const Format format = Format::UInt16);
 
         HeightMap (HeightMap&& move);
         HeightMap& operator= (HeightMap&& move);
 
         HeightMap (const HeightMap& copy)               = default;
         HeightMap& operator= (const HeightMap& copy)    = default;
-        ~HeightMap()                                    = default;
+        ~HeightMap() override                           = default;
 
 
         ///////////////
@@ -41,7 +75,7 @@ class HeightMap final
         ///////////////
 
         /// <summary> Short-hand for HeightMap::getPoint (const size_t). </summary>
-        const glm::vec3& operator[] (const size_t index) const;
+        glm::vec3 operator[] (const size_t index) const;
 
 
         /////////////////////////
@@ -49,43 +83,88 @@ class HeightMap final
         /////////////////////////
 
         /// <summary> Gets the width of the height map data. </summary>
-        unsigned int getWidth() const           { return m_width; }
+        unsigned int getWidth() const override          { return m_width; }
 
         /// <summary> Gets the height of the height map data. </summary>
-        unsigned int getHeight() const          { return m_height; }
+        unsigned int getHeight() const override         { return m_height; }
 
         /// <summary> Gets the world scale of the height map. </summary>
         /// <returns> The dimensions of the height map in world units. </returns>
-        const glm::vec3& getWorldScale() const  { return m_worldScale; }
+        const glm::vec3& getWorldScale() const override { return m_worldScale; }
+
+        /// <summary> Gets how each height is stored in memory. </summary>
+        Format getFormat() const                { return m_format; }
+
+        /// <summary> Checks whether the heights are read directly from a memory-mapped file. </summary>
+        bool isMapped() const                   { return m_mapping != nullptr; }
 
-        /// <summary> Gets the point at the given co-ordinates. </summary>
+        /// <summary> Gets how long the most recent load took. </summary>
+        const LoadTimings& getLoadTimings() const   { return m_loadTimings; }
+
+        /// <summary> Gets the height in world units at the given co-ordinates. </summary>
         /// <param name="x"> The X co-ordinate of the height map. </param>
         /// <param name="y"> The Y co-orindate of the height map. </param>
-        /// <returns> The desired point. </returns>
-        const glm::vec3& getPoint (const size_t x, const size_t y) const;
+        /// <returns> The desired height. </returns>
+        float getElevation (const size_t x, const size_t y) const override;
+
+        /// <summary> Gets the height in world units at the desired index of the height map. </summary>
+        /// <param name="index"> The index of the height to obtain. </param>
+        /// <returns> The desired height. </returns>
+        float getElevation (const size_t index) const;
+
+        /// <summary> Copies a rectangle of heights in world units into the given array, row by row. </summary>
+        void readElevations (const size_t x, const size_t y, const size_t width, const size_t height, float* const output) const override;
+
+        /// <summary> Bring HeightSource::getPoint (const size_t, const size_t) into scope. </summary>
+        using HeightSource::getPoint;
 
         /// <summary> Gets the point at the desired index of the height map. </summary>
         /// <param name="index"> The index of the point to obtain. </param>
         /// <returns> The desired point. </returns>
-        const glm::vec3& getPoint (const size_t index) const;
+        glm::vec3 getPoint (const size_t index) const;
 
         /// <summary> Attempts to load the height map from a new file. If the file is invalid no data will be lost. </summary>
         /// <param name="file"> The file location to load from. </param>
         /// <param name="worldScale"> The dimensions of the final terrain. </param>
+        /// <param name="format"> How each height should be stored. </param>
         /// <returns> Whether the load was successful or not. </returns>
-        bool loadFromPNG (const std::string& file, const glm::vec3& worldScale);
+        bool loadFromPNG (const std::string& file, const glm::vec3& worldScale, const Format format = Format::UInt16);
+
+        /// <summary>
+        /// Attempts to memory-map a raw height map, the heights are used in place without being decoded or copied. Files
+        /// beginning with a height map header describe their own format and dimensions, otherwise ".r16" and ".raw" files
+        /// are treated as square little-endian UInt16 data and ".r32" files as square Float data.
+        /// </summary>
+        /// <param name="file"> The file location to load from. </param>
+        /// <param name="worldScale"> The dimensions of the final terrain. </param>
+        /// <returns> Whether the load was successful or not. If not then no data will be lost. </returns>
+        bool loadFromRaw (const std::string& file, const glm::vec3& worldScale);
+
+        /// <summary> Writes the heights to a file with a height map header so it can be mapped by HeightMap::loadFromRaw(). </summary>
+        /// <param name="file"> The file location to write to. </param>
+        /// <returns> Whether the file was written successfully. </returns>
+        bool saveToRaw (const std::string& file) const;
 
     private:
 
+        /// <summary> Gets the first byte of the height data, either owned or mapped. </summary>
+        const uint8_t* samples() const;
+
         ///////////////////
         // Internal data //
         ///////////////////
 
-        unsigned int            m_width      { 0 }; //!< The width of the height map image.
-        unsigned int            m_height     { 0 }; //!< The height of the height map image.
-        glm::vec3               m_worldScale { 0 }; //!< The scale of the height map in world units.
+        unsigned int            m_width       { 0 };                //!< The width of the height map image.
+        unsigned int            m_height      { 0 };                //!< The height of the height map image.
+        glm::vec3               m_worldScale  { 0 };                //!< The scale of the height map in world units.
+
+        Format                  m_format      { Format::UInt16 };   //!< How each height is stored in m_data.
+        float                   m_sampleScale { 0.f };              //!< Converts a stored height into world units.
+        std::vector<uint8_t>    m_data        { };                  //!< The height of every point, packed according to m_format.
 
-        std::vector<glm::vec3>  m_data       { };   //!< The 3D co-ordinates of the desired terrain.
+        std::shared_ptr<const util::MappedFile> m_mapping      { };     //!< The mapped file to read from instead of m_data, if any.
+        size_t                                  m_mappedOffset { 0 };   //!< How many bytes into the mapped file the heights begin.
+        LoadTimings                             m_loadTimings  { };     //!< How long the most recent load took.
 };
 
 #endif // HEIGHT_MAP_3GP_HPP
\ No newline at end of file
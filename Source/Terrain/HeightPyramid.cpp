@@ -0,0 +1,227 @@
+#include "HeightPyramid.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+
+
+// Personal headers.
+#include <Terrain/HeightSource.hpp>
+#include <Utility/Parallel.hpp>
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+HeightPyramid::HeightPyramid (const HeightSource& source)
+{
+    build (source);
+}
+
+
+HeightPyramid::HeightPyramid (HeightPyramid&& move)
+{
+    *this = std::move (move);
+}
+
+
+HeightPyramid& HeightPyramid::operator= (HeightPyramid&& move)
+{
+    if (this != &move)
+    {
+        m_width   = move.m_width;
+        m_depth   = move.m_depth;
+        m_heights = std::move (move.m_heights);
+        m_levels  = std::move (move.m_levels);
+
+        // Reset primitives.
+        move.m_width = 0;
+        move.m_depth = 0;
+    }
+
+    return *this;
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+float HeightPyramid::getHeight (const unsigned int x, const unsigned int z) const
+{
+    // Ensure we are accessing valid data.
+    assert (x < m_width && z < m_depth);
+
+    return m_heights[x + z * m_width];
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void HeightPyramid::build (const HeightSource& source)
+{
+    const auto width = source.getWidth(),
+               depth = source.getHeight();
+
+    std::vector<float> heights (width * depth);
+
+    // Rows are read independently so sources which serialise access still allow the copy to overlap.
+    util::parallelFor (0, depth, [&] (const size_t z)
+    {
+        source.readElevations (0, z, width, 1, &heights[z * width]);
+    }, 64);
+
+    build (width, depth, std::move (heights));
+}
+
+
+void HeightPyramid::build (const unsigned int width, const unsigned int depth, std::vector<float>&& heights)
+{
+    assert (heights.size() == (size_t) width * depth);
+
+    m_width   = width;
+    m_depth   = depth;
+    m_heights = std::move (heights);
+
+    buildLevels();
+}
+
+
+void HeightPyramid::clear()
+{
+    m_width = 0;
+    m_depth = 0;
+
+    m_heights.clear();
+    m_heights.shrink_to_fit();
+    m_levels.clear();
+    m_levels.shrink_to_fit();
+}
+
+
+HeightPyramid::Range HeightPyramid::getRange (const unsigned int firstX, const unsigned int firstZ, unsigned int lastX, unsigned int lastZ) const
+{
+    assert (!m_heights.empty() && firstX <= lastX && firstZ <= lastZ);
+
+    lastX = std::min (lastX, m_width - 1);
+    lastZ = std::min (lastZ, m_depth - 1);
+
+    // Climb until the rectangle spans at most two cells on each axis, the top level is always a single cell.
+    auto level = 0U;
+
+    while (level + 1 < getLevelCount() && ((lastX >> level) - (firstX >> level) > 1 || (lastZ >> level) - (firstZ >> level) > 1))
+    {
+        ++level;
+    }
+
+    auto range = getCell (level, firstX >> level, firstZ >> level);
+
+    for (auto z = firstZ >> level; z <= lastZ >> level; ++z)
+    {
+        for (auto x = firstX >> level; x <= lastX >> level; ++x)
+        {
+            const auto cell = getCell (level, x, z);
+
+            range.min = std::min (range.min, cell.min);
+            range.max = std::max (range.max, cell.max);
+        }
+    }
+
+    return range;
+}
+
+
+HeightPyramid::Range HeightPyramid::getCell (const unsigned int level, const unsigned int x, const unsigned int z) const
+{
+    if (level == 0)
+    {
+        // Ranges have default member initialisers so they can't be aggregate initialised on every compiler.
+        Range range { };
+        range.min = range.max = getHeight (x, z);
+
+        return range;
+    }
+
+    // Ensure we are accessing valid data.
+    assert (level - 1 < m_levels.size());
+
+    const auto& cells = m_levels[level - 1];
+    assert (x < cells.width && z < cells.depth);
+
+    return cells.cells[x + z * cells.width];
+}
+
+
+unsigned int HeightPyramid::getLevelWidth (const unsigned int level) const
+{
+    return level == 0 ? m_width : m_levels[level - 1].width;
+}
+
+
+unsigned int HeightPyramid::getLevelDepth (const unsigned int level) const
+{
+    return level == 0 ? m_depth : m_levels[level - 1].depth;
+}
+
+
+//////////////
+// Creation //
+//////////////
+
+void HeightPyramid::buildLevels()
+{
+    m_levels.clear();
+
+    auto belowWidth = m_width,
+         belowDepth = m_depth;
+
+    // Keep halving until a single cell covers everything.
+    while (belowWidth > 1 || belowDepth > 1)
+    {
+        Level level { };
+
+        level.width = (belowWidth + 1) / 2;
+        level.depth = (belowDepth + 1) / 2;
+        level.cells.resize (level.width * level.depth);
+
+        // The level below must be finished before this one starts, but every row within a level is independent.
+        const auto belowLevel = (unsigned int) m_levels.size();
+
+        util::parallelFor (0, level.depth, [&] (const size_t z)
+        {
+            for (auto x = 0U; x < level.width; ++x)
+            {
+                // Edge cells of odd sized levels only have one child on that axis.
+                const auto childX    = x * 2,
+                           childZ    = (unsigned int) z * 2,
+                           lastX     = std::min (childX + 1, belowWidth - 1),
+                           lastZ     = std::min (childZ + 1, belowDepth - 1);
+
+                auto range = getCell (belowLevel, childX, childZ);
+
+                for (auto j = childZ; j <= lastZ; ++j)
+                {
+                    for (auto i = childX; i <= lastX; ++i)
+                    {
+                        const auto child = getCell (belowLevel, i, j);
+
+                        range.min = std::min (range.min, child.min);
+                        range.max = std::max (range.max, child.max);
+                    }
+                }
+
+                level.cells[x + z * level.width] = range;
+            }
+        }, 16);
+
+        m_levels.push_back (std::move (level));
+
+        belowWidth = m_levels.back().width;
+        belowDepth = m_levels.back().depth;
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef HEIGHT_PYRAMID_3GP_HPP
+#define HEIGHT_PYRAMID_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Forward declarations.
+class HeightSource;
+
+
+/// <summary>
+/// A mip pyramid of minimum and maximum heights over a regular grid. The first level holds every height and each level
+/// above holds the range of a 2x2 block of the level below, so the height range of any rectangle can be found by
+/// visiting at most four cells once the correct level has been found.
+/// </summary>
+class HeightPyramid final
+{
+    public:
+
+        /// <summary> The lowest and highest height within an area. </summary>
+        struct Range final
+        {
+            float min { 0.f };  //!< The lowest height.
+            float max { 0.f };  //!< The highest height.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        HeightPyramid()                                         = default;
+
+        /// <summary> Builds a pyramid from every height of the given source. </summary>
+        /// <param name="source"> The heights to summarise. </param>
+        HeightPyramid (const HeightSource& source);
+
+        HeightPyramid (HeightPyramid&& move);
+        HeightPyramid& operator= (HeightPyramid&& move);
+
+        HeightPyramid (const HeightPyramid& copy)               = default;
+        HeightPyramid& operator= (const HeightPyramid& copy)    = default;
+        ~HeightPyramid()                                        = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets how many heights wide the first level is. </summary>
+        unsigned int getWidth() const       { return m_width; }
+
+        /// <summary> Gets how many heights deep the first level is. </summary>
+        unsigned int getDepth() const       { return m_depth; }
+
+        /// <summary> Gets how many levels make up the pyramid, including the full resolution level. </summary>
+        unsigned int getLevelCount() const  { return (unsigned int) m_levels.size() + (m_heights.empty() ? 0 : 1); }
+
+        /// <summary> Gets the full resolution height at the given co-ordinates. </summary>
+        /// <param name="x"> The X co-ordinate of the height. </param>
+        /// <param name="z"> The Z co-ordinate of the height. </param>
+        float getHeight (const unsigned int x, const unsigned int z) const;
+
+        /// <summary> Gets every full resolution height, stored row by row. </summary>
+        const std::vector<float>& getHeights() const   { return m_heights; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Rebuilds the pyramid from every height of the given source, one level at a time across every thread. </summary>
+        /// <param name="source"> The heights to summarise. </param>
+        void build (const HeightSource& source);
+
+        /// <summary> Rebuilds the pyramid from a grid of heights, one level at a time across every thread. </summary>
+        /// <param name="width"> How many heights make up a row. </param>
+        /// <param name="depth"> How many rows of heights there are. </param>
+        /// <param name="heights"> Every height, stored row by row. </param>
+        void build (const unsigned int width, const unsigned int depth, std::vector<float>&& heights);
+
+        /// <summary> Releases every level. </summary>
+        void clear();
+
+        /// <summary>
+        /// Finds the range of heights within the given inclusive rectangle in O(log n). The result is conservative, it may
+        /// include heights up to one cell of the chosen level beyond the rectangle but never excludes a height inside it.
+        /// Rectangles aligned to a power of two, such as terrain patches, are usually exact.
+        /// </summary>
+        /// <param name="firstX"> The first X co-ordinate of the rectangle. </param>
+        /// <param name="firstZ"> The first Z co-ordinate of the rectangle. </param>
+        /// <param name="lastX"> The last X co-ordinate of the rectangle, it is clamped to the grid. </param>
+        /// <param name="lastZ"> The last Z co-ordinate of the rectangle, it is clamped to the grid. </param>
+        Range getRange (const unsigned int firstX, const unsigned int firstZ, unsigned int lastX, unsigned int lastZ) const;
+
+        /// <summary> Gets the range of a single cell at the given level, level zero being the full resolution heights. </summary>
+        /// <param name="level"> The level of the pyramid. </param>
+        /// <param name="x"> The X co-ordinate of the cell within the level. </param>
+        /// <param name="z"> The Z co-ordinate of the cell within the level. </param>
+        Range getCell (const unsigned int level, const unsigned int x, const unsigned int z) const;
+
+        /// <summary> Gets how many cells wide the given level is. </summary>
+        unsigned int getLevelWidth (const unsigned int level) const;
+
+        /// <summary> Gets how many cells deep the given level is. </summary>
+        unsigned int getLevelDepth (const unsigned int level) const;
+
+    private:
+
+        /// <summary> A single reduced level of the pyramid. </summary>
+        struct Level final
+        {
+            unsigned int        width   { 0 };  //!< How many cells wide the level is.
+            unsigned int        depth   { 0 };  //!< How many cells deep the level is.
+            std::vector<Range>  cells   { };    //!< The range of every cell, stored row by row.
+        };
+
+        /// <summary> Builds every level above the full resolution heights. </summary>
+        void buildLevels();
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int        m_width     { 0 };  //!< How many heights wide the first level is.
+        unsigned int        m_depth     { 0 };  //!< How many heights deep the first level is.
+        std::vector<float>  m_heights   { };    //!< The full resolution level, a single height is its own range.
+        std::vector<Level>  m_levels    { };    //!< Every reduced level, each half the size of the one before it.
+};
+
+
+#endif // HEIGHT_PYRAMID_3GP_HPP
@@ -0,0 +1,171 @@
+#include "HeightQuery.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+
+
+// Personal headers.
+#include <Terrain/HeightPyramid.hpp>
+#include <Utility/Parallel.hpp>
+#include <Utility/SIMD.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+HeightQuery::HeightQuery (const HeightPyramid& heights, const float spacingX, const float spacingZ)
+{
+    // Bilinear interpolation needs at least one whole cell.
+    assert (heights.getWidth() > 1 && heights.getDepth() > 1 && spacingX != 0.f && spacingZ != 0.f);
+
+    m_heights  = heights.getHeights().data();
+    m_width    = heights.getWidth();
+    m_depth    = heights.getDepth();
+    m_spacingX = spacingX;
+    m_spacingZ = spacingZ;
+    m_inverseX = 1.f / spacingX;
+    m_inverseZ = 1.f / spacingZ;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+float HeightQuery::height (const float x, const float z) const
+{
+    float result { 0.f };
+    sampleRange (&x, &z, 1, &result, nullptr);
+
+    return result;
+}
+
+
+glm::vec3 HeightQuery::normal (const float x, const float z) const
+{
+    glm::vec3 result { 0.f };
+    sampleRange (&x, &z, 1, nullptr, &result);
+
+    return result;
+}
+
+
+void HeightQuery::sample (const float* const x, const float* const z, const size_t count, float* const heights, glm::vec3* const normals) const
+{
+    assert (isValid());
+
+    if (count < parallelThreshold)
+    {
+        sampleRange (x, z, count, heights, normals);
+        return;
+    }
+
+    // Split large batches into SIMD friendly chunks, each thread writes to its own part of the output.
+    const auto chunk  = parallelThreshold / 4,
+               chunks = (count + chunk - 1) / chunk;
+
+    util::parallelFor (0, chunks, [=] (const size_t index)
+    {
+        const auto first = index * chunk,
+                   size  = std::min (chunk, count - first);
+
+        sampleRange (x + first, z + first, size, heights ? heights + first : nullptr, normals ? normals + first : nullptr);
+    });
+}
+
+
+void HeightQuery::sampleRange (const float* const x, const float* const z, const size_t count, float* const heights, glm::vec3* const normals) const
+{
+    namespace simd = util::simd;
+
+    // Grid co-ordinates are clamped so that every position has a whole cell to interpolate.
+    const auto zero      = simd::set (0.f),
+               one       = simd::set (1.f),
+               inverseX  = simd::set (m_inverseX),
+               inverseZ  = simd::set (m_inverseZ),
+               maxX      = simd::set ((float) (m_width - 1)),
+               maxZ      = simd::set ((float) (m_depth - 1)),
+               lastCellX = simd::set ((float) (m_width - 2)),
+               lastCellZ = simd::set ((float) (m_depth - 2));
+
+    for (size_t first = 0; first < count; first += simd::width)
+    {
+        const auto lanes = std::min ((size_t) simd::width, count - first);
+
+        // The final group may not fill every lane so pad it by repeating the last position.
+        float positionX[simd::width], positionZ[simd::width];
+
+        for (size_t lane = 0; lane < simd::width; ++lane)
+        {
+            const auto index = first + std::min (lane, lanes - 1);
+
+            positionX[lane] = x[index];
+            positionZ[lane] = z[index];
+        }
+
+        const auto gridX = simd::min (simd::max (simd::mul (simd::load (positionX), inverseX), zero), maxX),
+                   gridZ = simd::min (simd::max (simd::mul (simd::load (positionZ), inverseZ), zero), maxZ),
+                   cellX = simd::min (simd::floor (gridX), lastCellX),
+                   cellZ = simd::min (simd::floor (gridZ), lastCellZ),
+                   fracX = simd::sub (gridX, cellX),
+                   fracZ = simd::sub (gridZ, cellZ);
+
+        // There's no gather before AVX2 so fetch the four corners of each cell one lane at a time.
+        float cellsX[simd::width], cellsZ[simd::width],
+              corner00[simd::width], corner10[simd::width], corner01[simd::width], corner11[simd::width];
+
+        simd::store (cellsX, cellX);
+        simd::store (cellsZ, cellZ);
+
+        for (size_t lane = 0; lane < simd::width; ++lane)
+        {
+            const auto base = m_heights + (size_t) cellsX[lane] + (size_t) cellsZ[lane] * m_width;
+
+            corner00[lane] = base[0];
+            corner10[lane] = base[1];
+            corner01[lane] = base[m_width];
+            corner11[lane] = base[m_width + 1];
+        }
+
+        const auto h00 = simd::load (corner00), h10 = simd::load (corner10),
+                   h01 = simd::load (corner01), h11 = simd::load (corner11);
+
+        // Interpolate along X first, then Z.
+        const auto bottom = simd::madd (simd::sub (h10, h00), fracX, h00),
+                   top    = simd::madd (simd::sub (h11, h01), fracX, h01);
+
+        if (heights)
+        {
+            float results[simd::width];
+            simd::store (results, simd::madd (simd::sub (top, bottom), fracZ, bottom));
+
+            std::copy (results, results + lanes, heights + first);
+        }
+
+        if (normals)
+        {
+            // The slopes of the bilinear patch, converted from grid units into world units.
+            const auto slopeX = simd::mul (simd::madd (simd::sub (simd::sub (h11, h01), simd::sub (h10, h00)), fracZ, 
+                                                       simd::sub (h10, h00)), inverseX),
+                       slopeZ = simd::mul (simd::sub (top, bottom), inverseZ);
+
+            // The normal of y = h(x, z) is (-dh/dx, 1, -dh/dz), normalised.
+            const auto length = simd::sqrt (simd::madd (slopeX, slopeX, simd::madd (slopeZ, slopeZ, one)));
+
+            float normalX[simd::width], normalY[simd::width], normalZ[simd::width];
+
+            simd::store (normalX, simd::div (simd::sub (zero, slopeX), length));
+            simd::store (normalY, simd::div (one, length));
+            simd::store (normalZ, simd::div (simd::sub (zero, slopeZ), length));
+
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                normals[first + lane] = { normalX[lane], normalY[lane], normalZ[lane] };
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef HEIGHT_QUERY_3GP_HPP
+#define HEIGHT_QUERY_3GP_HPP
+
+
+// STL headers.
+#include <cstddef>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Forward declarations.
+class HeightPyramid;
+
+
+/// <summary>
+/// A lightweight, read-only view of the final terrain heights which answers height and normal queries at any world
+/// position by bilinearly interpolating the generated vertex grid. Queries don't modify anything so a single view can be
+/// shared by any number of threads, it remains valid until the terrain is rebuilt or cleaned up. Positions outside of
+/// the terrain are clamped to its edge. Normal displacement noise moves vertices slightly off the grid, queries treat
+/// each vertex as if it were still on the grid.
+/// </summary>
+class HeightQuery final
+{
+    public:
+
+        /// <summary> Batches larger than this are split across every hardware thread. </summary>
+        static const size_t parallelThreshold = 65536;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        HeightQuery()                                       = default;
+
+        /// <summary> Creates a view of the given heights. </summary>
+        /// <param name="heights"> The final terrain heights, one per vertex. </param>
+        /// <param name="spacingX"> The world distance between two vertices on the X axis. </param>
+        /// <param name="spacingZ"> The world distance between two vertices on the Z axis, negative if Z decreases. </param>
+        HeightQuery (const HeightPyramid& heights, const float spacingX, const float spacingZ);
+
+        HeightQuery (const HeightQuery& copy)               = default;
+        HeightQuery& operator= (const HeightQuery& copy)    = default;
+        ~HeightQuery()                                      = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Checks whether the view contains any terrain to query. </summary>
+        bool isValid() const                            { return m_heights != nullptr; }
+
+        /// <summary> Calculates the height of the terrain at the given world position. </summary>
+        /// <param name="x"> The world X co-ordinate. </param>
+        /// <param name="z"> The world Z co-ordinate. </param>
+        float height (const float x, const float z) const;
+
+        /// <summary> Calculates the normal of the terrain at the given world position. </summary>
+        /// <param name="x"> The world X co-ordinate. </param>
+        /// <param name="z"> The world Z co-ordinate. </param>
+        glm::vec3 normal (const float x, const float z) const;
+
+        /// <summary> Calculates the height and normal of the terrain for many world positions at once using SIMD. </summary>
+        /// <param name="x"> The world X co-ordinate of each position. </param>
+        /// <param name="z"> The world Z co-ordinate of each position. </param>
+        /// <param name="count"> How many positions to query. </param>
+        /// <param name="heights"> Where to write each height, may be nullptr if heights aren't required. </param>
+        /// <param name="normals"> Where to write each normal, may be nullptr if normals aren't required. </param>
+        void sample (const float* const x, const float* const z, const size_t count, float* const heights, glm::vec3* const normals = nullptr) const;
+
+    private:
+
+        /// <summary> Calculates a group of positions, the work behind HeightQuery::sample(). </summary>
+        void sampleRange (const float* const x, const float* const z, const size_t count, float* const heights, glm::vec3* const normals) const;
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        const float*    m_heights       { nullptr };    //!< The height of every vertex, stored row by row.
+        unsigned int    m_width         { 0 };          //!< How many vertices make up a row.
+        unsigned int    m_depth         { 0 };          //!< How many rows of vertices there are.
+        float           m_spacingX      { 0.f };        //!< The world distance between two vertices on the X axis.
+        float           m_spacingZ      { 0.f };        //!< The world distance between two vertices on the Z axis.
+        float           m_inverseX      { 0.f };        //!< One over the X spacing, converts world co-ordinates into grid co-ordinates.
+        float           m_inverseZ      { 0.f };        //!< One over the Z spacing, converts world co-ordinates into grid co-ordinates.
+};
+
+
+#endif // HEIGHT_QUERY_3GP_HPP
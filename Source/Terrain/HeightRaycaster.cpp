@@ -0,0 +1,315 @@
+#include "HeightRaycaster.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+
+// Personal headers.
+#include <Terrain/HeightPyramid.hpp>
+#include <Utility/ElementCreation.hpp>
+#include <Utility/Parallel.hpp>
+
+
+
+namespace
+{
+    /// <summary> The deepest the pyramid can be, a 4Gx4G grid. Three siblings wait on the stack for each level descended. </summary>
+    const auto maxLevels = 33U;
+
+    /// <summary> A block of quads waiting to be visited, it is left as a plain aggregate so the stack needn't be initialised. </summary>
+    struct Node final
+    {
+        unsigned int    level;  //!< The pyramid level of the block, level zero blocks are single quads.
+        unsigned int    x;      //!< The X co-ordinate of the block within its level.
+        unsigned int    z;      //!< The Z co-ordinate of the block within its level.
+        float           enter;  //!< The distance at which the ray enters the block.
+    };
+
+
+    /// <summary> Clips the given ray interval against a single axis of a box. </summary>
+    /// <returns> Whether any of the interval remains. </returns>
+    inline bool clipSlab (const float origin, const float direction, const float min, const float max, float& enter, float& exit)
+    {
+        // Parallel rays either always or never overlap the slab.
+        if (direction == 0.f)
+        {
+            return origin >= min && origin <= max;
+        }
+
+        const auto inverse = 1.f / direction,
+                   first   = (min - origin) * inverse,
+                   second  = (max - origin) * inverse;
+
+        enter = std::max (enter, std::min (first, second));
+        exit  = std::min (exit, std::max (first, second));
+
+        return enter <= exit;
+    }
+
+
+    /// <summary> Moller-Trumbore ray-triangle intersection. </summary>
+    /// <param name="distance"> Set to the distance along the ray of the intersection. </param>
+    /// <returns> Whether the ray intersects the triangle in front of its origin. </returns>
+    inline bool intersectTriangle (const glm::vec3& origin, const glm::vec3& direction,
+                                   const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& distance)
+    {
+        const auto edgeB = b - a,
+                   edgeC = c - a,
+                   p     = glm::cross (direction, edgeC);
+
+        const auto determinant = glm::dot (edgeB, p);
+
+        // The ray runs along the plane of the triangle.
+        if (std::abs (determinant) < 1e-12f)
+        {
+            return false;
+        }
+
+        const auto inverse = 1.f / determinant;
+        const auto s       = origin - a;
+        const auto u       = glm::dot (s, p) * inverse;
+
+        if (u < 0.f || u > 1.f)
+        {
+            return false;
+        }
+
+        const auto q = glm::cross (s, edgeB);
+        const auto v = glm::dot (direction, q) * inverse;
+
+        if (v < 0.f || u + v > 1.f)
+        {
+            return false;
+        }
+
+        distance = glm::dot (edgeC, q) * inverse;
+
+        return distance >= 0.f;
+    }
+}
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+HeightRaycaster::HeightRaycaster (const HeightPyramid& heights, const float spacingX, const float spacingZ, const unsigned int divisor)
+{
+    // We need at least a single quad to cast against.
+    assert (heights.getWidth() > 1 && heights.getDepth() > 1 && heights.getLevelCount() <= maxLevels);
+    assert (spacingX != 0.f && spacingZ != 0.f && divisor > 1);
+
+    m_heights  = &heights;
+    m_divisor  = divisor;
+    m_spacingX = spacingX;
+    m_spacingZ = spacingZ;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+bool HeightRaycaster::cast (const Ray& ray, Hit& hit) const
+{
+    assert (isValid());
+
+    hit = { };
+
+    const auto length = glm::length (ray.direction);
+
+    if (length == 0.f || !(ray.maxDistance > 0.f))
+    {
+        return false;
+    }
+
+    // Work in grid space where each quad is one unit wide and deep. Scaling X and Z doesn't change where along the ray
+    // an intersection lies so distances remain in world units when the world direction is normalised.
+    const auto worldDirection = ray.direction / length;
+
+    const auto origin    = glm::vec3 (ray.origin.x / m_spacingX, ray.origin.y, ray.origin.z / m_spacingZ),
+               direction = glm::vec3 (worldDirection.x / m_spacingX, worldDirection.y, worldDirection.z / m_spacingZ);
+
+    const auto quadsX = m_heights->getWidth() - 1,
+               quadsZ = m_heights->getDepth() - 1;
+
+    // Finds the interval of the ray within a block, the height range comes from the block and its neighbours above and
+    // to the right because the final row and column of quads in a block reach the first vertex of the next block.
+    const auto enterBlock = [&] (const unsigned int level, const unsigned int x, const unsigned int z, const float closest, float& enter)
+    {
+        const auto lastX = std::min (x + 1, m_heights->getLevelWidth (level) - 1),
+                   lastZ = std::min (z + 1, m_heights->getLevelDepth (level) - 1);
+
+        auto range = m_heights->getCell (level, x, z);
+
+        for (auto j = z; j <= lastZ; ++j)
+        {
+            for (auto i = x; i <= lastX; ++i)
+            {
+                const auto cell = m_heights->getCell (level, i, j);
+
+                range.min = std::min (range.min, cell.min);
+                range.max = std::max (range.max, cell.max);
+            }
+        }
+
+        const auto minX = (float) (x << level),
+                   minZ = (float) (z << level),
+                   maxX = (float) std::min ((x + 1) << level, quadsX),
+                   maxZ = (float) std::min ((z + 1) << level, quadsZ);
+
+        auto exit = closest;
+        enter     = 0.f;
+
+        return clipSlab (origin.x, direction.x, minX, maxX, enter, exit) &&
+               clipSlab (origin.y, direction.y, range.min, range.max, enter, exit) &&
+               clipSlab (origin.z, direction.z, minZ, maxZ, enter, exit);
+    };
+
+    // Visit blocks nearest first so the closest intersection is usually found straight away, letting every block
+    // behind it be skipped.
+    Node stack[maxLevels * 3 + 1];
+
+    auto closest = ray.maxDistance;
+    auto top     = 0U;
+    auto root    = Node { m_heights->getLevelCount() - 1, 0, 0, 0.f };
+
+    if (enterBlock (root.level, 0, 0, closest, root.enter))
+    {
+        stack[top++] = root;
+    }
+
+    while (top > 0)
+    {
+        const auto node = stack[--top];
+
+        // A closer intersection may have been found since the block was added.
+        if (node.enter > closest)
+        {
+            continue;
+        }
+
+        if (node.level == 0)
+        {
+            intersectQuad (node.x, node.z, origin, direction, closest, hit);
+            continue;
+        }
+
+        // Split the block into its children, skipping those beyond the edge of the terrain.
+        Node children[4];
+        auto childCount = 0U;
+
+        const auto level = node.level - 1;
+
+        for (auto j = 0U; j < 2; ++j)
+        {
+            for (auto i = 0U; i < 2; ++i)
+            {
+                auto child = Node { level, node.x * 2 + i, node.z * 2 + j, 0.f };
+
+                if ((child.x << level) < quadsX && (child.z << level) < quadsZ && enterBlock (level, child.x, child.z, closest, child.enter))
+                {
+                    children[childCount++] = child;
+                }
+            }
+        }
+
+        // Push the furthest child first so the nearest is visited next.
+        std::sort (children, children + childCount, [] (const Node& lhs, const Node& rhs) { return lhs.enter > rhs.enter; });
+
+        for (auto i = 0U; i < childCount; ++i)
+        {
+            stack[top++] = children[i];
+        }
+    }
+
+    if (hit.hit)
+    {
+        hit.distance = closest;
+        hit.position = ray.origin + worldDirection * closest;
+    }
+
+    return hit.hit;
+}
+
+
+void HeightRaycaster::cast (const Ray* const rays, const size_t count, Hit* const hits) const
+{
+    // Each ray is independent so they can be spread across threads freely.
+    util::parallelFor (0, count, [=] (const size_t i)
+    {
+        cast (rays[i], hits[i]);
+    }, parallelThreshold);
+}
+
+
+bool HeightRaycaster::isOccluded (const glm::vec3& from, const glm::vec3& to) const
+{
+    const auto direction = to - from;
+    const auto length    = glm::length (direction);
+
+    // Stop just short of the target so that positions resting on the surface can still be seen.
+    const Ray ray { from, direction, length * 0.999f };
+
+    Hit hit { };
+    return length > 0.f && cast (ray, hit);
+}
+
+
+//////////////////
+// Intersection //
+//////////////////
+
+void HeightRaycaster::intersectQuad (const unsigned int x, const unsigned int z, const glm::vec3& origin, const glm::vec3& direction,
+                                     float& closest, Hit& hit) const
+{
+    const auto& heights = m_heights->getHeights();
+    const auto  width   = m_heights->getWidth(),
+                index   = x + z * width;
+
+    const auto gridX  = (float) x,
+               gridZ  = (float) z;
+
+    const auto corner00 = glm::vec3 (gridX,       heights[index],             gridZ),
+               corner10 = glm::vec3 (gridX + 1.f, heights[index + 1],         gridZ),
+               corner01 = glm::vec3 (gridX,       heights[index + width],     gridZ + 1.f),
+               corner11 = glm::vec3 (gridX + 1.f, heights[index + width + 1], gridZ + 1.f);
+
+    // Split the quad along the same diagonal as the rendered mesh.
+    const glm::vec3* triangles[2][3] { };
+
+    if (util::isQuadMirrored (x, z, m_divisor))
+    {
+        triangles[0][0] = &corner00; triangles[0][1] = &corner10; triangles[0][2] = &corner01;
+        triangles[1][0] = &corner10; triangles[1][1] = &corner11; triangles[1][2] = &corner01;
+    }
+
+    else
+    {
+        triangles[0][0] = &corner00; triangles[0][1] = &corner10; triangles[0][2] = &corner11;
+        triangles[1][0] = &corner00; triangles[1][1] = &corner11; triangles[1][2] = &corner01;
+    }
+
+    for (const auto& triangle : triangles)
+    {
+        auto distance = 0.f;
+
+        if (intersectTriangle (origin, direction, *triangle[0], *triangle[1], *triangle[2], distance) && distance < closest)
+        {
+            // The normal must be calculated in world space because the grid isn't square in world units.
+            const auto toWorld = glm::vec3 (m_spacingX, 1.f, m_spacingZ);
+            const auto a       = *triangle[0] * toWorld;
+
+            auto normal = glm::cross (*triangle[1] * toWorld - a, *triangle[2] * toWorld - a);
+
+            closest    = distance;
+            hit.hit    = true;
+            hit.normal = glm::normalize (normal.y < 0.f ? -normal : normal);
+            hit.x      = x;
+            hit.z      = z;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef HEIGHT_RAYCASTER_3GP_HPP
+#define HEIGHT_RAYCASTER_3GP_HPP
+
+
+// STL headers.
+#include <cstddef>
+#include <limits>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Forward declarations.
+class HeightPyramid;
+
+
+/// <summary>
+/// Intersects rays with the final terrain surface for picking, line-of-sight and projectile tests. Rays descend the
+/// min/max height pyramid of the terrain as a quadtree, skipping every patch and block they pass above or below, and
+/// finish with an exact test against the two triangles of each quad they reach using the same diagonals as the
+/// rendered mesh. Vertices are treated as sitting on their grid position, like HeightQuery. Casting doesn't modify
+/// anything so a single raycaster can be shared by any number of threads until the terrain is rebuilt.
+/// </summary>
+class HeightRaycaster final
+{
+    public:
+
+        /// <summary> Batches larger than this are split across every hardware thread. </summary>
+        static const size_t parallelThreshold = 256;
+
+        /// <summary> A ray to cast against the terrain. </summary>
+        struct Ray final
+        {
+            glm::vec3   origin      { 0.f };                                        //!< Where the ray starts in world space.
+            glm::vec3   direction   { 0.f, -1.f, 0.f };                             //!< The direction of the ray, it doesn't need to be normalised.
+            float       maxDistance { std::numeric_limits<float>::infinity() };     //!< Intersections further than this are ignored.
+
+            /// <summary> Construct a Ray with the given values. </summary>
+            /// <param name="origin"> Where the ray starts in world space. </param>
+            /// <param name="direction"> The direction of the ray. </param>
+            /// <param name="maxDistance"> Intersections further than this are ignored. </param>
+            Ray (const glm::vec3& origin, const glm::vec3& direction, const float maxDistance = std::numeric_limits<float>::infinity())
+                : origin (origin), direction (direction), maxDistance (maxDistance) { }
+
+            Ray()                               = default;
+            Ray (const Ray& copy)               = default;
+            Ray& operator= (const Ray& copy)    = default;
+        };
+
+        /// <summary> The closest intersection of a ray with the terrain. </summary>
+        struct Hit final
+        {
+            bool            hit         { false };  //!< Whether the ray intersected the terrain.
+            float           distance    { 0.f };    //!< The world distance from the origin of the ray to the intersection.
+            glm::vec3       position    { 0.f };    //!< The world position of the intersection.
+            glm::vec3       normal      { 0.f };    //!< The upward facing normal of the triangle which was hit.
+            unsigned int    x           { 0 };      //!< The X co-ordinate of the first vertex of the quad which was hit.
+            unsigned int    z           { 0 };      //!< The Z co-ordinate of the first vertex of the quad which was hit.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        HeightRaycaster()                                           = default;
+
+        /// <summary> Creates a raycaster for the given heights. </summary>
+        /// <param name="heights"> The final terrain heights, one per vertex. It must outlive the raycaster. </param>
+        /// <param name="spacingX"> The world distance between two vertices on the X axis. </param>
+        /// <param name="spacingZ"> The world distance between two vertices on the Z axis, negative if Z decreases. </param>
+        /// <param name="divisor"> How many vertices wide and deep each patch is, this determines the triangle diagonals. </param>
+        HeightRaycaster (const HeightPyramid& heights, const float spacingX, const float spacingZ, const unsigned int divisor);
+
+        HeightRaycaster (const HeightRaycaster& copy)               = default;
+        HeightRaycaster& operator= (const HeightRaycaster& copy)    = default;
+        ~HeightRaycaster()                                          = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Checks whether the raycaster contains any terrain to cast against. </summary>
+        bool isValid() const                                        { return m_heights != nullptr; }
+
+        /// <summary> Finds the closest intersection of a ray with the terrain. </summary>
+        /// <param name="ray"> The ray to cast. </param>
+        /// <param name="hit"> Filled with the details of the intersection, hit.hit is false if nothing was hit. </param>
+        /// <returns> Whether the ray hit the terrain. </returns>
+        bool cast (const Ray& ray, Hit& hit) const;
+
+        /// <summary> Casts many rays at once, large batches are split across every hardware thread. </summary>
+        /// <param name="rays"> The rays to cast. </param>
+        /// <param name="count"> How many rays there are. </param>
+        /// <param name="hits"> Where to write the result of each ray. </param>
+        void cast (const Ray* const rays, const size_t count, Hit* const hits) const;
+
+        /// <summary> Checks whether the terrain blocks the line between two world positions. </summary>
+        /// <param name="from"> The position to look from. </param>
+        /// <param name="to"> The position to look at. </param>
+        bool isOccluded (const glm::vec3& from, const glm::vec3& to) const;
+
+    private:
+
+        /// <summary> Tests both triangles of a single quad, in grid space. </summary>
+        /// <param name="x"> The X co-ordinate of the first vertex of the quad. </param>
+        /// <param name="z"> The Z co-ordinate of the first vertex of the quad. </param>
+        /// <param name="origin"> The origin of the ray in grid space. </param>
+        /// <param name="direction"> The direction of the ray in grid space. </param>
+        /// <param name="closest"> The closest intersection found so far, updated if a closer one is found. </param>
+        /// <param name="hit"> Updated with the quad and normal if a closer intersection is found. </param>
+        void intersectQuad (const unsigned int x, const unsigned int z, const glm::vec3& origin, const glm::vec3& direction,
+                            float& closest, Hit& hit) const;
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        const HeightPyramid*    m_heights   { nullptr };    //!< The height range of every block of the terrain.
+        unsigned int            m_divisor   { 0 };          //!< How many vertices wide and deep each patch is.
+        float                   m_spacingX  { 0.f };        //!< The world distance between two vertices on the X axis.
+        float                   m_spacingZ  { 0.f };        //!< The world distance between two vertices on the Z axis.
+};
+
+
+#endif // HEIGHT_RAYCASTER_3GP_HPP
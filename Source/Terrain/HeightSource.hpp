@@ -0,0 +1,94 @@
+#ifndef HEIGHT_SOURCE_3GP_HPP
+#define HEIGHT_SOURCE_3GP_HPP
+
+
+// STL headers.
+#include <cstddef>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// <summary>
+/// An interface for anything which can provide a regular grid of heights to build terrain from. Only the heights are
+/// provided, the X and Z co-ordinates of each point are reconstructed from the grid position and world scale.
+/// </summary>
+class HeightSource
+{
+    public:
+
+        /// <summary> The largest width or height a source may have, so that every height can be indexed by a 32-bit size_t. </summary>
+        static const unsigned int maxDimension = 32768;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        HeightSource()                                      = default;
+        HeightSource (const HeightSource& copy)             = default;
+        HeightSource& operator= (const HeightSource& copy)  = default;
+        virtual ~HeightSource()                             = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets how many heights make up a row of the source. </summary>
+        virtual unsigned int getWidth() const = 0;
+
+        /// <summary> Gets how many rows of heights there are. </summary>
+        virtual unsigned int getHeight() const = 0;
+
+        /// <summary> Gets the dimensions of the source in world units. </summary>
+        virtual const glm::vec3& getWorldScale() const = 0;
+
+        /// <summary> Gets the height in world units at the given co-ordinates. </summary>
+        /// <param name="x"> The X co-ordinate of the height. </param>
+        /// <param name="y"> The Y co-ordinate of the height. </param>
+        virtual float getElevation (const size_t x, const size_t y) const = 0;
+
+        /// <summary> 
+        /// Copies a rectangle of heights in world units into the given array, row by row. Sources which are expensive to
+        /// access per height should override this to fetch whole blocks at once.
+        /// </summary>
+        /// <param name="x"> The X co-ordinate of the first height. </param>
+        /// <param name="y"> The Y co-ordinate of the first height. </param>
+        /// <param name="width"> How many heights wide the rectangle is. </param>
+        /// <param name="height"> How many heights deep the rectangle is. </param>
+        /// <param name="output"> Where to write the heights, must have room for width * height values. </param>
+        virtual void readElevations (const size_t x, const size_t y, const size_t width, const size_t height, float* const output) const;
+
+        /// <summary> Gets the world position of the point at the given co-ordinates. </summary>
+        /// <param name="x"> The X co-ordinate of the point. </param>
+        /// <param name="y"> The Y co-ordinate of the point. </param>
+        glm::vec3 getPoint (const size_t x, const size_t y) const;
+};
+
+
+inline void HeightSource::readElevations (const size_t x, const size_t y, const size_t width, const size_t height, float* const output) const
+{
+    for (size_t row = 0; row < height; ++row)
+    {
+        for (size_t column = 0; column < width; ++column)
+        {
+            output[column + row * width] = getElevation (x + column, y + row);
+        }
+    }
+}
+
+
+inline glm::vec3 HeightSource::getPoint (const size_t x, const size_t y) const
+{
+    // The X and Z co-ordinates are normalised by the grid position to get the world position.
+    const auto& scale = getWorldScale();
+
+    return { x / (float) (getWidth() - 1) * scale.x,
+             getElevation (x, y),
+             y / (float) (getHeight() - 1) * scale.z };
+}
+
+
+#endif // HEIGHT_SOURCE_3GP_HPP
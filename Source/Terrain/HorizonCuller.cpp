@@ -0,0 +1,268 @@
+#include "HorizonCuller.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+
+// Personal headers.
+#include <Terrain/PatchBounds.hpp>
+
+
+
+namespace
+{
+    /// <summary> The number of radians in a full circle. </summary>
+    const float fullCircle = 6.28318531f;
+
+    /// <summary> Wraps an angle into the range -pi to pi. </summary>
+    float wrapAngle (const float angle)
+    {
+        return angle - fullCircle * std::floor ((angle + fullCircle * 0.5f) / fullCircle);
+    }
+}
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+HorizonCuller::HorizonCuller (const unsigned int columns)
+    : m_columns (columns)
+{
+    assert (columns > 0);
+}
+
+
+HorizonCuller::HorizonCuller (HorizonCuller&& move)
+{
+    *this = std::move (move);
+}
+
+
+HorizonCuller& HorizonCuller::operator= (HorizonCuller&& move)
+{
+    if (this != &move)
+    {
+        m_columns    = move.m_columns;
+        m_blocks     = move.m_blocks;
+        m_occluders  = std::move (move.m_occluders);
+        m_heights    = std::move (move.m_heights);
+        m_horizon    = std::move (move.m_horizon);
+        m_order      = std::move (move.m_order);
+        m_pending    = std::move (move.m_pending);
+        m_occluded   = std::move (move.m_occluded);
+        m_statistics = move.m_statistics;
+    }
+
+    return *this;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void HorizonCuller::reset (const size_t count, const unsigned int blocks)
+{
+    assert (blocks > 0);
+
+    m_blocks = blocks;
+    m_occluders.assign (count * blocks, glm::vec4 (0.f));
+    m_heights.assign (count * blocks, 0.f);
+}
+
+
+void HorizonCuller::clear()
+{
+    m_occluders.clear();
+    m_heights.clear();
+    m_order.clear();
+    m_pending.clear();
+    m_occluded.clear();
+    m_statistics = Statistics { };
+}
+
+
+void HorizonCuller::setOccluder (const size_t patch, const unsigned int block, const glm::vec2& minimum, const glm::vec2& maximum, const float height)
+{
+    assert (block < m_blocks && patch * m_blocks + block < m_occluders.size());
+
+    const auto index = patch * m_blocks + block;
+
+    m_occluders[index] = glm::vec4 (minimum.x, minimum.y, maximum.x, maximum.y);
+    m_heights[index]   = height;
+}
+
+
+void HorizonCuller::cull (const glm::vec3& cameraPosition, const PatchBounds& bounds, std::vector<unsigned int>& visible)
+{
+    m_statistics        = Statistics { };
+    m_statistics.tested = visible.size();
+
+    // Every column starts with nothing in front of it.
+    m_horizon.assign (m_columns, -std::numeric_limits<float>::infinity());
+
+    const auto camera = glm::vec2 (cameraPosition.x, cameraPosition.z);
+
+    // Patches are visited in order of their nearest point so every occluder has been seen before anything behind it.
+    // The working buffers are kept between culls so they only grow until they suit the largest visible set.
+    m_order.clear();
+    m_pending.clear();
+    m_occluded.resize (bounds.getCount(), false);
+
+    for (const auto patch : visible)
+    {
+        const auto minimum = bounds.getMinimum (patch),
+                   maximum = bounds.getMaximum (patch);
+
+        Extent extent { };
+        findExtent (camera, glm::vec2 (minimum.x, minimum.z), glm::vec2 (maximum.x, maximum.z), extent);
+
+        m_order.emplace_back (extent.nearest, patch);
+    }
+
+    std::sort (m_order.begin(), m_order.end());
+
+    // An occluder only hides lines of sight which reach it before they reach the patch being tested, so it isn't added
+    // to the horizon until the patches left to test are all further away than every part of the occluder. The pending
+    // blocks are a min-heap so the nearest is always at the front.
+    const auto nearestFirst = std::greater<Entry>();
+
+    for (const auto& entry : m_order)
+    {
+        const auto patch = entry.second;
+
+        while (!m_pending.empty() && m_pending.front().first <= entry.first)
+        {
+            const auto  occluder = m_pending.front().second;
+            const auto& area     = m_occluders[occluder];
+            Extent extent { };
+
+            std::pop_heap (m_pending.begin(), m_pending.end(), nearestFirst);
+            m_pending.pop_back();
+            findExtent (camera, glm::vec2 (area.x, area.y), glm::vec2 (area.z, area.w), extent);
+
+            // A line of sight passes below the slab when its gradient is below the height difference divided by some
+            // distance across the area. The distances vary by direction so the weakest guarantee is kept, which is the
+            // furthest distance when the slab is above the camera and the nearest when it's below.
+            const auto height  = m_heights[occluder] - cameraPosition.y;
+            const auto tangent = height > 0.f ? height / extent.furthest : height / extent.nearest;
+
+            // Only columns which are entirely within the area are guaranteed to pass over it.
+            const auto first = (int) std::ceil (extent.first),
+                       last  = (int) std::floor (extent.last);
+
+            for (auto column = first; column < last; ++column)
+            {
+                auto& horizon = m_horizon[wrapColumn (column)];
+                horizon = std::max (horizon, tangent);
+            }
+
+            ++m_statistics.occluders;
+        }
+
+        // Find the steepest line of sight to any point of the bounding box.
+        const auto minimum = bounds.getMinimum (patch),
+                   maximum = bounds.getMaximum (patch);
+
+        Extent extent { };
+
+        if (findExtent (camera, glm::vec2 (minimum.x, minimum.z), glm::vec2 (maximum.x, maximum.z), extent) && extent.nearest > 0.f)
+        {
+            const auto height  = maximum.y - cameraPosition.y;
+            const auto tangent = height > 0.f ? height / extent.nearest : height / extent.furthest;
+
+            // Every column the box touches must be above it.
+            auto hidden = true;
+
+            for (auto column = (int) std::floor (extent.first); hidden && column <= (int) std::floor (extent.last); ++column)
+            {
+                hidden = m_horizon[wrapColumn (column)] >= tangent;
+            }
+
+            if (hidden)
+            {
+                m_occluded[patch] = true;
+                ++m_statistics.occluded;
+            }
+        }
+
+        // Occluded patches still hide what's behind them. The camera must be outside a block for it to be useful.
+        for (auto block = patch * m_blocks; block < (patch + 1) * m_blocks; ++block)
+        {
+            const auto& area = m_occluders[block];
+
+            if (findExtent (camera, glm::vec2 (area.x, area.y), glm::vec2 (area.z, area.w), extent) && extent.nearest > 0.f)
+            {
+                m_pending.emplace_back (extent.furthest, block);
+                std::push_heap (m_pending.begin(), m_pending.end(), nearestFirst);
+            }
+        }
+    }
+
+    // Keep the remaining patches in ascending order, then clear their flags ready for the next cull.
+    visible.erase (std::remove_if (visible.begin(), visible.end(), [&] (const unsigned int patch) { return m_occluded[patch]; }), visible.end());
+
+    for (const auto& entry : m_order)
+    {
+        m_occluded[entry.second] = false;
+    }
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+bool HorizonCuller::findExtent (const glm::vec2& camera, const glm::vec2& minimum, const glm::vec2& maximum, Extent& extent) const
+{
+    const auto gap   = glm::max (glm::max (minimum - camera, camera - maximum), glm::vec2 (0.f));
+    const auto reach = glm::max (glm::abs (minimum - camera), glm::abs (maximum - camera));
+
+    extent.nearest  = glm::length (gap);
+    extent.furthest = glm::length (reach);
+
+    if (gap.x == 0.f && gap.y == 0.f)
+    {
+        return false;
+    }
+
+    // The camera is outside of the rectangle so it covers less than half of the circle, measuring each corner from the
+    // direction of the centre avoids the angles wrapping around.
+    const auto centre    = (minimum + maximum) * 0.5f - camera;
+    const auto direction = std::atan2 (centre.y, centre.x);
+
+    auto lowest  = 0.f,
+         highest = 0.f;
+
+    for (auto corner = 0U; corner < 4; ++corner)
+    {
+        const auto point = glm::vec2 (corner & 1 ? maximum.x : minimum.x, corner & 2 ? maximum.y : minimum.y) - camera;
+        const auto angle = wrapAngle (std::atan2 (point.y, point.x) - direction);
+
+        lowest  = std::min (lowest, angle);
+        highest = std::max (highest, angle);
+    }
+
+    // Column zero begins at -pi.
+    const auto scale = m_columns / fullCircle;
+
+    extent.first = (direction + lowest + fullCircle * 0.5f) * scale;
+    extent.last  = (direction + highest + fullCircle * 0.5f) * scale;
+
+    return true;
+}
+
+
+int HorizonCuller::wrapColumn (const int column) const
+{
+    const auto columns = (int) m_columns;
+
+    return ((column % columns) + columns) % columns;
+}
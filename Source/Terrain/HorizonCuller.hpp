@@ -0,0 +1,132 @@
+#ifndef HORIZON_CULLER_3GP_HPP
+#define HORIZON_CULLER_3GP_HPP
+
+
+// STL headers.
+#include <utility>
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Forward declarations.
+class PatchBounds;
+
+
+/// <summary>
+/// Removes terrain patches which are hidden behind nearer terrain. Patches are visited front to back whilst a horizon
+/// is kept for each column of directions around the camera, storing the steepest elevation which is known to be below
+/// the terrain. Each block of a patch contributes the solid slab beneath its lowest point, which hides any line of sight
+/// passing through it. A patch is occluded when the top of its bounding box is below the horizon of every column it covers.
+/// The terrain must be a height field and the camera must be above it.
+/// </summary>
+class HorizonCuller final
+{
+    public:
+
+        /// <summary> How many columns the horizon is split into around the camera by default. </summary>
+        static const unsigned int defaultColumns = 2048;
+
+        /// <summary>
+        /// The outcome of the last call to cull().
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  tested      { 0 };  //!< How many patches were tested.
+            size_t  occluded    { 0 };  //!< How many patches were hidden by nearer terrain.
+            size_t  occluders   { 0 };  //!< How many blocks were added to the horizon.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a culler with the given horizon resolution. </summary>
+        /// <param name="columns"> How many columns the full circle around the camera is split into. </param>
+        HorizonCuller (const unsigned int columns = defaultColumns);
+
+        HorizonCuller (HorizonCuller&& move);
+        HorizonCuller& operator= (HorizonCuller&& move);
+
+        HorizonCuller (const HorizonCuller& copy)               = default;
+        HorizonCuller& operator= (const HorizonCuller& copy)    = default;
+        ~HorizonCuller()                                        = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the outcome of the last call to cull(). </summary>
+        const Statistics& getStatistics() const { return m_statistics; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Removes every occluder and prepares for the given number of patches. </summary>
+        /// <param name="count"> How many patches there are. </param>
+        /// <param name="blocks"> How many occluding blocks each patch has. </param>
+        void reset (const size_t count, const unsigned int blocks);
+
+        /// <summary> Removes every occluder. </summary>
+        void clear();
+
+        /// <summary> Sets an area a patch occludes, the terrain must be at or above the height over the whole area. </summary>
+        /// <param name="patch"> The index of the patch. </param>
+        /// <param name="block"> Which of the blocks of the patch to set. </param>
+        /// <param name="minimum"> The minimum X and Z co-ordinates covered by the block. </param>
+        /// <param name="maximum"> The maximum X and Z co-ordinates covered by the block. </param>
+        /// <param name="height"> The lowest height of the block. </param>
+        void setOccluder (const size_t patch, const unsigned int block, const glm::vec2& minimum, const glm::vec2& maximum, const float height);
+
+        /// <summary> Removes every patch which is hidden behind nearer patches from the visible set. </summary>
+        /// <param name="cameraPosition"> The world position of the camera, which must be above the terrain. </param>
+        /// <param name="bounds"> The bounding box of every patch. </param>
+        /// <param name="visible"> The patches to test in ascending order, occluded patches are removed. </param>
+        void cull (const glm::vec3& cameraPosition, const PatchBounds& bounds, std::vector<unsigned int>& visible);
+
+    private:
+
+        /// <summary> The horizontal distances and directions of a rectangle from the camera. </summary>
+        struct Extent final
+        {
+            float   nearest;    //!< The distance to the closest point of the rectangle.
+            float   furthest;   //!< The distance to the furthest point of the rectangle.
+            float   first;      //!< The lowest column position covered, it may be outside of the buffer.
+            float   last;       //!< The highest column position covered, it may be outside of the buffer.
+        };
+
+        /// <summary> Finds the extent of a rectangle from the camera. </summary>
+        /// <param name="camera"> The position of the camera on the X and Z axes. </param>
+        /// <param name="minimum"> The minimum corner of the rectangle. </param>
+        /// <param name="maximum"> The maximum corner of the rectangle. </param>
+        /// <param name="extent"> Filled with the extent unless the camera is above the rectangle. </param>
+        /// <returns> False if the camera is directly above the rectangle, which covers every direction. </returns>
+        bool findExtent (const glm::vec2& camera, const glm::vec2& minimum, const glm::vec2& maximum, Extent& extent) const;
+
+        /// <summary> Wraps a column position which may have gone around the circle into the buffer. </summary>
+        int wrapColumn (const int column) const;
+
+
+        /// <summary> A distance paired with a patch or block, ordered by the distance. </summary>
+        using Entry = std::pair<float, unsigned int>;
+
+
+        unsigned int            m_columns       { defaultColumns }; //!< How many columns the circle around the camera is split into.
+        unsigned int            m_blocks        { 1 };              //!< How many occluding blocks each patch has.
+        std::vector<glm::vec4>  m_occluders     { };                //!< The area of each block, the minimum X and Z in XY and the maximum in ZW.
+        std::vector<float>      m_heights       { };                //!< The lowest height of each block.
+        std::vector<float>      m_horizon       { };                //!< The tangent of the steepest occluded elevation in each column.
+        std::vector<Entry>      m_order         { };                //!< The patches being culled by the distance to their nearest point.
+        std::vector<Entry>      m_pending       { };                //!< A heap of the blocks waiting to join the horizon by their furthest distance.
+        std::vector<bool>       m_occluded      { };                //!< Whether each patch was hidden by the current cull, false between culls.
+        Statistics              m_statistics    { };                //!< The outcome of the last cull.
+};
+
+
+#endif // HORIZON_CULLER_3GP_HPP
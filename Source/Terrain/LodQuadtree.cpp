@@ -0,0 +1,363 @@
+#include "LodQuadtree.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+
+// Personal headers.
+#include <Utility/Parallel.hpp>
+
+
+
+namespace
+{
+    /// <summary> How far through the range of a level vertices begin to morph into the next level. </summary>
+    const float morphStart = 0.66f;
+
+    /// <summary> Tests whether any part of a box is within the given distance of a point. </summary>
+    bool isWithin (const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& point, const float distance)
+    {
+        const auto offset = glm::clamp (point, minimum, maximum) - point;
+
+        return glm::dot (offset, offset) <= distance * distance;
+    }
+}
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+LodQuadtree::LodQuadtree (LodQuadtree&& move)
+{
+    *this = std::move (move);
+}
+
+
+LodQuadtree& LodQuadtree::operator= (LodQuadtree&& move)
+{
+    if (this != &move)
+    {
+        m_levels     = std::move (move.m_levels);
+        m_selection  = std::move (move.m_selection);
+        m_spacing    = move.m_spacing;
+        m_camera     = move.m_camera;
+        m_width      = move.m_width;
+        m_depth      = move.m_depth;
+        m_gridSize   = move.m_gridSize;
+        m_statistics = move.m_statistics;
+
+        // Reset primitives.
+        move.m_width = 0;
+        move.m_depth = 0;
+    }
+
+    return *this;
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+glm::vec2 LodQuadtree::getMorphRange (const unsigned int level) const
+{
+    // Morphing finishes at the end of the range so the edge shared with a node of the next level is fully morphed.
+    const auto start = level > 0 ? m_levels[level - 1].range : 0.f,
+               end   = m_levels[level].range;
+
+    return glm::vec2 (start + (end - start) * morphStart, end);
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void LodQuadtree::build (const HeightPyramid& pyramid, const glm::vec2& spacing, const unsigned int gridSize)
+{
+    assert (gridSize > 0 && gridSize % 2 == 0);
+
+    clear();
+
+    if (pyramid.getWidth() < 2 || pyramid.getDepth() < 2)
+    {
+        return;
+    }
+
+    m_spacing  = spacing;
+    m_width    = pyramid.getWidth();
+    m_depth    = pyramid.getDepth();
+    m_gridSize = gridSize;
+
+    // Nodes cover the quads between the vertices, the root is the first level with a single node.
+    auto quads = gridSize;
+
+    while (true)
+    {
+        Level level { };
+        level.width  = (m_width - 2) / quads + 1;
+        level.depth  = (m_depth - 2) / quads + 1;
+        level.heights.resize ((size_t) level.width * level.depth);
+
+        m_levels.push_back (std::move (level));
+
+        if (m_levels.back().width == 1 && m_levels.back().depth == 1)
+        {
+            break;
+        }
+
+        quads *= 2;
+    }
+
+    // Nodes on the finest level include the vertices they share with the nodes ahead, every level above merges the
+    // four nodes below it.
+    for (auto index = 0U; index < m_levels.size(); ++index)
+    {
+        auto& level = m_levels[index];
+
+        for (auto z = 0U; z < level.depth; ++z)
+        {
+            for (auto x = 0U; x < level.width; ++x)
+            {
+                auto& range = level.heights[x + z * level.width];
+
+                if (index == 0)
+                {
+                    range = pyramid.getRange (x * gridSize, z * gridSize, (x + 1) * gridSize, (z + 1) * gridSize);
+                    continue;
+                }
+
+                const auto& below = m_levels[index - 1];
+
+                range = below.heights[x * 2 + z * 2 * below.width];
+
+                for (auto child = 1U; child < 4; ++child)
+                {
+                    const auto childX = x * 2 + (child & 1),
+                               childZ = z * 2 + (child >> 1);
+
+                    if (childX < below.width && childZ < below.depth)
+                    {
+                        const auto& childRange = below.heights[childX + childZ * below.width];
+
+                        range.min = std::min (range.min, childRange.min);
+                        range.max = std::max (range.max, childRange.max);
+                    }
+                }
+            }
+        }
+
+        for (auto z = 0U; z < level.depth; ++z)
+        {
+            for (auto x = 0U; x < level.width; ++x)
+            {
+                glm::vec3 minimum { }, maximum { };
+                getBox (index, x, z, minimum, maximum);
+
+                level.diagonal = std::max (level.diagonal, glm::length (maximum - minimum));
+            }
+        }
+    }
+
+    // Each level is drawn unmorphed at the start of its range and with the grid of the next level at the end, so its
+    // error is the worst of both. The root has no next level.
+    auto error = 0.f;
+
+    for (auto index = 0U; index < m_levels.size(); ++index)
+    {
+        if (index + 1 < m_levels.size())
+        {
+            error = std::max (error, measureError (pyramid, 2U << index));
+        }
+
+        m_levels[index].error = error;
+    }
+}
+
+
+void LodQuadtree::clear()
+{
+    m_levels.clear();
+    m_selection.clear();
+
+    m_width      = 0;
+    m_depth      = 0;
+    m_statistics = Statistics { };
+}
+
+
+void LodQuadtree::select (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const float viewportHeight, const float pixelError)
+{
+    assert (viewportHeight > 0.f && pixelError > 0.f);
+
+    m_selection.clear();
+    m_statistics = Statistics { };
+    m_camera     = cameraPosition;
+
+    if (m_levels.empty())
+    {
+        return;
+    }
+
+    // The view transform doesn't scale so the second row of the combined transform is as long as the vertical scale
+    // of the projection. An error at a given distance covers this many pixels once divided by the distance.
+    const auto projectionScale = glm::length (glm::vec3 (projectionView[0][1], projectionView[1][1], projectionView[2][1])),
+               pixelsPerError  = projectionScale * viewportHeight * 0.5f / pixelError;
+
+    // Every range must be at least double the one below so a node only ever meets nodes one level away. Nodes must
+    // also be small compared to their range, a node reaches no further than its diagonal beyond the range of its level
+    // so it never meets a node of the next level which has started to morph.
+    auto previous = 0.f;
+
+    for (auto index = 0U; index + 1 < m_levels.size(); ++index)
+    {
+        auto& level = m_levels[index];
+
+        level.range = std::max (std::max (level.error * pixelsPerError, level.diagonal / morphStart), previous * 2.f);
+        previous    = level.range;
+    }
+
+    // The root covers whatever is beyond every other level.
+    const auto root = (unsigned int) m_levels.size() - 1;
+
+    m_levels[root].range = std::numeric_limits<float>::max();
+
+    visit (util::Frustum { projectionView }, root, 0, 0, util::Frustum::allPlanes);
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+float LodQuadtree::measureError (const HeightPyramid& pyramid, const unsigned int step) const
+{
+    const auto& heights = pyramid.getHeights();
+    const auto  width   = m_width;
+
+    std::vector<float> rowErrors (m_depth, 0.f);
+
+    // The grid is drawn with the same diagonal as every quad of the terrain, from the first vertex to the last. Points
+    // beyond the terrain are clamped to its edge.
+    util::parallelFor (0, m_depth, [&] (const size_t row)
+    {
+        const auto z      = (unsigned int) row,
+                   firstZ = z / step * step,
+                   lastZ  = std::min (firstZ + step, m_depth - 1);
+
+        const auto v = lastZ > firstZ ? (float) (z - firstZ) / (lastZ - firstZ) : 0.f;
+
+        auto error = 0.f;
+
+        for (auto x = 0U; x < width; ++x)
+        {
+            const auto firstX = x / step * step,
+                       lastX  = std::min (firstX + step, width - 1);
+
+            const auto u = lastX > firstX ? (float) (x - firstX) / (lastX - firstX) : 0.f;
+
+            const auto h00 = heights[firstX + firstZ * width], h10 = heights[lastX + firstZ * width],
+                       h01 = heights[firstX + lastZ * width],  h11 = heights[lastX + lastZ * width];
+
+            const auto drawn = u >= v ? h00 + u * (h10 - h00) + v * (h11 - h10)
+                                      : h00 + v * (h01 - h00) + u * (h11 - h01);
+
+            error = std::max (error, std::abs (heights[x + z * width] - drawn));
+        }
+
+        rowErrors[row] = error;
+    }, 64);
+
+    return *std::max_element (rowErrors.cbegin(), rowErrors.cend());
+}
+
+
+void LodQuadtree::getBox (const unsigned int level, const unsigned int x, const unsigned int z, glm::vec3& minimum, glm::vec3& maximum) const
+{
+    const auto  quads  = m_gridSize << level;
+    const auto& range  = m_levels[level].heights[x + z * m_levels[level].width];
+    const auto  firstX = x * quads,
+                firstZ = z * quads,
+                lastX  = std::min (firstX + quads, m_width - 1),
+                lastZ  = std::min (firstZ + quads, m_depth - 1);
+
+    // Z usually decreases so the corners may swap.
+    const auto first = glm::vec2 (firstX * m_spacing.x, firstZ * m_spacing.y),
+               last  = glm::vec2 (lastX * m_spacing.x, lastZ * m_spacing.y);
+
+    minimum = glm::vec3 (std::min (first.x, last.x), range.min, std::min (first.y, last.y));
+    maximum = glm::vec3 (std::max (first.x, last.x), range.max, std::max (first.y, last.y));
+}
+
+
+bool LodQuadtree::visit (const util::Frustum& frustum, const unsigned int level, const unsigned int x, const unsigned int z, unsigned int planes)
+{
+    ++m_statistics.nodesVisited;
+
+    glm::vec3 minimum { }, maximum { };
+    getBox (level, x, z, minimum, maximum);
+
+    // Nothing needs drawing off-screen, so the parent doesn't have to draw it either.
+    if (frustum.classify (minimum, maximum, planes) == util::Frustum::Containment::Outside)
+    {
+        return true;
+    }
+
+    if (!isWithin (minimum, maximum, m_camera, m_levels[level].range))
+    {
+        return false;
+    }
+
+    const auto addNode = [&] (const unsigned int quadrants)
+    {
+        Node node { };
+        node.x         = x * (m_gridSize << level);
+        node.z         = z * (m_gridSize << level);
+        node.level     = level;
+        node.quadrants = quadrants;
+
+        m_selection.push_back (node);
+
+        const auto quarters = (quadrants & 1) + (quadrants >> 1 & 1) + (quadrants >> 2 & 1) + (quadrants >> 3 & 1);
+
+        ++m_statistics.nodesSelected;
+        m_statistics.draws     += quadrants == allQuadrants ? 1 : quarters;
+        m_statistics.triangles += (size_t) quarters * m_gridSize * m_gridSize / 2;
+    };
+
+    // Nodes entirely beyond the range of the level below are drawn whole.
+    if (level == 0 || !isWithin (minimum, maximum, m_camera, m_levels[level - 1].range))
+    {
+        addNode (allQuadrants);
+        return true;
+    }
+
+    // Otherwise each child draws itself if it can, the rest are drawn as quarters of this node. Children beyond the
+    // edge of the terrain have nothing to draw.
+    const auto& below     = m_levels[level - 1];
+    auto        quadrants = 0U;
+
+    for (auto child = 0U; child < 4; ++child)
+    {
+        const auto childX = x * 2 + (child & 1),
+                   childZ = z * 2 + (child >> 1);
+
+        if (childX < below.width && childZ < below.depth && !visit (frustum, level - 1, childX, childZ, planes))
+        {
+            quadrants |= 1U << child;
+        }
+    }
+
+    if (quadrants != 0)
+    {
+        addNode (quadrants);
+    }
+
+    return true;
+}
@@ -0,0 +1,171 @@
+#ifndef LOD_QUADTREE_3GP_HPP
+#define LOD_QUADTREE_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Personal headers.
+#include <Terrain/HeightPyramid.hpp>
+#include <Utility/Frustum.hpp>
+
+
+/// <summary>
+/// A continuous distance-dependent level of detail (CDLOD) quadtree over the vertices of a terrain. Every node is drawn
+/// with the same grid of quads, a node on the finest level spaces the grid one vertex apart and each level above spaces
+/// it twice as far. Each level is given a range from the camera which keeps its geometric error below a bound in
+/// pixels, nodes are selected on the finest level whose range reaches them. Vertices morph into the grid of the next
+/// level as they approach the end of the range, so neighbouring nodes of different levels meet without cracks and no
+/// stitching is needed. The number of nodes selected depends on the view rather than the size of the terrain.
+/// </summary>
+class LodQuadtree final
+{
+    public:
+
+        /// <summary> How many quads wide and deep the grid of every node is by default. </summary>
+        static const unsigned int defaultGridSize = 32;
+
+        /// <summary> A mask containing every quarter of a node. </summary>
+        static const unsigned int allQuadrants = 0xF;
+
+        /// <summary>
+        /// A node chosen to be drawn by the last call to select().
+        /// </summary>
+        struct Node final
+        {
+            unsigned int    x           { 0 };  //!< The X co-ordinate of the first vertex of the node.
+            unsigned int    z           { 0 };  //!< The Z co-ordinate of the first vertex of the node.
+            unsigned int    level       { 0 };  //!< Zero for the finest level, the grid spans twice as many vertices on each level above.
+            unsigned int    quadrants   { 0 };  //!< A bit for each quarter of the node to draw, in the order first X, next X, next Z and so on.
+        };
+
+        /// <summary>
+        /// The amount of work done by the last call to select().
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  nodesVisited    { 0 };  //!< How many nodes were tested against the frustum and the ranges.
+            size_t  nodesSelected   { 0 };  //!< How many nodes are drawn either whole or in part.
+            size_t  draws           { 0 };  //!< How many whole nodes and quarters of nodes are drawn.
+            size_t  triangles       { 0 };  //!< How many triangles are drawn.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        LodQuadtree()                                       = default;
+
+        LodQuadtree (LodQuadtree&& move);
+        LodQuadtree& operator= (LodQuadtree&& move);
+
+        LodQuadtree (const LodQuadtree& copy)               = default;
+        LodQuadtree& operator= (const LodQuadtree& copy)    = default;
+        ~LodQuadtree()                                      = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets how many quads wide and deep the grid of every node is. </summary>
+        unsigned int getGridSize() const                    { return m_gridSize; }
+
+        /// <summary> Gets how many levels the tree has, the root is on the last level. </summary>
+        unsigned int getLevelCount() const                  { return (unsigned int) m_levels.size(); }
+
+        /// <summary> Gets the largest error a node of the given level may show, including whilst it morphs into the next level. </summary>
+        float getError (const unsigned int level) const     { return m_levels[level].error; }
+
+        /// <summary> Gets the furthest distance from the camera a node of the given level is used, as of the last call to select(). </summary>
+        float getRange (const unsigned int level) const     { return m_levels[level].range; }
+
+        /// <summary> Gets the distances from the camera at which vertices of the given level begin and finish morphing into the next level. </summary>
+        glm::vec2 getMorphRange (const unsigned int level) const;
+
+        /// <summary> Gets the camera position used by the last call to select(), vertices morph by their distance from it. </summary>
+        const glm::vec3& getCameraPosition() const          { return m_camera; }
+
+        /// <summary> Gets every node chosen by the last call to select(). </summary>
+        const std::vector<Node>& getSelection() const       { return m_selection; }
+
+        /// <summary> Gets the amount of work done by the last call to select(). </summary>
+        const Statistics& getStatistics() const             { return m_statistics; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Builds the tree over the heights of a terrain, measuring the error of every level. </summary>
+        /// <param name="pyramid"> The heights of every vertex of the terrain. </param>
+        /// <param name="spacing"> The distance between vertices on the X and Z axes. </param>
+        /// <param name="gridSize"> How many quads wide and deep the grid of every node is, it must be even. </param>
+        void build (const HeightPyramid& pyramid, const glm::vec2& spacing, const unsigned int gridSize = defaultGridSize);
+
+        /// <summary> Removes every level. </summary>
+        void clear();
+
+        /// <summary> Chooses the nodes to draw from the camera, skipping those which are off-screen. </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        /// <param name="viewportHeight"> How many pixels tall the view is. </param>
+        /// <param name="pixelError"> The largest error in pixels a node may show. </param>
+        void select (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const float viewportHeight, const float pixelError);
+
+    private:
+
+        /// <summary>
+        /// Every node on a level of the tree.
+        /// </summary>
+        struct Level final
+        {
+            unsigned int                        width       { 0 };      //!< How many nodes wide the level is.
+            unsigned int                        depth       { 0 };      //!< How many nodes deep the level is.
+            std::vector<HeightPyramid::Range>   heights     { };        //!< The height range of every node, stored row by row.
+            float                               error       { 0.f };    //!< The largest distance between the terrain and the morphed grid of the level.
+            float                               diagonal    { 0.f };    //!< The longest diagonal of the bounding box of any node.
+            float                               range       { 0.f };    //!< The furthest distance from the camera the level is used.
+        };
+
+        /// <summary> Finds the largest distance between every height and the surface drawn by a grid with the given spacing. </summary>
+        /// <param name="pyramid"> The heights of every vertex of the terrain. </param>
+        /// <param name="step"> How many vertices apart the points of the grid are. </param>
+        float measureError (const HeightPyramid& pyramid, const unsigned int step) const;
+
+        /// <summary> Gets the bounding box of a node. </summary>
+        /// <param name="level"> The level of the node. </param>
+        /// <param name="x"> The column of the node within its level. </param>
+        /// <param name="z"> The row of the node within its level. </param>
+        /// <param name="minimum"> Replaced with the minimum corner of the box. </param>
+        /// <param name="maximum"> Replaced with the maximum corner of the box. </param>
+        void getBox (const unsigned int level, const unsigned int x, const unsigned int z, glm::vec3& minimum, glm::vec3& maximum) const;
+
+        /// <summary> Adds a node or the parts of it which the nodes below can't draw. </summary>
+        /// <param name="frustum"> The volume visible to the camera. </param>
+        /// <param name="level"> The level of the node. </param>
+        /// <param name="x"> The column of the node within its level. </param>
+        /// <param name="z"> The row of the node within its level. </param>
+        /// <param name="planes"> The planes the parent node crosses, only these need testing. </param>
+        /// <returns> False if the node is beyond the range of its level so the parent must draw it, true otherwise. </returns>
+        bool visit (const util::Frustum& frustum, const unsigned int level, const unsigned int x, const unsigned int z, unsigned int planes);
+
+
+        std::vector<Level>  m_levels        { };                    //!< Every level of the tree, the finest is first.
+        std::vector<Node>   m_selection     { };                    //!< The nodes chosen by the last selection.
+        glm::vec2           m_spacing       { 0.f };                //!< The distance between vertices on the X and Z axes.
+        glm::vec3           m_camera        { 0.f };                //!< The camera position of the last selection.
+        unsigned int        m_width         { 0 };                  //!< How many vertices wide the terrain is.
+        unsigned int        m_depth         { 0 };                  //!< How many vertices deep the terrain is.
+        unsigned int        m_gridSize      { defaultGridSize };    //!< How many quads wide and deep the grid of every node is.
+        Statistics          m_statistics    { };                    //!< The amount of work done by the last selection.
+};
+
+
+#endif // LOD_QUADTREE_3GP_HPP
@@ -0,0 +1,318 @@
+#include "OcclusionCuller.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+
+// Personal headers.
+#include <Terrain/HeightPyramid.hpp>
+#include <Terrain/PatchBounds.hpp>
+#include <Utility/Frustum.hpp>
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+OcclusionCuller::OcclusionCuller (const unsigned int occluders)
+    : m_occluders (occluders)
+{
+}
+
+
+OcclusionCuller::OcclusionCuller (OcclusionCuller&& move)
+{
+    *this = std::move (move);
+}
+
+
+OcclusionCuller& OcclusionCuller::operator= (OcclusionCuller&& move)
+{
+    if (this != &move)
+    {
+        m_buffer      = std::move (move.m_buffer);
+        m_heights     = std::move (move.m_heights);
+        m_patchOrder  = std::move (move.m_patchOrder);
+        m_tileHeights = std::move (move.m_tileHeights);
+        m_triangles   = std::move (move.m_triangles);
+        m_order       = std::move (move.m_order);
+        m_occluded    = std::move (move.m_occluded);
+        m_spacing     = move.m_spacing;
+        m_occluders   = move.m_occluders;
+        m_meshCountX  = move.m_meshCountX;
+        m_meshCountZ  = move.m_meshCountZ;
+        m_divisor     = move.m_divisor;
+        m_blocks      = move.m_blocks;
+        m_statistics  = move.m_statistics;
+
+        // Reset primitives.
+        move.m_meshCountX = 0;
+        move.m_meshCountZ = 0;
+        move.m_divisor    = 0;
+        move.m_blocks     = 0;
+    }
+
+    return *this;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void OcclusionCuller::build (const HeightPyramid& pyramid, const std::vector<unsigned int>& patchOrder, const unsigned int meshCountX,
+                             const unsigned int meshCountZ, const unsigned int divisor, const glm::vec2& spacing, const unsigned int blocks)
+{
+    assert (blocks > 0 && blocks <= divisor && patchOrder.size() == meshCountX * meshCountZ);
+
+    m_patchOrder = patchOrder;
+    m_spacing    = spacing;
+    m_meshCountX = meshCountX;
+    m_meshCountZ = meshCountZ;
+    m_divisor    = divisor;
+    m_blocks     = blocks;
+
+    // Blocks span from their first vertex to the first vertex of the next block, so the stitching between patches is
+    // covered and neighbouring blocks share an edge. The surface above the edge is at least as high as both blocks.
+    const auto columns = meshCountX * blocks,
+               rows    = meshCountZ * blocks;
+
+    m_heights.resize ((size_t) columns * rows);
+
+    for (auto z = 0U; z < rows; ++z)
+    {
+        for (auto x = 0U; x < columns; ++x)
+        {
+            m_heights[x + z * columns] = pyramid.getRange (getEdgeVertex (x), getEdgeVertex (z), getEdgeVertex (x + 1), getEdgeVertex (z + 1)).min;
+        }
+    }
+
+    // Tiles are only bound when the occluders are rasterised without the patches, so the range of the whole tile will do.
+    m_tileHeights.resize ((size_t) meshCountX * meshCountZ);
+
+    for (auto tile = 0U; tile < m_tileHeights.size(); ++tile)
+    {
+        const auto firstX = tile % meshCountX * divisor,
+                   firstZ = tile / meshCountX * divisor;
+        const auto range  = pyramid.getRange (firstX, firstZ, firstX + divisor, firstZ + divisor);
+
+        m_tileHeights[tile] = glm::vec2 (range.min, range.max);
+    }
+}
+
+
+void OcclusionCuller::clear()
+{
+    m_heights.clear();
+    m_patchOrder.clear();
+    m_tileHeights.clear();
+    m_triangles.clear();
+    m_order.clear();
+    m_occluded.clear();
+
+    m_meshCountX = 0;
+    m_meshCountZ = 0;
+    m_divisor    = 0;
+    m_blocks     = 0;
+    m_statistics = Statistics { };
+}
+
+
+void OcclusionCuller::cull (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const PatchBounds& bounds, std::vector<unsigned int>& visible)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    m_statistics = Statistics { };
+    m_buffer.begin (projectionView);
+    m_triangles.clear();
+    m_order.clear();
+
+    if (m_heights.empty() || visible.empty())
+    {
+        return;
+    }
+
+    // The nearest patches hide the most so they're drawn as the occluders.
+    for (const auto patch : visible)
+    {
+        const auto closest = glm::clamp (cameraPosition, bounds.getMinimum (patch), bounds.getMaximum (patch));
+        const auto offset  = closest - cameraPosition;
+
+        m_order.emplace_back (glm::dot (offset, offset), patch);
+    }
+
+    const auto occluders  = drawNearest (true);
+    const auto rasterised = std::chrono::steady_clock::now();
+
+    // Occluders are never tested against themselves. The flags are kept between culls so they're cleared afterwards.
+    m_occluded.resize (bounds.getCount(), false);
+
+    for (auto i = occluders; i < m_order.size(); ++i)
+    {
+        const auto patch = m_order[i].second;
+
+        if (m_buffer.isOccluded (bounds.getMinimum (patch), bounds.getMaximum (patch)))
+        {
+            m_occluded[patch] = true;
+            ++m_statistics.occluded;
+        }
+    }
+
+    // Keep the remaining patches in ascending order.
+    visible.erase (std::remove_if (visible.begin(), visible.end(), [&] (const unsigned int patch) { return m_occluded[patch]; }), visible.end());
+
+    for (auto i = occluders; i < m_order.size(); ++i)
+    {
+        m_occluded[m_order[i].second] = false;
+    }
+
+    const auto tested = std::chrono::steady_clock::now();
+
+    m_statistics.tested                = m_order.size() - occluders;
+    m_statistics.rasteriseMilliseconds = std::chrono::duration<double, std::milli> (rasterised - start).count();
+    m_statistics.testMilliseconds      = std::chrono::duration<double, std::milli> (tested - rasterised).count();
+}
+
+
+void OcclusionCuller::rasterise (const glm::mat4& projectionView, const glm::vec3& cameraPosition)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    m_statistics = Statistics { };
+    m_buffer.begin (projectionView);
+    m_triangles.clear();
+    m_order.clear();
+
+    if (m_heights.empty())
+    {
+        return;
+    }
+
+    // Without the patch bounds each tile is bound by the heights beneath it, the tiles are few enough to test them all.
+    const util::Frustum frustum { projectionView };
+
+    for (auto tile = 0U; tile < m_tileHeights.size(); ++tile)
+    {
+        const auto firstX  = tile % m_meshCountX * m_blocks,
+                   firstZ  = tile / m_meshCountX * m_blocks;
+        const auto first   = getBlockEdge (firstX, firstZ),
+                   last    = getBlockEdge (firstX + m_blocks, firstZ + m_blocks);
+        const auto minimum = glm::vec3 (std::min (first.x, last.x), m_tileHeights[tile].x, std::min (first.y, last.y)),
+                   maximum = glm::vec3 (std::max (first.x, last.x), m_tileHeights[tile].y, std::max (first.y, last.y));
+
+        if (frustum.intersects (minimum, maximum))
+        {
+            const auto offset = glm::clamp (cameraPosition, minimum, maximum) - cameraPosition;
+
+            m_order.emplace_back (glm::dot (offset, offset), tile);
+        }
+    }
+
+    drawNearest (false);
+
+    m_statistics.rasteriseMilliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+size_t OcclusionCuller::drawNearest (const bool storedPatches)
+{
+    const auto occluders = std::min ((size_t) m_occluders, m_order.size());
+
+    std::nth_element (m_order.begin(), m_order.begin() + occluders, m_order.end());
+
+    for (size_t i = 0; i < occluders; ++i)
+    {
+        const auto index = m_order[i].second;
+
+        addOccluder (storedPatches ? m_patchOrder[index] : index, m_triangles);
+    }
+
+    m_buffer.addTriangles (m_triangles.data(), m_triangles.size() / 3);
+    m_buffer.rasterise();
+
+    m_statistics.occluders = occluders;
+    m_statistics.triangles = m_buffer.getStatistics().triangles;
+
+    return occluders;
+}
+
+
+void OcclusionCuller::addOccluder (const unsigned int tile, std::vector<glm::vec3>& triangles) const
+{
+    const auto columns = m_meshCountX * m_blocks,
+               rows    = m_meshCountZ * m_blocks,
+               firstX  = tile % m_meshCountX * m_blocks,
+               firstZ  = tile / m_meshCountX * m_blocks;
+
+    // Walls stand on the edge between two blocks, filling the gap between their heights.
+    const auto addWall = [&] (const glm::vec2& start, const glm::vec2& end, const float first, const float second)
+    {
+        const auto low  = std::min (first, second),
+                   high = std::max (first, second);
+
+        if (high > low)
+        {
+            const glm::vec3 corners[] = { glm::vec3 (start.x, low, start.y), glm::vec3 (end.x, low, end.y),
+                                          glm::vec3 (end.x, high, end.y),    glm::vec3 (start.x, high, start.y) };
+
+            triangles.insert (triangles.end(), { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] });
+        }
+    };
+
+    for (auto z = firstZ; z < firstZ + m_blocks; ++z)
+    {
+        for (auto x = firstX; x < firstX + m_blocks; ++x)
+        {
+            const auto height  = getBlockHeight (x, z);
+            const auto minimum = getBlockEdge (x, z),
+                       maximum = getBlockEdge (x + 1, z + 1);
+
+            // The top of the block.
+            const glm::vec3 corners[] = { glm::vec3 (minimum.x, height, minimum.y), glm::vec3 (maximum.x, height, minimum.y),
+                                          glm::vec3 (maximum.x, height, maximum.y), glm::vec3 (minimum.x, height, maximum.y) };
+
+            triangles.insert (triangles.end(), { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] });
+
+            // Walls are shared with the block ahead, but the first edges of the patch also get walls so the occluder is
+            // closed when the patches behind it aren't drawn.
+            if (x + 1 < columns)
+            {
+                addWall (glm::vec2 (maximum.x, minimum.y), maximum, height, getBlockHeight (x + 1, z));
+            }
+
+            if (z + 1 < rows)
+            {
+                addWall (glm::vec2 (minimum.x, maximum.y), maximum, height, getBlockHeight (x, z + 1));
+            }
+
+            if (x == firstX && x > 0)
+            {
+                addWall (minimum, glm::vec2 (minimum.x, maximum.y), height, getBlockHeight (x - 1, z));
+            }
+
+            if (z == firstZ && z > 0)
+            {
+                addWall (minimum, glm::vec2 (maximum.x, minimum.y), height, getBlockHeight (x, z - 1));
+            }
+        }
+    }
+}
+
+
+glm::vec2 OcclusionCuller::getBlockEdge (const unsigned int x, const unsigned int z) const
+{
+    // The last edge is the far side of the terrain rather than the first vertex of another patch.
+    const auto vertexX = std::min (getEdgeVertex (x), m_meshCountX * m_divisor - 1),
+               vertexZ = std::min (getEdgeVertex (z), m_meshCountZ * m_divisor - 1);
+
+    return glm::vec2 (vertexX * m_spacing.x, vertexZ * m_spacing.y);
+}
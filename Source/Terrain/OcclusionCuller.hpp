@@ -0,0 +1,161 @@
+#ifndef OCCLUSION_CULLER_3GP_HPP
+#define OCCLUSION_CULLER_3GP_HPP
+
+
+// STL headers.
+#include <utility>
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Personal headers.
+#include <Utility/OcclusionBuffer.hpp>
+
+
+// Forward declarations.
+class HeightPyramid;
+class PatchBounds;
+
+
+/// <summary>
+/// Removes terrain patches which are hidden behind the nearest patches, using a depth buffer rendered on the CPU. Each
+/// patch is given a coarse occluder made of flat blocks, each at the lowest height beneath it, with walls joining blocks
+/// of different heights. The occluders are always inside the terrain so anything they hide is hidden by the terrain too.
+/// The buffer is kept after culling so other objects, such as the shapes placed on the terrain, can be tested against it.
+/// When the patches aren't drawn the occluders can be rasterised on their own for those objects.
+/// </summary>
+class OcclusionCuller final
+{
+    public:
+
+        /// <summary> How many of the nearest visible patches are drawn as occluders by default. </summary>
+        static const unsigned int defaultOccluders = 32;
+
+        /// <summary>
+        /// The outcome of the last call to cull().
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  occluders               { 0 };      //!< How many patches were drawn into the buffer.
+            size_t  triangles               { 0 };      //!< How many occluder triangles were rasterised.
+            size_t  tested                  { 0 };      //!< How many patches were tested against the buffer.
+            size_t  occluded                { 0 };      //!< How many patches were hidden behind the occluders.
+            double  rasteriseMilliseconds   { 0.0 };    //!< Time spent choosing, building and rasterising the occluders.
+            double  testMilliseconds        { 0.0 };    //!< Time spent testing patches against the buffer.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a culler which draws the given number of patches as occluders. </summary>
+        /// <param name="occluders"> How many of the nearest visible patches to draw. </param>
+        OcclusionCuller (const unsigned int occluders = defaultOccluders);
+
+        OcclusionCuller (OcclusionCuller&& move);
+        OcclusionCuller& operator= (OcclusionCuller&& move);
+
+        OcclusionCuller (const OcclusionCuller& copy)               = default;
+        OcclusionCuller& operator= (const OcclusionCuller& copy)    = default;
+        ~OcclusionCuller()                                          = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the depth buffer drawn by the last call to cull(). </summary>
+        const util::OcclusionBuffer& getBuffer() const  { return m_buffer; }
+
+        /// <summary> Gets the outcome of the last call to cull(). </summary>
+        const Statistics& getStatistics() const         { return m_statistics; }
+
+        /// <summary> Gets how many of the nearest visible patches are drawn as occluders. </summary>
+        unsigned int getOccluderCount() const           { return m_occluders; }
+
+        /// <summary> Sets how many of the nearest visible patches are drawn as occluders. </summary>
+        void setOccluderCount (const unsigned int occluders) { m_occluders = occluders; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Finds the height of every occluder block from the heights of the finished terrain. </summary>
+        /// <param name="pyramid"> The heights of every vertex of the terrain. </param>
+        /// <param name="patchOrder"> The row-major tile of each stored patch. </param>
+        /// <param name="meshCountX"> How many patches wide the grid is. </param>
+        /// <param name="meshCountZ"> How many patches deep the grid is. </param>
+        /// <param name="divisor"> How many vertices wide and deep each patch is. </param>
+        /// <param name="spacing"> The distance between vertices on the X and Z axes. </param>
+        /// <param name="blocks"> How many blocks each occluder is split into on each axis. </param>
+        void build (const HeightPyramid& pyramid, const std::vector<unsigned int>& patchOrder, const unsigned int meshCountX,
+                    const unsigned int meshCountZ, const unsigned int divisor, const glm::vec2& spacing, const unsigned int blocks);
+
+        /// <summary> Removes every occluder. </summary>
+        void clear();
+
+        /// <summary> Draws the nearest visible patches and removes every other patch which is hidden behind them. </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        /// <param name="bounds"> The bounding box of every patch. </param>
+        /// <param name="visible"> The patches to test in ascending order, occluded patches are removed. </param>
+        void cull (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const PatchBounds& bounds, std::vector<unsigned int>& visible);
+
+        /// <summary> Draws the occluders of the nearest tiles inside the frustum without testing any patches. </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        void rasterise (const glm::mat4& projectionView, const glm::vec3& cameraPosition);
+
+    private:
+
+        /// <summary> A squared distance from the camera paired with a patch or tile. </summary>
+        using Entry = std::pair<float, unsigned int>;
+
+        /// <summary> Draws the nearest entries of the order as occluders, moving them to the front of the order. </summary>
+        /// <param name="storedPatches"> Whether the order holds stored patches rather than row-major tiles. </param>
+        /// <returns> How many occluders were drawn. </returns>
+        size_t drawNearest (const bool storedPatches);
+
+        /// <summary> Adds the occluder of a patch to a list of triangles. </summary>
+        /// <param name="tile"> The row-major tile of the patch. </param>
+        /// <param name="triangles"> The list to add three positions to for every triangle. </param>
+        void addOccluder (const unsigned int tile, std::vector<glm::vec3>& triangles) const;
+
+        /// <summary> Gets the height of a block, which may belong to a neighbouring patch. </summary>
+        /// <param name="x"> The column of the block across the whole terrain. </param>
+        /// <param name="z"> The row of the block across the whole terrain. </param>
+        float getBlockHeight (const unsigned int x, const unsigned int z) const { return m_heights[x + z * m_meshCountX * m_blocks]; }
+
+        /// <summary> Gets the first vertex of a block on either axis. </summary>
+        /// <param name="edge"> The column or row of the block across the whole terrain. </param>
+        unsigned int getEdgeVertex (const unsigned int edge) const  { return edge / m_blocks * m_divisor + m_divisor * (edge % m_blocks) / m_blocks; }
+
+        /// <summary> Gets the world position of the edge of a block on the X and Z axes. </summary>
+        /// <param name="x"> The column of the edge across the whole terrain. </param>
+        /// <param name="z"> The row of the edge across the whole terrain. </param>
+        glm::vec2 getBlockEdge (const unsigned int x, const unsigned int z) const;
+
+
+        util::OcclusionBuffer       m_buffer        { };                    //!< The depth of the occluders drawn by the last cull.
+        std::vector<float>          m_heights       { };                    //!< The height of every block across the whole terrain, row by row.
+        std::vector<unsigned int>   m_patchOrder    { };                    //!< The row-major tile of each stored patch.
+        std::vector<glm::vec2>      m_tileHeights   { };                    //!< The lowest and highest height of each row-major tile.
+        std::vector<glm::vec3>      m_triangles     { };                    //!< The occluder triangles drawn by the last cull.
+        std::vector<Entry>          m_order         { };                    //!< The candidates of the last cull by their distance.
+        std::vector<bool>           m_occluded      { };                    //!< Whether each patch was hidden by the current cull, false between culls.
+        glm::vec2                   m_spacing       { 0.f };                //!< The distance between vertices on the X and Z axes.
+        unsigned int                m_occluders     { defaultOccluders };   //!< How many of the nearest visible patches are drawn.
+        unsigned int                m_meshCountX    { 0 };                  //!< How many patches wide the grid is.
+        unsigned int                m_meshCountZ    { 0 };                  //!< How many patches deep the grid is.
+        unsigned int                m_divisor       { 0 };                  //!< How many vertices wide and deep each patch is.
+        unsigned int                m_blocks        { 0 };                  //!< How many blocks each occluder has on each axis.
+        Statistics                  m_statistics    { };                    //!< The outcome of the last cull.
+};
+
+
+#endif // OCCLUSION_CULLER_3GP_HPP
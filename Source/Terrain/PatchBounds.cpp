@@ -0,0 +1,123 @@
+#include "PatchBounds.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+
+// Personal headers.
+#include <Utility/SIMD.hpp>
+
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void PatchBounds::reset (const size_t count)
+{
+    // The arrays are padded to a whole SIMD group. Boxes begin inverted so the first box included replaces them.
+    const auto padded  = (count + util::simd::width - 1) / util::simd::width * util::simd::width;
+    const auto largest = std::numeric_limits<float>::max();
+
+    m_count = count;
+    m_minX.assign (padded, largest);
+    m_minY.assign (padded, largest);
+    m_minZ.assign (padded, largest);
+    m_maxX.assign (padded, -largest);
+    m_maxY.assign (padded, -largest);
+    m_maxZ.assign (padded, -largest);
+}
+
+
+void PatchBounds::clear()
+{
+    m_count = 0;
+    m_minX.clear();
+    m_minY.clear();
+    m_minZ.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+    m_maxZ.clear();
+}
+
+
+void PatchBounds::include (const size_t patch, const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    assert (patch < m_count);
+
+    m_minX[patch] = std::min (m_minX[patch], minimum.x);
+    m_minY[patch] = std::min (m_minY[patch], minimum.y);
+    m_minZ[patch] = std::min (m_minZ[patch], minimum.z);
+    m_maxX[patch] = std::max (m_maxX[patch], maximum.x);
+    m_maxY[patch] = std::max (m_maxY[patch], maximum.y);
+    m_maxZ[patch] = std::max (m_maxZ[patch], maximum.z);
+}
+
+
+void PatchBounds::cull (const util::Frustum& frustum, std::vector<unsigned int>& visible) const
+{
+    namespace simd = util::simd;
+
+    visible.clear();
+
+    // Each plane only needs the corner of every box which is furthest along its normal, that is the same component of
+    // every box so the arrays to test can be chosen once per plane.
+    struct Plane final
+    {
+        simd::Float         x, y, z, w;
+        const float*        cornerX;
+        const float*        cornerY;
+        const float*        cornerZ;
+    };
+
+    const auto& frustumPlanes = frustum.getPlanes();
+    Plane planes[util::Frustum::planeCount];
+
+    for (size_t i = 0; i < frustumPlanes.size(); ++i)
+    {
+        const auto& plane = frustumPlanes[i];
+
+        planes[i].x       = simd::set (plane.x);
+        planes[i].y       = simd::set (plane.y);
+        planes[i].z       = simd::set (plane.z);
+        planes[i].w       = simd::set (plane.w);
+        planes[i].cornerX = plane.x >= 0.f ? m_maxX.data() : m_minX.data();
+        planes[i].cornerY = plane.y >= 0.f ? m_maxY.data() : m_minY.data();
+        planes[i].cornerZ = plane.z >= 0.f ? m_maxZ.data() : m_minZ.data();
+    }
+
+    const auto zero = simd::set (0.f);
+
+    for (size_t first = 0; first < m_count; first += simd::width)
+    {
+        // A box is outside if its corner is behind any plane.
+        auto outside = 0;
+
+        for (const auto& plane : planes)
+        {
+            const auto distance = simd::madd (plane.x, simd::load (plane.cornerX + first),
+                                  simd::madd (plane.y, simd::load (plane.cornerY + first),
+                                  simd::madd (plane.z, simd::load (plane.cornerZ + first), plane.w)));
+
+            outside |= simd::bits (simd::less (distance, zero));
+
+            if (outside == simd::allLanes)
+            {
+                break;
+            }
+        }
+
+        const auto lanes = std::min ((size_t) simd::width, m_count - first);
+
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            if ((outside & (1 << lane)) == 0)
+            {
+                visible.push_back ((unsigned int) (first + lane));
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef PATCH_BOUNDS_3GP_HPP
+#define PATCH_BOUNDS_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Personal headers.
+#include <Utility/Frustum.hpp>
+
+
+/// <summary>
+/// The axis-aligned bounding box of every terrain patch, indexed in the same order as the patch meshes. Each component
+/// of the boxes is stored in its own array so that a group of patches can be tested against a plane at once.
+/// </summary>
+class PatchBounds final
+{
+    public:
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets how many patches have bounds. </summary>
+        size_t getCount() const { return m_count; }
+
+        /// <summary> Gets the minimum corner of the box of a patch. </summary>
+        glm::vec3 getMinimum (const size_t patch) const { return { m_minX[patch], m_minY[patch], m_minZ[patch] }; }
+
+        /// <summary> Gets the maximum corner of the box of a patch. </summary>
+        glm::vec3 getMaximum (const size_t patch) const { return { m_maxX[patch], m_maxY[patch], m_maxZ[patch] }; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Discards every box and prepares empty boxes for the given number of patches. </summary>
+        /// <param name="count"> How many patches need bounds. </param>
+        void reset (const size_t count);
+
+        /// <summary> Removes every box. </summary>
+        void clear();
+
+        /// <summary> Grows the box of a patch to contain the given box, an empty box becomes the given box. </summary>
+        /// <param name="patch"> The index of the patch. </param>
+        /// <param name="minimum"> The minimum corner of the box to include. </param>
+        /// <param name="maximum"> The maximum corner of the box to include. </param>
+        void include (const size_t patch, const glm::vec3& minimum, const glm::vec3& maximum);
+
+        /// <summary> Finds every patch with a box which may be inside the frustum, several patches are tested at once. </summary>
+        /// <param name="frustum"> The volume visible to the camera. </param>
+        /// <param name="visible"> Replaced with the index of every visible patch, in ascending order. </param>
+        void cull (const util::Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+    private:
+
+        size_t              m_count { 0 };  //!< How many patches have bounds, the arrays are padded to a whole number of SIMD groups.
+        std::vector<float>  m_minX  { };    //!< The minimum X co-ordinate of each patch.
+        std::vector<float>  m_minY  { };    //!< The minimum Y co-ordinate of each patch.
+        std::vector<float>  m_minZ  { };    //!< The minimum Z co-ordinate of each patch.
+        std::vector<float>  m_maxX  { };    //!< The maximum X co-ordinate of each patch.
+        std::vector<float>  m_maxY  { };    //!< The maximum Y co-ordinate of each patch.
+        std::vector<float>  m_maxZ  { };    //!< The maximum Z co-ordinate of each patch.
+};
+
+
+#endif // PATCH_BOUNDS_3GP_HPP
@@ -0,0 +1,221 @@
+#include "PatchClusters.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+
+// Engine headers.
+#include <tgl/tgl.h>
+
+
+// Personal headers.
+#include <Utility/ElementCreation.hpp>
+
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void PatchClusters::reset (const unsigned int divisor, const unsigned int clusterSize, const unsigned int patchCount)
+{
+    assert (divisor > 1 && clusterSize > 0 && clusterSize % 2 == 0);
+
+    clear();
+
+    m_divisor     = divisor;
+    m_clusterSize = clusterSize;
+
+    // A patch has one less quad than it has vertices on each axis, the last cluster on each axis holds the remainder.
+    const auto quads           = divisor - 1,
+               clustersPerAxis = (quads + clusterSize - 1) / clusterSize,
+               remainder       = quads % clusterSize;
+
+    m_clustersPerPatch = clustersPerAxis * clustersPerAxis;
+    m_clusters.resize (m_clustersPerPatch * patchCount);
+
+    // Shapes are ordered so the full size comes first on each axis, followed by the remainder if there is one.
+    std::vector<unsigned int> sizes { std::min (clusterSize, quads) };
+
+    if (remainder > 0 && clusterSize < quads)
+    {
+        sizes.push_back (remainder);
+    }
+
+    for (const auto depth : sizes)
+    {
+        for (const auto width : sizes)
+        {
+            Shape shape { };
+            shape.width = width;
+            shape.depth = depth;
+
+            // Every cluster begins on an even quad so they all share the pattern of the patch grid.
+            util::triangleAlgorithm (shape.elements, 0, width, depth, 1, divisor);
+
+            m_shapes.push_back (std::move (shape));
+        }
+    }
+
+    // The largest index belongs to the far corner of a full cluster.
+    const auto largestIndex = sizes.front() * divisor + sizes.front();
+
+    m_indexType = largestIndex <= std::numeric_limits<uint16_t>::max() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+
+void PatchClusters::clear()
+{
+    m_shapes.clear();
+    m_clusters.clear();
+    m_drawCounts.clear();
+    m_drawOffsets.clear();
+    m_drawBaseVertices.clear();
+
+    m_statistics       = Statistics { };
+    m_indexType        = 0;
+    m_divisor          = 0;
+    m_clusterSize      = 0;
+    m_clustersPerPatch = 0;
+}
+
+
+void PatchClusters::addPatch (const unsigned int patch, const std::vector<Vertex>& vertices, const GLint firstVertex)
+{
+    assert (vertices.size() == m_divisor * m_divisor && (patch + 1) * m_clustersPerPatch <= m_clusters.size());
+
+    const auto quads     = m_divisor - 1,
+               sizeCount = m_shapes.size() > 1 ? 2U : 1U;
+
+    std::vector<glm::vec3> normals { };
+
+    auto index = patch * m_clustersPerPatch;
+
+    for (auto firstZ = 0U; firstZ < quads; firstZ += m_clusterSize)
+    {
+        for (auto firstX = 0U; firstX < quads; firstX += m_clusterSize)
+        {
+            const auto width = std::min (m_clusterSize, quads - firstX),
+                       depth = std::min (m_clusterSize, quads - firstZ),
+                       first = firstX + firstZ * m_divisor;
+
+            Cluster cluster { };
+            cluster.firstVertex = firstVertex + (GLint) first;
+            cluster.shape       = (width == m_shapes.front().width ? 0 : 1) + (depth == m_shapes.front().depth ? 0 : sizeCount);
+
+            // The bounds include every vertex of the cluster, including the shared edges.
+            cluster.minimum = cluster.maximum = vertices[first].position;
+
+            for (auto z = 0U; z <= depth; ++z)
+            {
+                for (auto x = 0U; x <= width; ++x)
+                {
+                    const auto& position = vertices[first + x + z * m_divisor].position;
+
+                    cluster.minimum = glm::min (cluster.minimum, position);
+                    cluster.maximum = glm::max (cluster.maximum, position);
+                }
+            }
+
+            // The cone uses the face normals, which face towards the viewer when the triangle is front facing.
+            const auto& elements = m_shapes[cluster.shape].elements;
+            normals.clear();
+
+            auto sum = glm::vec3 (0.f);
+
+            for (size_t i = 0; i < elements.size(); i += 3)
+            {
+                const auto& a = vertices[first + elements[i]].position;
+                const auto& b = vertices[first + elements[i + 1]].position;
+                const auto& c = vertices[first + elements[i + 2]].position;
+
+                const auto normal = glm::cross (b - a, c - a);
+                const auto length = glm::length (normal);
+
+                if (length > 0.f)
+                {
+                    normals.push_back (normal / length);
+                    sum += normals.back();
+                }
+            }
+
+            const auto sumLength = glm::length (sum);
+
+            if (sumLength > 0.f)
+            {
+                cluster.coneAxis = sum / sumLength;
+
+                auto minimumDot = 1.f;
+
+                for (const auto& normal : normals)
+                {
+                    minimumDot = std::min (minimumDot, glm::dot (cluster.coneAxis, normal));
+                }
+
+                // Cones which reach a hemisphere or wider always contain a triangle which could face the camera.
+                cluster.coneCutoff = minimumDot > 0.f ? std::sqrt (1.f - minimumDot * minimumDot) : 1.f;
+            }
+
+            m_clusters[index++] = cluster;
+        }
+    }
+}
+
+
+void PatchClusters::cull (const util::Frustum& frustum, const glm::vec3& cameraPosition, const std::vector<unsigned int>& patches)
+{
+    m_drawCounts.clear();
+    m_drawOffsets.clear();
+    m_drawBaseVertices.clear();
+    m_statistics = Statistics { };
+
+    for (const auto patch : patches)
+    {
+        const auto first = patch * m_clustersPerPatch;
+
+        for (auto i = first; i < first + m_clustersPerPatch; ++i)
+        {
+            const auto& cluster   = m_clusters[i];
+            const auto& shape     = m_shapes[cluster.shape];
+            const auto  triangles = shape.elements.size() / 3;
+
+            ++m_statistics.clusters;
+            m_statistics.trianglesBefore += triangles;
+
+            if (!frustum.intersects (cluster.minimum, cluster.maximum))
+            {
+                ++m_statistics.frustumCulled;
+                continue;
+            }
+
+            if (isBackFacing (cluster, cameraPosition))
+            {
+                ++m_statistics.backFacingCulled;
+                continue;
+            }
+
+            m_drawCounts.push_back ((GLsizei) shape.mesh.elementCount);
+            m_drawOffsets.push_back (reinterpret_cast<const void*> ((size_t) shape.mesh.elementsOffset));
+            m_drawBaseVertices.push_back (cluster.firstVertex);
+
+            m_statistics.trianglesAfter += triangles;
+        }
+    }
+}
+
+
+bool PatchClusters::isBackFacing (const Cluster& cluster, const glm::vec3& cameraPosition)
+{
+    // A triangle faces away when the direction from the camera to the triangle is within 90 degrees of its normal. That
+    // holds for every normal in the cone when the direction is within 90 degrees minus the cone angle of the axis, the
+    // bounding sphere of the cluster is used so the test holds for every point of every triangle.
+    const auto centre   = (cluster.minimum + cluster.maximum) * 0.5f;
+    const auto radius   = glm::length (cluster.maximum - centre);
+    const auto toCentre = centre - cameraPosition;
+
+    return glm::dot (toCentre, cluster.coneAxis) >= cluster.coneCutoff * glm::length (toCentre) + radius;
+}
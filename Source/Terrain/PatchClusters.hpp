@@ -0,0 +1,149 @@
+#ifndef PATCH_CLUSTERS_3GP_HPP
+#define PATCH_CLUSTERS_3GP_HPP
+
+
+// STL headers.
+#include <cstddef>
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// OpenGL aliases.
+using GLenum    = unsigned int;
+using GLint     = int;
+using GLsizei   = int;
+
+
+// Personal headers.
+#include <Renderer/Mesh.hpp>
+#include <Renderer/Vertex.hpp>
+#include <Utility/Frustum.hpp>
+
+
+/// <summary>
+/// Splits the grid of every terrain patch into small square clusters of quads. Each cluster stores a bounding box and
+/// a cone containing the normal of each of its triangles so that clusters which are off-screen or face away from the
+/// camera can be skipped, even when the rest of their patch is visible. Clusters are drawn using a handful of shared
+/// element templates, one for each size of cluster, with the base vertex moving the template onto the cluster.
+/// </summary>
+class PatchClusters final
+{
+    public:
+
+        /// <summary>
+        /// The element template used by every cluster with the same dimensions. Clusters at the far edges of a patch are
+        /// smaller when the number of quads isn't a multiple of the cluster size.
+        /// </summary>
+        struct Shape final
+        {
+            unsigned int                width       { 0 };  //!< How many quads wide the cluster is.
+            unsigned int                depth       { 0 };  //!< How many quads deep the cluster is.
+            std::vector<unsigned int>   elements    { };    //!< The triangle list of the cluster relative to its first vertex.
+            Mesh                        mesh        { };    //!< The offset and count of the template in the element buffer.
+        };
+
+        /// <summary>
+        /// The bounds of a cluster and where its vertices begin.
+        /// </summary>
+        struct Cluster final
+        {
+            glm::vec3       minimum     { 0.f };    //!< The minimum corner of the bounding box.
+            glm::vec3       maximum     { 0.f };    //!< The maximum corner of the bounding box.
+            glm::vec3       coneAxis    { 0.f };    //!< The average direction of the triangle normals.
+            float           coneCutoff  { 1.f };    //!< The sine of the angle between the axis and the furthest normal, 1 can never be culled.
+            GLint           firstVertex { 0 };      //!< The index of the first vertex of the cluster in the vertex buffer.
+            unsigned int    shape       { 0 };      //!< The index of the template used to draw the cluster.
+        };
+
+        /// <summary>
+        /// The outcome of the last call to cull().
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  clusters            { 0 };  //!< How many clusters were tested.
+            size_t  frustumCulled       { 0 };  //!< How many clusters were outside of the frustum.
+            size_t  backFacingCulled    { 0 };  //!< How many clusters only contained triangles facing away from the camera.
+            size_t  trianglesBefore     { 0 };  //!< How many triangles the tested clusters contain.
+            size_t  trianglesAfter      { 0 };  //!< How many triangles will be drawn.
+        };
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the template of each cluster size, the mesh of each must be set before drawing. </summary>
+        std::vector<Shape>& getShapes()                 { return m_shapes; }
+
+        /// <summary> Gets the type of the indices in every cluster template. </summary>
+        GLenum getIndexType() const                     { return m_indexType; }
+
+        /// <summary> Gets the number of clusters in each patch. </summary>
+        unsigned int getClustersPerPatch() const        { return m_clustersPerPatch; }
+
+        /// <summary> Gets every cluster, the clusters of each patch are stored together in the order of the patches. </summary>
+        const std::vector<Cluster>& getClusters() const { return m_clusters; }
+
+        /// <summary> Gets the outcome of the last call to cull(). </summary>
+        const Statistics& getStatistics() const         { return m_statistics; }
+
+        /// <summary> Gets the element count of each visible cluster, ready for glMultiDrawElementsBaseVertex(). </summary>
+        const std::vector<GLsizei>& getDrawCounts() const       { return m_drawCounts; }
+
+        /// <summary> Gets the element offset of each visible cluster, ready for glMultiDrawElementsBaseVertex(). </summary>
+        const std::vector<const void*>& getDrawOffsets() const  { return m_drawOffsets; }
+
+        /// <summary> Gets the base vertex of each visible cluster, ready for glMultiDrawElementsBaseVertex(). </summary>
+        const std::vector<GLint>& getDrawBaseVertices() const   { return m_drawBaseVertices; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Removes every cluster and prepares the templates for patches of the given size. </summary>
+        /// <param name="divisor"> How many vertices wide and deep each patch is. </param>
+        /// <param name="clusterSize"> How many quads wide and deep each cluster is, this must be even so every cluster begins with the same diagonal. </param>
+        /// <param name="patchCount"> How many patches will be added. </param>
+        void reset (const unsigned int divisor, const unsigned int clusterSize, const unsigned int patchCount);
+
+        /// <summary> Removes every cluster and template. </summary>
+        void clear();
+
+        /// <summary> Sets the clusters of a patch, patches may be added in any order. </summary>
+        /// <param name="patch"> The index the patch is stored at. </param>
+        /// <param name="vertices"> The full precision vertices of the patch. </param>
+        /// <param name="firstVertex"> The index of the first vertex of the patch in the vertex buffer. </param>
+        void addPatch (const unsigned int patch, const std::vector<Vertex>& vertices, const GLint firstVertex);
+
+        /// <summary> Creates the list of clusters to draw from the given patches, skipping those which can't be seen. </summary>
+        /// <param name="frustum"> The volume visible to the camera. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        /// <param name="patches"> The index of every patch which may be visible. </param>
+        void cull (const util::Frustum& frustum, const glm::vec3& cameraPosition, const std::vector<unsigned int>& patches);
+
+    private:
+
+        /// <summary> Tests whether every triangle of a cluster faces away from the camera. </summary>
+        /// <param name="cluster"> The cluster to test. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        static bool isBackFacing (const Cluster& cluster, const glm::vec3& cameraPosition);
+
+
+        std::vector<Shape>          m_shapes            { };     //!< The template for each size of cluster.
+        std::vector<Cluster>        m_clusters          { };     //!< Every cluster of every patch.
+        std::vector<GLsizei>        m_drawCounts        { };     //!< The element count of each visible cluster.
+        std::vector<const void*>    m_drawOffsets       { };     //!< The element offset of each visible cluster.
+        std::vector<GLint>          m_drawBaseVertices  { };     //!< The base vertex of each visible cluster.
+        Statistics                  m_statistics        { };     //!< The outcome of the last cull.
+        GLenum                      m_indexType         { 0 };   //!< Whether the templates use 16-bit or 32-bit indices.
+        unsigned int                m_divisor           { 0 };   //!< How many vertices wide and deep each patch is.
+        unsigned int                m_clusterSize       { 0 };   //!< How many quads wide and deep a full cluster is.
+        unsigned int                m_clustersPerPatch  { 0 };   //!< How many clusters each patch is split into.
+};
+
+
+#endif // PATCH_CLUSTERS_3GP_HPP
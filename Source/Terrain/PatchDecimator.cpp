@@ -0,0 +1,669 @@
+#include "PatchDecimator.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <utility>
+
+
+// Personal headers.
+#include <Terrain/HeightPyramid.hpp>
+#include <Utility/Parallel.hpp>
+
+
+
+namespace
+{
+    /// <summary>
+    /// The header at the start of a bake file, followed by the patch table and the elements of every patch.
+    /// </summary>
+    struct BakeHeader final
+    {
+        char        magic[4];       //!< Always "HDEC".
+        uint32_t    version;        //!< The version of the header, currently 1.
+        uint32_t    width;          //!< How many vertices wide the terrain is.
+        uint32_t    depth;          //!< How many vertices deep the terrain is.
+        uint32_t    divisor;        //!< How many vertices wide and deep each patch is.
+        float       errorBound;     //!< The vertical error bound the patches were decimated to.
+        float       error;          //!< The largest vertical error left in any patch.
+        uint32_t    patchCount;     //!< How many entries the patch table has.
+        uint64_t    heightsHash;    //!< The hash of the heights the patches were decimated from.
+        uint64_t    elementCount;   //!< How many elements follow the patch table.
+    };
+
+    const char      bakeMagic[4] = { 'H', 'D', 'E', 'C' };
+    const uint32_t  bakeVersion  = 1;
+
+
+    /// <summary>
+    /// A Delaunay triangulation of the vertices of a single patch which greedily inserts the vertex furthest from the
+    /// surface drawn. Vertices are identified by their index within the patch so triangles can be used as elements.
+    /// Co-ordinates are small integers so every predicate is exact.
+    /// </summary>
+    class Triangulation final
+    {
+        public:
+
+            Triangulation (const HeightPyramid& pyramid, const unsigned int firstX, const unsigned int firstZ, const unsigned int size)
+                : m_pyramid (pyramid), m_firstX (firstX), m_firstZ (firstZ), m_size ((int) size),
+                  m_inserted ((size_t) size * size, false) { }
+
+            /// <summary> Triangulates the border then inserts vertices until none is further than the bound from the surface. </summary>
+            void decimate (const float errorBound, std::vector<uint32_t>& elements, float& error)
+            {
+                const auto last = m_size - 1;
+
+                // Two triangles cover the corners with the same diagonal as the grid templates.
+                for (const auto corner : { 0, last, last + last * m_size, last * m_size })
+                {
+                    m_inserted[corner] = true;
+                }
+
+                addTriangle (0, last, last + last * m_size);
+                addTriangle (last + last * m_size, last * m_size, 0);
+                link (0, 2, 1);
+                link (1, 2, 0);
+
+                // Every border vertex is kept so the stitching of the neighbouring patches still joins. Triangles are
+                // only measured once the border is complete.
+                for (auto i = 1; i < last; ++i)
+                {
+                    insert (i);
+                    insert (last + i * m_size);
+                    insert (i + last * m_size);
+                    insert (i * m_size);
+                }
+
+                m_measuring = true;
+
+                for (auto triangle = 0; triangle < (int) m_triangles.size(); ++triangle)
+                {
+                    if (m_triangles[triangle].alive)
+                    {
+                        measure (triangle);
+                    }
+                }
+
+                while (!m_queue.empty() && m_queue.top().first > errorBound)
+                {
+                    const auto entry = m_queue.top();
+                    m_queue.pop();
+
+                    // Entries are left behind when their triangle is replaced.
+                    const auto& triangle = m_triangles[entry.second];
+
+                    if (triangle.alive && triangle.error == entry.first && !m_inserted[triangle.candidate])
+                    {
+                        m_start = entry.second;
+                        insert (triangle.candidate);
+                    }
+                }
+
+                error = 0.f;
+
+                for (const auto& triangle : m_triangles)
+                {
+                    if (triangle.alive)
+                    {
+                        elements.insert (elements.end(), { (uint32_t) triangle.v[0], (uint32_t) triangle.v[1], (uint32_t) triangle.v[2] });
+                        error = std::max (error, triangle.error);
+                    }
+                }
+            }
+
+        private:
+
+            /// <summary>
+            /// A triangle with positive winding. Edge i joins vertex i to the vertex after it.
+            /// </summary>
+            struct Triangle final
+            {
+                int     v[3];           //!< The index of each vertex within the patch.
+                int     n[3];           //!< The triangle across each edge, -1 on the border of the patch.
+                int     candidate;      //!< The vertex inside the triangle furthest from it, -1 if there are none.
+                float   error;          //!< The vertical distance between the candidate and the triangle.
+                bool    alive;          //!< Whether the triangle is part of the triangulation.
+            };
+
+            /// <summary> An edge left by the cavity of an insertion and the triangle beyond it. </summary>
+            struct Edge final
+            {
+                int     a;              //!< The first vertex.
+                int     b;              //!< The second vertex.
+                int     outside;        //!< The triangle beyond the edge, -1 on the border of the patch.
+            };
+
+            int getX (const int vertex) const       { return vertex % m_size; }
+            int getZ (const int vertex) const       { return vertex / m_size; }
+
+            float getHeight (const int x, const int z) const
+            {
+                return m_pyramid.getHeight (m_firstX + (unsigned int) x, m_firstZ + (unsigned int) z);
+            }
+
+            /// <summary> Twice the signed area of a triangle, positive with the winding of the grid templates. </summary>
+            int64_t orient (const int a, const int b, const int c) const
+            {
+                const int64_t abX = getX (b) - getX (a), abZ = getZ (b) - getZ (a),
+                              acX = getX (c) - getX (a), acZ = getZ (c) - getZ (a);
+
+                return abX * acZ - abZ * acX;
+            }
+
+            /// <summary> Tests whether a vertex is strictly inside the circumcircle of a triangle. </summary>
+            bool isInCircle (const Triangle& triangle, const int vertex) const
+            {
+                const int64_t x = getX (vertex), z = getZ (vertex);
+
+                int64_t dx[3], dz[3], lengths[3];
+
+                for (auto i = 0; i < 3; ++i)
+                {
+                    dx[i]      = getX (triangle.v[i]) - x;
+                    dz[i]      = getZ (triangle.v[i]) - z;
+                    lengths[i] = dx[i] * dx[i] + dz[i] * dz[i];
+                }
+
+                return lengths[0] * (dx[1] * dz[2] - dx[2] * dz[1]) +
+                       lengths[1] * (dx[2] * dz[0] - dx[0] * dz[2]) +
+                       lengths[2] * (dx[0] * dz[1] - dx[1] * dz[0]) > 0;
+            }
+
+            int addTriangle (const int a, const int b, const int c)
+            {
+                Triangle triangle { };
+                triangle.v[0]      = a;
+                triangle.v[1]      = b;
+                triangle.v[2]      = c;
+                triangle.n[0]      = -1;
+                triangle.n[1]      = -1;
+                triangle.n[2]      = -1;
+                triangle.candidate = -1;
+                triangle.error     = 0.f;
+                triangle.alive     = true;
+
+                // Replaced triangles are reused so the storage stays in proportion to the triangulation.
+                if (!m_free.empty())
+                {
+                    const auto index = m_free.back();
+                    m_free.pop_back();
+
+                    m_triangles[index] = triangle;
+                    return index;
+                }
+
+                m_triangles.push_back (triangle);
+                return (int) m_triangles.size() - 1;
+            }
+
+            void link (const int triangle, const int edge, const int neighbour)
+            {
+                m_triangles[triangle].n[edge] = neighbour;
+            }
+
+            /// <summary> Walks from the last triangle inserted into towards the triangle containing a vertex. </summary>
+            int locate (const int vertex) const
+            {
+                auto current = m_start;
+
+                while (true)
+                {
+                    const auto& triangle = m_triangles[current];
+                    auto        next     = -1;
+
+                    for (auto edge = 0; edge < 3 && next < 0; ++edge)
+                    {
+                        if (orient (triangle.v[edge], triangle.v[(edge + 1) % 3], vertex) < 0)
+                        {
+                            next = triangle.n[edge];
+                        }
+                    }
+
+                    if (next < 0)
+                    {
+                        return current;
+                    }
+
+                    current = next;
+                }
+            }
+
+            /// <summary> Inserts a vertex by replacing every triangle whose circumcircle contains it (Bowyer-Watson). </summary>
+            void insert (const int vertex)
+            {
+                m_inserted[vertex] = true;
+
+                const auto first = locate (vertex);
+
+                m_cavity.assign (1, first);
+                m_triangles[first].alive = false;
+
+                for (size_t i = 0; i < m_cavity.size(); ++i)
+                {
+                    for (const auto neighbour : m_triangles[m_cavity[i]].n)
+                    {
+                        if (neighbour >= 0 && m_triangles[neighbour].alive && isInCircle (m_triangles[neighbour], vertex))
+                        {
+                            m_triangles[neighbour].alive = false;
+                            m_cavity.push_back (neighbour);
+                        }
+                    }
+                }
+
+                // A vertex on the border of the patch lies on the border edge it splits, which is left out.
+                m_edges.clear();
+
+                for (const auto index : m_cavity)
+                {
+                    const auto& triangle = m_triangles[index];
+
+                    for (auto edge = 0; edge < 3; ++edge)
+                    {
+                        const auto outside = triangle.n[edge];
+
+                        if (outside >= 0 && !m_triangles[outside].alive)
+                        {
+                            continue;
+                        }
+
+                        Edge boundary { };
+                        boundary.a       = triangle.v[edge];
+                        boundary.b       = triangle.v[(edge + 1) % 3];
+                        boundary.outside = outside;
+
+                        if (orient (boundary.a, boundary.b, vertex) != 0)
+                        {
+                            m_edges.push_back (boundary);
+                        }
+                    }
+                }
+
+                m_free.insert (m_free.end(), m_cavity.cbegin(), m_cavity.cend());
+                m_created.clear();
+
+                for (const auto& edge : m_edges)
+                {
+                    const auto triangle = addTriangle (edge.a, edge.b, vertex);
+
+                    link (triangle, 0, edge.outside);
+
+                    if (edge.outside >= 0)
+                    {
+                        auto& outside = m_triangles[edge.outside];
+
+                        for (auto edgeIndex = 0; edgeIndex < 3; ++edgeIndex)
+                        {
+                            if (outside.v[edgeIndex] == edge.b && outside.v[(edgeIndex + 1) % 3] == edge.a)
+                            {
+                                outside.n[edgeIndex] = triangle;
+                            }
+                        }
+                    }
+
+                    m_created.push_back (triangle);
+                }
+
+                // The new triangles form a fan around the vertex, each one meets the triangle beginning where it ends.
+                for (const auto triangle : m_created)
+                {
+                    for (const auto other : m_created)
+                    {
+                        if (m_triangles[other].v[0] == m_triangles[triangle].v[1])
+                        {
+                            link (triangle, 1, other);
+                        }
+
+                        if (m_triangles[other].v[1] == m_triangles[triangle].v[0])
+                        {
+                            link (triangle, 2, other);
+                        }
+                    }
+                }
+
+                m_start = m_created.front();
+
+                if (m_measuring)
+                {
+                    for (const auto triangle : m_created)
+                    {
+                        measure (triangle);
+                    }
+                }
+            }
+
+            /// <summary> Finds the vertex inside a triangle furthest from it and queues the triangle if there is one. </summary>
+            void measure (const int index)
+            {
+                auto& triangle = m_triangles[index];
+
+                const int a = triangle.v[0], b = triangle.v[1], c = triangle.v[2];
+
+                const auto area = (float) orient (a, b, c);
+                const auto ha   = getHeight (getX (a), getZ (a)),
+                           hb   = getHeight (getX (b), getZ (b)),
+                           hc   = getHeight (getX (c), getZ (c));
+
+                const auto minX = std::min ({ getX (a), getX (b), getX (c) }), maxX = std::max ({ getX (a), getX (b), getX (c) }),
+                           minZ = std::min ({ getZ (a), getZ (b), getZ (c) }), maxZ = std::max ({ getZ (a), getZ (b), getZ (c) });
+
+                triangle.candidate = -1;
+                triangle.error     = 0.f;
+
+                for (auto z = minZ; z <= maxZ; ++z)
+                {
+                    for (auto x = minX; x <= maxX; ++x)
+                    {
+                        const auto vertex = x + z * m_size;
+
+                        if (m_inserted[vertex])
+                        {
+                            continue;
+                        }
+
+                        const auto wa = orient (b, c, vertex),
+                                   wb = orient (c, a, vertex),
+                                   wc = orient (a, b, vertex);
+
+                        if (wa < 0 || wb < 0 || wc < 0)
+                        {
+                            continue;
+                        }
+
+                        const auto drawn = (wa * ha + wb * hb + wc * hc) / area,
+                                   error = std::abs (getHeight (x, z) - drawn);
+
+                        if (triangle.candidate < 0 || error > triangle.error)
+                        {
+                            triangle.candidate = vertex;
+                            triangle.error     = error;
+                        }
+                    }
+                }
+
+                if (triangle.candidate >= 0)
+                {
+                    m_queue.emplace (triangle.error, index);
+                }
+            }
+
+
+            using Entry = std::pair<float, int>;
+
+            const HeightPyramid&        m_pyramid;              //!< The heights of every vertex of the terrain.
+            unsigned int                m_firstX;               //!< The X co-ordinate of the first vertex of the patch.
+            unsigned int                m_firstZ;               //!< The Z co-ordinate of the first vertex of the patch.
+            int                         m_size;                 //!< How many vertices wide and deep the patch is.
+            std::vector<bool>           m_inserted;             //!< Whether each vertex of the patch is part of the triangulation.
+            std::vector<Triangle>       m_triangles { };        //!< Every triangle, including replaced ones waiting to be reused.
+            std::vector<int>            m_free      { };        //!< The triangles which may be reused.
+            std::vector<int>            m_cavity    { };        //!< The triangles replaced by the current insertion.
+            std::vector<Edge>           m_edges     { };        //!< The edges around the cavity of the current insertion.
+            std::vector<int>            m_created   { };        //!< The triangles created by the current insertion.
+            std::priority_queue<Entry>  m_queue     { };        //!< Every triangle with a candidate, the furthest first.
+            int                         m_start     { 0 };      //!< The triangle the next search begins from.
+            bool                        m_measuring { false };  //!< Whether new triangles are measured as they're created.
+    };
+}
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+PatchDecimator::PatchDecimator (PatchDecimator&& move)
+{
+    *this = std::move (move);
+}
+
+
+PatchDecimator& PatchDecimator::operator= (PatchDecimator&& move)
+{
+    if (this != &move)
+    {
+        m_patches     = std::move (move.m_patches);
+        m_elements    = std::move (move.m_elements);
+        m_width       = move.m_width;
+        m_depth       = move.m_depth;
+        m_divisor     = move.m_divisor;
+        m_errorBound  = move.m_errorBound;
+        m_heightsHash = move.m_heightsHash;
+        m_statistics  = move.m_statistics;
+
+        // Reset primitives.
+        move.m_width   = 0;
+        move.m_depth   = 0;
+        move.m_divisor = 0;
+    }
+
+    return *this;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void PatchDecimator::build (const HeightPyramid& pyramid, const unsigned int divisor, const float errorBound)
+{
+    assert (divisor >= 2 && errorBound >= 0.f);
+    assert (pyramid.getWidth() % divisor == 0 && pyramid.getDepth() % divisor == 0);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    clear();
+
+    m_width       = pyramid.getWidth();
+    m_depth       = pyramid.getDepth();
+    m_divisor     = divisor;
+    m_errorBound  = errorBound;
+    m_heightsHash = hashHeights (pyramid);
+
+    const auto patchesX = m_width / divisor,
+               patchCount = patchesX * (m_depth / divisor);
+
+    // Patches are independent so each is decimated on its own thread, then joined in row-major order.
+    std::vector<std::vector<uint32_t>> elements (patchCount);
+    std::vector<float>                 errors (patchCount, 0.f);
+
+    util::parallelFor (0, patchCount, [&] (const size_t patch)
+    {
+        Triangulation triangulation { pyramid, (unsigned int) patch % patchesX * divisor, (unsigned int) patch / patchesX * divisor, divisor };
+
+        triangulation.decimate (errorBound, elements[patch], errors[patch]);
+    });
+
+    m_patches.resize (patchCount);
+
+    for (auto patch = 0U; patch < patchCount; ++patch)
+    {
+        m_patches[patch].first = (uint32_t) m_elements.size();
+        m_patches[patch].count = (uint32_t) elements[patch].size();
+
+        m_elements.insert (m_elements.end(), elements[patch].cbegin(), elements[patch].cend());
+    }
+
+    measure();
+
+    m_statistics.error        = *std::max_element (errors.cbegin(), errors.cend());
+    m_statistics.milliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+}
+
+
+bool PatchDecimator::load (const std::string& file, const HeightPyramid& pyramid, const unsigned int divisor, const float errorBound)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::ifstream input { file, std::ios::binary | std::ios::ate };
+
+    const auto fileSize = (uint64_t) std::max ((std::streamoff) input.tellg(), (std::streamoff) 0);
+    input.seekg (0);
+
+    BakeHeader header { };
+
+    if (!input.read ((char*) &header, sizeof (BakeHeader)) || !std::equal (bakeMagic, bakeMagic + 4, header.magic) ||
+        header.version != bakeVersion || header.width != pyramid.getWidth() || header.depth != pyramid.getDepth() ||
+        header.divisor != divisor || header.errorBound != errorBound ||
+        header.patchCount != (pyramid.getWidth() / divisor) * (pyramid.getDepth() / divisor))
+    {
+        return false;
+    }
+
+    // The heights change with the noise and upscaling too, so they're compared last as hashing takes longest.
+    const auto heightsHash = hashHeights (pyramid);
+
+    if (header.heightsHash != heightsHash)
+    {
+        return false;
+    }
+
+    // A truncated or corrupt bake falls back to decimating again, so the element count must match what's left of the
+    // file before anything is allocated for it.
+    const auto tableSize = (uint64_t) header.patchCount * sizeof (Patch);
+
+    if (sizeof (BakeHeader) + tableSize > fileSize || 
+        header.elementCount != (fileSize - sizeof (BakeHeader) - tableSize) / sizeof (uint32_t))
+    {
+        return false;
+    }
+
+    std::vector<Patch>    patches (header.patchCount);
+    std::vector<uint32_t> elements ((size_t) header.elementCount);
+
+    if (!input.read ((char*) patches.data(), patches.size() * sizeof (Patch)) ||
+        !input.read ((char*) elements.data(), elements.size() * sizeof (uint32_t)))
+    {
+        return false;
+    }
+
+    // Every patch must cover whole triangles within the elements, and every element must index its own patch.
+    const auto vertices = (uint32_t) divisor * divisor;
+
+    for (const auto& patch : patches)
+    {
+        if (patch.count % 3 != 0 || patch.first > elements.size() || patch.count > elements.size() - patch.first)
+        {
+            return false;
+        }
+    }
+
+    for (const auto element : elements)
+    {
+        if (element >= vertices)
+        {
+            return false;
+        }
+    }
+
+    m_patches     = std::move (patches);
+    m_elements    = std::move (elements);
+    m_width       = header.width;
+    m_depth       = header.depth;
+    m_divisor     = header.divisor;
+    m_errorBound  = header.errorBound;
+    m_heightsHash = heightsHash;
+
+    measure();
+
+    m_statistics.error        = header.error;
+    m_statistics.loaded       = true;
+    m_statistics.milliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+
+    return true;
+}
+
+
+bool PatchDecimator::save (const std::string& file) const
+{
+    std::ofstream output { file, std::ios::binary };
+
+    if (!output)
+    {
+        return false;
+    }
+
+    BakeHeader header { };
+
+    std::copy (bakeMagic, bakeMagic + 4, header.magic);
+    header.version      = bakeVersion;
+    header.width        = m_width;
+    header.depth        = m_depth;
+    header.divisor      = m_divisor;
+    header.errorBound   = m_errorBound;
+    header.error        = m_statistics.error;
+    header.patchCount   = (uint32_t) m_patches.size();
+    header.heightsHash  = m_heightsHash;
+    header.elementCount = m_elements.size();
+
+    output.write ((const char*) &header, sizeof (BakeHeader));
+    output.write ((const char*) m_patches.data(), (std::streamsize) (m_patches.size() * sizeof (Patch)));
+    output.write ((const char*) m_elements.data(), (std::streamsize) (m_elements.size() * sizeof (uint32_t)));
+
+    return (bool) output;
+}
+
+
+void PatchDecimator::clear()
+{
+    m_patches.clear();
+    m_elements.clear();
+
+    m_width       = 0;
+    m_depth       = 0;
+    m_divisor     = 0;
+    m_errorBound  = 0.f;
+    m_heightsHash = 0;
+    m_statistics  = Statistics { };
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+uint64_t PatchDecimator::hashHeights (const HeightPyramid& pyramid)
+{
+    // FNV-1a over the bits of every height.
+    const auto& heights = pyramid.getHeights();
+    const auto  bytes   = (const uint8_t*) heights.data();
+
+    auto hash = (uint64_t) 14695981039346656037ULL;
+
+    for (size_t i = 0; i < heights.size() * sizeof (float); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+void PatchDecimator::measure()
+{
+    const auto quads = m_divisor - 1;
+
+    m_statistics                 = Statistics { };
+    m_statistics.trianglesBefore = m_patches.size() * quads * quads * 2;
+    m_statistics.trianglesAfter  = m_elements.size() / 3;
+
+    // Vertices are counted within each patch, stitching to the neighbouring patches isn't included on either side.
+    std::vector<bool> used ((size_t) m_divisor * m_divisor);
+
+    for (const auto& patch : m_patches)
+    {
+        std::fill (used.begin(), used.end(), false);
+
+        for (auto i = patch.first; i < patch.first + patch.count; ++i)
+        {
+            if (!used[m_elements[i]])
+            {
+                used[m_elements[i]] = true;
+                ++m_statistics.vertices;
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef PATCH_DECIMATOR_3GP_HPP
+#define PATCH_DECIMATOR_3GP_HPP
+
+
+// STL headers.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Forward declarations.
+class HeightPyramid;
+
+
+/// <summary>
+/// Simplifies the grid of every terrain patch offline into an irregular triangulation (TIN) which stays within a vertical
+/// error bound in world units. Each patch starts as a Delaunay triangulation of every vertex on its border, so the
+/// stitching to its neighbours still joins, then the vertex furthest from the surface drawn is inserted until no vertex is
+/// further than the bound (greedy insertion). Triangles index the vertices of the patch, which are left untouched, with
+/// the same winding as the grid templates. The result can be baked to a file and loaded by later builds of the same heights.
+/// </summary>
+class PatchDecimator final
+{
+    public:
+
+        /// <summary>
+        /// The elements of one patch within the elements of every patch.
+        /// </summary>
+        struct Patch final
+        {
+            uint32_t    first   { 0 };  //!< The index of the first element.
+            uint32_t    count   { 0 };  //!< How many elements there are, three per triangle.
+        };
+
+        /// <summary>
+        /// How much the last build or load simplified the terrain.
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  trianglesBefore { 0 };      //!< How many triangles the grids of every patch contain.
+            size_t  trianglesAfter  { 0 };      //!< How many triangles remain after decimation.
+            size_t  vertices        { 0 };      //!< How many vertices are used by the remaining triangles.
+            float   error           { 0.f };    //!< The largest vertical distance between any vertex and the surface drawn.
+            double  milliseconds    { 0.0 };    //!< How long it took to decimate or load every patch.
+            bool    loaded          { false };  //!< Whether the patches were loaded from a bake file rather than decimated.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        PatchDecimator()                                        = default;
+
+        PatchDecimator (PatchDecimator&& move);
+        PatchDecimator& operator= (PatchDecimator&& move);
+
+        PatchDecimator (const PatchDecimator& copy)             = default;
+        PatchDecimator& operator= (const PatchDecimator& copy)  = default;
+        ~PatchDecimator()                                       = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the vertical error bound every patch was decimated to, in world units. </summary>
+        float getErrorBound() const                         { return m_errorBound; }
+
+        /// <summary> Gets the elements of each patch in row-major order, empty until built or loaded. </summary>
+        const std::vector<Patch>& getPatches() const        { return m_patches; }
+
+        /// <summary> Gets the elements of every patch, each relative to the first vertex of its patch. </summary>
+        const std::vector<uint32_t>& getElements() const    { return m_elements; }
+
+        /// <summary> Gets how much the last build or load simplified the terrain. </summary>
+        const Statistics& getStatistics() const             { return m_statistics; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Decimates every patch of a terrain across every thread. </summary>
+        /// <param name="pyramid"> The heights of every vertex of the terrain, its dimensions must be multiples of the divisor. </param>
+        /// <param name="divisor"> How many vertices wide and deep each patch is. </param>
+        /// <param name="errorBound"> The largest vertical distance in world units allowed between a vertex and the surface drawn. </param>
+        void build (const HeightPyramid& pyramid, const unsigned int divisor, const float errorBound);
+
+        /// <summary> Loads patches baked from the same heights, divisor and error bound. </summary>
+        /// <param name="file"> The location of the bake file. </param>
+        /// <param name="pyramid"> The heights the patches must have been decimated from. </param>
+        /// <param name="divisor"> How many vertices wide and deep each patch must be. </param>
+        /// <param name="errorBound"> The error bound the patches must have been decimated to. </param>
+        /// <returns> Whether the file exists and matches, nothing changes otherwise. </returns>
+        bool load (const std::string& file, const HeightPyramid& pyramid, const unsigned int divisor, const float errorBound);
+
+        /// <summary> Bakes the patches to a file so later builds of the same heights can load them. </summary>
+        /// <param name="file"> Where to write the bake file. </param>
+        /// <returns> Whether the file could be written. </returns>
+        bool save (const std::string& file) const;
+
+        /// <summary> Removes every patch. </summary>
+        void clear();
+
+    private:
+
+        /// <summary> Hashes every height so a bake of different heights is never loaded. </summary>
+        static uint64_t hashHeights (const HeightPyramid& pyramid);
+
+        /// <summary> Measures the elements of every patch once they're built or loaded. </summary>
+        void measure();
+
+
+        std::vector<Patch>      m_patches       { };        //!< The elements of each patch in row-major order.
+        std::vector<uint32_t>   m_elements      { };        //!< The triangles of every patch.
+        unsigned int            m_width         { 0 };      //!< How many vertices wide the terrain is.
+        unsigned int            m_depth         { 0 };      //!< How many vertices deep the terrain is.
+        unsigned int            m_divisor       { 0 };      //!< How many vertices wide and deep each patch is.
+        float                   m_errorBound    { 0.f };    //!< The vertical error bound in world units.
+        uint64_t                m_heightsHash   { 0 };      //!< The hash of the heights the patches were decimated from.
+        Statistics              m_statistics    { };        //!< How much the terrain was simplified.
+};
+
+
+#endif // PATCH_DECIMATOR_3GP_HPP
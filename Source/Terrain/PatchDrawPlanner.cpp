@@ -0,0 +1,26 @@
+#include "PatchDrawPlanner.hpp"
+
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void PatchDrawPlanner::plan (const std::vector<unsigned int>& visible)
+{
+    m_runs.clear();
+
+    for (const auto patch : visible)
+    {
+        // Extend the current run if the patch follows straight on from it.
+        if (!m_runs.empty() && m_runs.back().first + m_runs.back().count == patch)
+        {
+            ++m_runs.back().count;
+        }
+
+        else
+        {
+            m_runs.push_back ({ patch, 1 });
+        }
+    }
+}
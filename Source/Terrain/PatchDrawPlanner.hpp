@@ -0,0 +1,51 @@
+#ifndef PATCH_DRAW_PLANNER_3GP_HPP
+#define PATCH_DRAW_PLANNER_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+/// <summary>
+/// Merges the visible patches of a terrain into runs of patches which are stored consecutively in the vertex buffer.
+/// When the elements of neighbouring patches are also stored consecutively a whole run can be drawn at once, which
+/// turns a draw per patch into a handful of draws for a compact visible set such as a Morton ordered frustum. The
+/// order of the patches is kept, so patches sorted by distance only form runs where consecutive patches are adjacent.
+/// </summary>
+class PatchDrawPlanner final
+{
+    public:
+
+        /// <summary>
+        /// A range of consecutive patches which are all visible.
+        /// </summary>
+        struct Run final
+        {
+            unsigned int    first;  //!< The index of the first patch in the run.
+            unsigned int    count;  //!< How many patches are in the run.
+        };
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the runs found by the last plan, in the same order as the patches. </summary>
+        const std::vector<Run>& getRuns() const { return m_runs; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Finds the runs of consecutive patches in the given set of visible patches. </summary>
+        /// <param name="visible"> The index of every visible patch in the order they should be drawn. </param>
+        void plan (const std::vector<unsigned int>& visible);
+
+    private:
+
+        std::vector<Run>    m_runs  { };    //!< The runs found by the last plan.
+};
+
+
+#endif // PATCH_DRAW_PLANNER_3GP_HPP
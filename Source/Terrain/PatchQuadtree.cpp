@@ -0,0 +1,172 @@
+#include "PatchQuadtree.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+
+
+// Personal headers.
+#include <Terrain/PatchBounds.hpp>
+
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void PatchQuadtree::build (const PatchBounds& bounds, const std::vector<unsigned int>& patchOrder, const unsigned int meshCountX, const unsigned int meshCountZ)
+{
+    assert (patchOrder.size() == meshCountX * meshCountZ && bounds.getCount() == patchOrder.size());
+
+    clear();
+
+    if (patchOrder.empty())
+    {
+        return;
+    }
+
+    m_meshCountX = meshCountX;
+    m_meshCountZ = meshCountZ;
+
+    std::vector<unsigned int> storedIndex (patchOrder.size());
+
+    for (auto patch = 0U; patch < patchOrder.size(); ++patch)
+    {
+        storedIndex[patchOrder[patch]] = patch;
+    }
+
+    // The root is the smallest power of two square which covers the grid, parts of it outside the grid are never added.
+    auto size = 1U;
+
+    while (size < meshCountX || size < meshCountZ)
+    {
+        size *= 2;
+    }
+
+    // Every node has at most four children and one parent, so the tree has less than twice as many nodes as patches.
+    m_nodes.reserve (patchOrder.size() * 2);
+    m_order.reserve (patchOrder.size());
+
+    addNode (bounds, storedIndex, 0, 0, size);
+
+    // Children are visited in Morton order so the tree order matches the stored order of the Morton layout.
+    m_sorted = std::is_sorted (m_order.cbegin(), m_order.cend());
+}
+
+
+void PatchQuadtree::clear()
+{
+    m_nodes.clear();
+    m_order.clear();
+
+    m_meshCountX = 0;
+    m_meshCountZ = 0;
+    m_sorted     = true;
+    m_statistics = Statistics { };
+}
+
+
+void PatchQuadtree::cull (const util::Frustum& frustum, std::vector<unsigned int>& visible)
+{
+    visible.clear();
+    m_statistics = Statistics { };
+
+    if (!m_nodes.empty())
+    {
+        visit (frustum, 0, util::Frustum::allPlanes, visible);
+    }
+
+    // Patches must be drawn in ascending order, the row-major layout only needs the visible patches sorting.
+    if (!m_sorted)
+    {
+        std::sort (visible.begin(), visible.end());
+    }
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+unsigned int PatchQuadtree::addNode (const PatchBounds& bounds, const std::vector<unsigned int>& storedIndex,
+                                     const unsigned int x, const unsigned int z, const unsigned int size)
+{
+    const auto index = (unsigned int) m_nodes.size();
+
+    m_nodes.emplace_back();
+    m_nodes[index].first = (unsigned int) m_order.size();
+
+    if (size == 1)
+    {
+        const auto patch = storedIndex[x + z * m_meshCountX];
+
+        m_order.push_back (patch);
+        m_nodes[index].minimum = bounds.getMinimum (patch);
+        m_nodes[index].maximum = bounds.getMaximum (patch);
+    }
+
+    else
+    {
+        const auto half = size / 2;
+
+        for (auto child = 0U; child < 4; ++child)
+        {
+            const auto childX = x + (child & 1) * half,
+                       childZ = z + (child >> 1) * half;
+
+            if (childX >= m_meshCountX || childZ >= m_meshCountZ)
+            {
+                continue;
+            }
+
+            // Adding children may reallocate the nodes so the parent can't be held by reference.
+            const auto childIndex = addNode (bounds, storedIndex, childX, childZ, half);
+            const auto& added     = m_nodes[childIndex];
+            auto&       node      = m_nodes[index];
+
+            node.minimum = node.childCount == 0 ? added.minimum : glm::min (node.minimum, added.minimum);
+            node.maximum = node.childCount == 0 ? added.maximum : glm::max (node.maximum, added.maximum);
+            node.children[node.childCount++] = childIndex;
+        }
+    }
+
+    m_nodes[index].count = (unsigned int) m_order.size() - m_nodes[index].first;
+
+    return index;
+}
+
+
+void PatchQuadtree::visit (const util::Frustum& frustum, const unsigned int index, unsigned int planes, std::vector<unsigned int>& visible)
+{
+    const auto& node = m_nodes[index];
+
+    ++m_statistics.nodesVisited;
+
+    switch (frustum.classify (node.minimum, node.maximum, planes))
+    {
+        case util::Frustum::Containment::Outside:
+            ++m_statistics.nodesRejected;
+            return;
+
+        case util::Frustum::Containment::Inside:
+            ++m_statistics.nodesAccepted;
+            visible.insert (visible.end(), m_order.cbegin() + node.first, m_order.cbegin() + node.first + node.count);
+            return;
+
+        default:
+            break;
+    }
+
+    // A leaf crossing a plane may still be visible.
+    if (node.childCount == 0)
+    {
+        visible.insert (visible.end(), m_order.cbegin() + node.first, m_order.cbegin() + node.first + node.count);
+        return;
+    }
+
+    for (auto child = 0U; child < node.childCount; ++child)
+    {
+        visit (frustum, node.children[child], planes, visible);
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef PATCH_QUADTREE_3GP_HPP
+#define PATCH_QUADTREE_3GP_HPP
+
+
+// STL headers.
+#include <array>
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Personal headers.
+#include <Utility/Frustum.hpp>
+
+
+// Forward declarations.
+class PatchBounds;
+
+
+/// <summary>
+/// A quadtree over the grid of terrain patches where every node bounds each patch below it. Visibility is found by
+/// walking the tree from the root, a node outside the frustum rejects every patch below it and a node inside accepts
+/// them all without testing them individually. The cost of culling therefore depends on how much of the terrain is on
+/// the edge of the frustum rather than how many patches exist.
+/// </summary>
+class PatchQuadtree final
+{
+    public:
+
+        /// <summary>
+        /// An area of the patch grid. Leaves cover a single patch.
+        /// </summary>
+        struct Node final
+        {
+            glm::vec3                   minimum     { 0.f };    //!< The minimum corner of the box containing every patch below.
+            glm::vec3                   maximum     { 0.f };    //!< The maximum corner of the box containing every patch below.
+            std::array<unsigned int, 4> children    { };        //!< The index of each child node, only the first childCount are used.
+            unsigned int                childCount  { 0 };      //!< How many children the node has, zero for leaves.
+            unsigned int                first       { 0 };      //!< Where the patches below begin in the tree order.
+            unsigned int                count       { 0 };      //!< How many patches are below the node.
+        };
+
+        /// <summary>
+        /// The amount of work done by the last call to cull().
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  nodesVisited    { 0 };  //!< How many nodes were tested against the frustum.
+            size_t  nodesAccepted   { 0 };  //!< How many nodes were inside the frustum, accepting every patch below.
+            size_t  nodesRejected   { 0 };  //!< How many nodes were outside the frustum, rejecting every patch below.
+        };
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets every node, the root is first. </summary>
+        const std::vector<Node>& getNodes() const       { return m_nodes; }
+
+        /// <summary> Gets the amount of work done by the last call to cull(). </summary>
+        const Statistics& getStatistics() const         { return m_statistics; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Builds the tree over a grid of patches. </summary>
+        /// <param name="bounds"> The bounding box of every stored patch. </param>
+        /// <param name="patchOrder"> The row-major tile of each stored patch. </param>
+        /// <param name="meshCountX"> How many patches wide the grid is. </param>
+        /// <param name="meshCountZ"> How many patches deep the grid is. </param>
+        void build (const PatchBounds& bounds, const std::vector<unsigned int>& patchOrder, const unsigned int meshCountX, const unsigned int meshCountZ);
+
+        /// <summary> Removes every node. </summary>
+        void clear();
+
+        /// <summary> Finds every patch which may be inside the frustum. </summary>
+        /// <param name="frustum"> The volume visible to the camera. </param>
+        /// <param name="visible"> Replaced with the index of every visible patch, in ascending order. </param>
+        void cull (const util::Frustum& frustum, std::vector<unsigned int>& visible);
+
+    private:
+
+        /// <summary> Adds the node covering the given square of tiles, which must overlap the grid. </summary>
+        /// <param name="bounds"> The bounding box of every stored patch. </param>
+        /// <param name="storedIndex"> The stored index of each row-major tile. </param>
+        /// <param name="x"> The first tile of the square on the X axis. </param>
+        /// <param name="z"> The first tile of the square on the Z axis. </param>
+        /// <param name="size"> How many tiles wide and deep the square is, always a power of two. </param>
+        /// <returns> The index of the node. </returns>
+        unsigned int addNode (const PatchBounds& bounds, const std::vector<unsigned int>& storedIndex, 
+                              const unsigned int x, const unsigned int z, const unsigned int size);
+
+        /// <summary> Adds the patches of a node and its children which may be visible. </summary>
+        /// <param name="frustum"> The volume visible to the camera. </param>
+        /// <param name="index"> The index of the node to visit. </param>
+        /// <param name="planes"> The planes the parent node crosses, only these need testing. </param>
+        /// <param name="visible"> The visible set to add to. </param>
+        void visit (const util::Frustum& frustum, const unsigned int index, unsigned int planes, std::vector<unsigned int>& visible);
+
+
+        std::vector<Node>           m_nodes         { };        //!< Every node in the tree, the root is first.
+        std::vector<unsigned int>   m_order         { };        //!< The stored index of every patch in the order the tree visits them.
+        unsigned int                m_meshCountX    { 0 };      //!< How many patches wide the grid is.
+        unsigned int                m_meshCountZ    { 0 };      //!< How many patches deep the grid is.
+        bool                        m_sorted        { true };   //!< Whether the tree order is also the stored order, as in the Morton layout.
+        Statistics                  m_statistics    { };        //!< The amount of work done by the last cull.
+};
+
+
+#endif // PATCH_QUADTREE_3GP_HPP
@@ -0,0 +1,254 @@
+#include "PatchSorter.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+
+// Personal headers.
+#include <Terrain/PatchBounds.hpp>
+
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void PatchSorter::sort (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const PatchBounds& bounds,
+                        std::vector<unsigned int>& patches, const bool estimate)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto count = patches.size();
+
+    m_statistics         = Statistics { };
+    m_statistics.patches = count;
+
+    // Consecutive patches are drawn together so they're kept together, the runs are sorted instead of the patches.
+    m_runs.clear();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!m_runs.empty() && patches[i] == patches[i - 1] + 1)
+        {
+            ++m_runs.back().count;
+        }
+
+        else
+        {
+            m_runs.push_back ({ (uint32_t) i, 1 });
+        }
+    }
+
+    const auto runCount = m_runs.size();
+    m_statistics.runs   = runCount;
+
+    // Runs are keyed by the nearest point of their nearest patch, which is zero for any run containing the camera.
+    m_distances.assign (runCount, std::numeric_limits<float>::max());
+
+    auto furthest = 0.f;
+
+    for (size_t run = 0; run < runCount; ++run)
+    {
+        for (auto i = m_runs[run].first; i < m_runs[run].first + m_runs[run].count; ++i)
+        {
+            const auto nearest = glm::clamp (cameraPosition, bounds.getMinimum (patches[i]), bounds.getMaximum (patches[i]));
+
+            m_distances[run] = std::min (m_distances[run], glm::distance (nearest, cameraPosition));
+        }
+
+        furthest = std::max (furthest, m_distances[run]);
+    }
+
+    // Distances are quantised against the furthest run so the keys use their full range whatever the view.
+    const auto maxKey = (float) ((1U << keyBits) - 1),
+               scale  = furthest > 0.f ? maxKey / furthest : 0.f;
+
+    m_keys.resize (runCount);
+
+    for (size_t run = 0; run < runCount; ++run)
+    {
+        m_keys[run] = (uint16_t) std::min (m_distances[run] * scale + 0.5f, maxKey);
+    }
+
+    // Each pass is a counting sort on one byte of the keys, the least significant first. Counting sorts are stable so
+    // the order of each pass is kept by the next and runs with the same key stay in the order they were given.
+    m_runOrder.resize (runCount);
+    m_scratch.resize (runCount);
+    std::iota (m_runOrder.begin(), m_runOrder.end(), 0U);
+
+    for (auto shift = 0U; shift < keyBits; shift += 8)
+    {
+        std::array<uint32_t, 256> offsets { };
+
+        for (const auto run : m_runOrder)
+        {
+            ++offsets[(m_keys[run] >> shift) & 0xFF];
+        }
+
+        auto total = 0U;
+
+        for (auto& offset : offsets)
+        {
+            const auto bucket = offset;
+
+            offset = total;
+            total += bucket;
+        }
+
+        for (const auto run : m_runOrder)
+        {
+            m_scratch[offsets[(m_keys[run] >> shift) & 0xFF]++] = run;
+        }
+
+        m_runOrder.swap (m_scratch);
+    }
+
+    // Every patch of a run is drawn together so they simply follow each other.
+    m_order.clear();
+    m_order.reserve (count);
+
+    for (const auto run : m_runOrder)
+    {
+        for (auto i = m_runs[run].first; i < m_runs[run].first + m_runs[run].count; ++i)
+        {
+            m_order.push_back (i);
+        }
+    }
+
+    if (estimate)
+    {
+        const auto estimateStart = std::chrono::steady_clock::now();
+
+        // The order the patches were given is simply every position in turn.
+        project (projectionView, bounds, patches);
+        m_scratch.resize (count);
+        std::iota (m_scratch.begin(), m_scratch.end(), 0U);
+
+        m_statistics.cellsShadedBefore = countShaded (m_scratch);
+        m_statistics.cellsShadedAfter  = countShaded (m_order);
+        m_statistics.cellsCovered      = (size_t) std::count_if (m_depths.cbegin(), m_depths.cend(), [] (const float depth)
+        {
+            return depth < std::numeric_limits<float>::max();
+        });
+
+        if (m_statistics.cellsCovered > 0)
+        {
+            m_statistics.overdrawBefore = (float) m_statistics.cellsShadedBefore / m_statistics.cellsCovered;
+            m_statistics.overdrawAfter  = (float) m_statistics.cellsShadedAfter / m_statistics.cellsCovered;
+        }
+
+        m_statistics.estimateMilliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - estimateStart).count();
+    }
+
+    m_sorted.resize (count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_sorted[i] = patches[m_order[i]];
+    }
+
+    patches.swap (m_sorted);
+
+    m_statistics.sortMilliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count() -
+                                    m_statistics.estimateMilliseconds;
+}
+
+
+/////////////////////
+// Private methods //
+/////////////////////
+
+void PatchSorter::project (const glm::mat4& projectionView, const PatchBounds& bounds, const std::vector<unsigned int>& patches)
+{
+    const auto cells = glm::vec2 (estimateWidth, estimateHeight);
+
+    m_rectangles.resize (patches.size());
+
+    for (size_t i = 0; i < patches.size(); ++i)
+    {
+        const auto minimum = bounds.getMinimum (patches[i]),
+                   maximum = bounds.getMaximum (patches[i]);
+
+        auto lowest  = glm::vec2 (std::numeric_limits<float>::max()),
+             highest = -lowest;
+
+        auto& rectangle = m_rectangles[i];
+        rectangle.nearest  = std::numeric_limits<float>::max();
+        rectangle.furthest = -std::numeric_limits<float>::max();
+
+        auto crossesNear = false;
+
+        for (auto corner = 0U; corner < 8; ++corner)
+        {
+            const auto position = glm::vec3 (corner & 1 ? maximum.x : minimum.x,
+                                             corner & 2 ? maximum.y : minimum.y,
+                                             corner & 4 ? maximum.z : minimum.z);
+            const auto clip     = projectionView * glm::vec4 (position, 1.f);
+
+            if (clip.z < -clip.w || clip.w <= 0.f)
+            {
+                crossesNear = true;
+                break;
+            }
+
+            const auto screen = (glm::vec2 (clip.x, clip.y) / clip.w * 0.5f + 0.5f) * cells;
+            const auto depth  = clip.z / clip.w;
+
+            lowest             = glm::min (lowest, screen);
+            highest            = glm::max (highest, screen);
+            rectangle.nearest  = std::min (rectangle.nearest, depth);
+            rectangle.furthest = std::max (rectangle.furthest, depth);
+        }
+
+        // Patches around the camera may cover the whole view from the near plane onwards, so they hide nothing.
+        if (crossesNear)
+        {
+            lowest             = glm::vec2 (0.f);
+            highest            = cells;
+            rectangle.nearest  = -1.f;
+            rectangle.furthest = 1.f;
+        }
+
+        rectangle.minX = std::max ((int) std::floor (lowest.x), 0);
+        rectangle.minY = std::max ((int) std::floor (lowest.y), 0);
+        rectangle.maxX = std::min ((int) std::floor (highest.x), (int) estimateWidth - 1);
+        rectangle.maxY = std::min ((int) std::floor (highest.y), (int) estimateHeight - 1);
+    }
+}
+
+
+size_t PatchSorter::countShaded (const std::vector<uint32_t>& order)
+{
+    m_depths.assign ((size_t) estimateWidth * estimateHeight, std::numeric_limits<float>::max());
+
+    size_t shaded { 0 };
+
+    for (const auto position : order)
+    {
+        const auto& rectangle = m_rectangles[position];
+
+        for (auto y = rectangle.minY; y <= rectangle.maxY; ++y)
+        {
+            const auto row = m_depths.data() + y * estimateWidth;
+
+            for (auto x = rectangle.minX; x <= rectangle.maxX; ++x)
+            {
+                // A cell already nearer than the whole patch rejects its fragments before they're shaded.
+                if (row[x] <= rectangle.nearest)
+                {
+                    continue;
+                }
+
+                ++shaded;
+                row[x] = std::min (row[x], rectangle.furthest);
+            }
+        }
+    }
+
+    return shaded;
+}
@@ -0,0 +1,137 @@
+#ifndef PATCH_SORTER_3GP_HPP
+#define PATCH_SORTER_3GP_HPP
+
+
+// STL headers.
+#include <cstdint>
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+// Forward declarations.
+class PatchBounds;
+
+
+/// <summary>
+/// Orders the visible patches of a terrain front to back so the nearest patches fill the depth buffer first and the
+/// fragments of the patches behind them fail the early depth test instead of being shaded. Patches stored one after
+/// another are drawn together by PatchDrawPlanner, so rather than sorting patches one at a time, which would break up
+/// every run, whole runs of consecutive patches are sorted. Each run is keyed by the distance to the nearest point of
+/// its nearest patch, quantised against the furthest run, and sorted with a least significant digit radix sort. The
+/// sort is stable so runs at the same distance keep their order and every frame with the same view draws in the same
+/// order. The overdraw of the order before and after sorting can also be estimated on the CPU from the screen
+/// rectangle of each patch.
+/// </summary>
+class PatchSorter final
+{
+    public:
+
+        /// <summary> How many bits each quantised distance has, sorted one byte at a time. </summary>
+        static const unsigned int keyBits = 16;
+
+        /// <summary> How many cells wide the overdraw estimate splits the view into. </summary>
+        static const unsigned int estimateWidth = 160;
+
+        /// <summary> How many cells tall the overdraw estimate splits the view into. </summary>
+        static const unsigned int estimateHeight = 90;
+
+        /// <summary>
+        /// The work done by the last call to sort(). Overdraw is the number of cells shaded for each cell covered, one
+        /// when nothing is drawn twice, and is only estimated when asked for.
+        /// </summary>
+        struct Statistics final
+        {
+            size_t  patches                 { 0 };      //!< How many patches were sorted.
+            size_t  runs                    { 0 };      //!< How many runs of consecutive patches were sorted.
+            double  sortMilliseconds        { 0.0 };    //!< How long it took to key and sort the patches.
+            size_t  cellsCovered            { 0 };      //!< How many cells are covered by at least one patch.
+            size_t  cellsShadedBefore       { 0 };      //!< How many cells would be shaded in the order the patches were given.
+            size_t  cellsShadedAfter        { 0 };      //!< How many cells would be shaded in the sorted order.
+            float   overdrawBefore          { 0.f };    //!< The overdraw of the order the patches were given.
+            float   overdrawAfter           { 0.f };    //!< The overdraw of the sorted order.
+            double  estimateMilliseconds    { 0.0 };    //!< How long it took to estimate the overdraw of both orders.
+        };
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the work done by the last call to sort(). </summary>
+        const Statistics& getStatistics() const { return m_statistics; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Sorts the runs of a list of patches front to back, optionally estimating the overdraw before and after. </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform, only used for the estimate. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        /// <param name="bounds"> The bounding box of every patch. </param>
+        /// <param name="patches"> 
+        /// The index of every patch to draw in ascending order, replaced with the same patches with each run of consecutive
+        /// patches in front to back order.
+        /// </param>
+        /// <param name="estimate"> Whether to estimate the overdraw of both orders. </param>
+        void sort (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const PatchBounds& bounds,
+                   std::vector<unsigned int>& patches, const bool estimate);
+
+    private:
+
+        /// <summary>
+        /// A run of patches which are stored consecutively, so they're drawn together.
+        /// </summary>
+        struct Run final
+        {
+            uint32_t    first;  //!< The position of the first patch of the run in the order given.
+            uint32_t    count;  //!< How many patches are in the run.
+        };
+
+        /// <summary>
+        /// The cells a patch may cover on the screen and the range of depths of its bounds.
+        /// </summary>
+        struct Rectangle final
+        {
+            int     minX        { 0 };      //!< The first column of cells covered.
+            int     minY        { 0 };      //!< The first row of cells covered.
+            int     maxX        { -1 };     //!< The last column of cells covered, less than the first when off the screen.
+            int     maxY        { -1 };     //!< The last row of cells covered, less than the first when off the screen.
+            float   nearest     { 0.f };    //!< The nearest normalised device depth of the bounds.
+            float   furthest    { 0.f };    //!< The furthest normalised device depth of the bounds.
+        };
+
+        /// <summary> Finds the screen rectangle and depth range of every patch in the order given. </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform. </param>
+        /// <param name="bounds"> The bounding box of every patch. </param>
+        /// <param name="patches"> The patches to project. </param>
+        void project (const glm::mat4& projectionView, const PatchBounds& bounds, const std::vector<unsigned int>& patches);
+
+        /// <summary>
+        /// Counts the cells shaded when the projected patches are drawn in the given order. Each patch shades every cell of
+        /// its rectangle which isn't already nearer than the nearest point of the patch, then fills those cells at its
+        /// furthest depth. Rectangles are larger than the patches within them so the count is rough, but it treats every
+        /// order alike.
+        /// </summary>
+        /// <param name="order"> The position of each projected patch in drawing order. </param>
+        /// <returns> How many cells were shaded. </returns>
+        size_t countShaded (const std::vector<uint32_t>& order);
+
+
+        std::vector<Run>            m_runs          { };    //!< The runs of consecutive patches, in the order given.
+        std::vector<uint16_t>       m_keys          { };    //!< The quantised distance of each run, in the order given.
+        std::vector<uint32_t>       m_runOrder      { };    //!< The index of each run, sorted by key.
+        std::vector<uint32_t>       m_order         { };    //!< The position of each patch in the order given, in sorted order.
+        std::vector<uint32_t>       m_scratch       { };    //!< Holds the order during each pass of the radix sort.
+        std::vector<float>          m_distances     { };    //!< The distance to the nearest point of each run, in the order given.
+        std::vector<unsigned int>   m_sorted        { };    //!< The sorted patches before they're swapped into place.
+        std::vector<Rectangle>      m_rectangles    { };    //!< The projection of each patch, in the order given.
+        std::vector<float>          m_depths        { };    //!< The nearest depth filled in each cell of the estimate.
+        Statistics                  m_statistics    { };    //!< The work done by the last sort.
+};
+
+
+#endif // PATCH_SORTER_3GP_HPP
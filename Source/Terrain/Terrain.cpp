@@ -3,6 +3,8 @@
 
 // STL headers.
 #include <algorithm>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
 
 
@@ -12,14 +14,61 @@
 
 
 // Personal headers.
+#include <Renderer/QuantisedVertex.hpp>
 #include <Renderer/Vertex.hpp>
-#include <Terrain/HeightMap.hpp>
+#include <Terrain/HeightSource.hpp>
 #include <Terrain/TerrainConstructionData.hpp>
-#include <Utility/BezierSurface.hpp>
+#include <Terrain/TerrainControlNetGrid.hpp>
+#include <Terrain/TerrainSeparableUpscaler.hpp>
 #include <Utility/ElementCreation.hpp>
+#include <Utility/Frustum.hpp>
+#include <Utility/Morton.hpp>
 
 
 
+namespace
+{
+    /// <summary> The name of each mesh template in the order of Terrain::MeshTemplate, used when reporting on them. </summary>
+    const char* const templateNames[] = { "Central", "Top row", "Right column", "Top right corner" };
+
+    /// <summary> Quantises every vertex of a patch into the given array, every quantised format provides the same quantise function. </summary>
+    template <typename Quantised>
+    void quantiseVertices (const std::vector<Vertex>& vertices, const glm::vec3& origin, const glm::vec3& inverseExtent, Quantised* const output)
+    {
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            output[i] = Quantised::quantise (vertices[i], origin, inverseExtent);
+        }
+    }
+
+    /// <summary>
+    /// Presents the finished heights of a terrain as a height source with one height per vertex, so the clipmap can read
+    /// them the same way as a height map.
+    /// </summary>
+    class PyramidHeights final : public HeightSource
+    {
+        public:
+
+            PyramidHeights (const HeightPyramid& pyramid, const glm::vec3& worldScale)
+                : m_pyramid (pyramid), m_worldScale (worldScale) { }
+
+            unsigned int getWidth() const override          { return m_pyramid.getWidth(); }
+            unsigned int getHeight() const override         { return m_pyramid.getDepth(); }
+            const glm::vec3& getWorldScale() const override { return m_worldScale; }
+
+            float getElevation (const size_t x, const size_t y) const override
+            {
+                return m_pyramid.getHeight ((unsigned int) x, (unsigned int) y);
+            }
+
+        private:
+
+            const HeightPyramid&    m_pyramid;      //!< The height of every vertex.
+            glm::vec3               m_worldScale;   //!< The dimensions of the terrain in world units.
+    };
+}
+
+
 /////////////////////////////////
 // Constructors and destructor //
 /////////////////////////////////
@@ -40,11 +89,74 @@ Terrain& Terrain::operator= (Terrain&& move)
         m_pool          = std::move (move.m_pool);
         m_patches       = std::move (move.m_patches);
         m_meshTemplates = std::move (move.m_meshTemplates);
+        m_baseTemplate  = std::move (move.m_baseTemplate);
+        m_basePrimitive = move.m_basePrimitive;
+        m_baseIndexType = move.m_baseIndexType;
+        m_restartIndex  = move.m_restartIndex;
+        m_runCounts     = std::move (move.m_runCounts);
+        m_patchOrder    = std::move (move.m_patchOrder);
+        m_visible       = std::move (move.m_visible);
+        m_near          = std::move (move.m_near);
+        m_far           = std::move (move.m_far);
+        m_sorter        = std::move (move.m_sorter);
+        m_planner       = std::move (move.m_planner);
+        m_nearPlanner   = std::move (move.m_nearPlanner);
+        m_decimator     = std::move (move.m_decimator);
+        m_farPatches    = std::move (move.m_farPatches);
+        m_elementData   = std::move (move.m_elementData);
+        m_bounds        = std::move (move.m_bounds);
+        m_quadtree      = std::move (move.m_quadtree);
+        m_horizon       = std::move (move.m_horizon);
+        m_occlusion     = std::move (move.m_occlusion);
+        m_clusters      = std::move (move.m_clusters);
+        m_pyramid       = std::move (move.m_pyramid);
+        m_lod           = std::move (move.m_lod);
+        m_lodGrid       = std::move (move.m_lodGrid);
+        m_heightTexture = move.m_heightTexture;
+        m_nodeUniform   = move.m_nodeUniform;
+        m_morphUniform  = move.m_morphUniform;
+        m_cameraUniform = move.m_cameraUniform;
+        m_clipmap       = std::move (move.m_clipmap);
+        m_clipmapShapes = std::move (move.m_clipmapShapes);
+        m_levelUniform  = move.m_levelUniform;
+        m_texelUniform  = move.m_texelUniform;
+        m_spacing       = move.m_spacing;
+        m_patchDivisor  = move.m_patchDivisor;
+        m_builtFormat   = move.m_builtFormat;
+        m_builtLayout   = move.m_builtLayout;
+        m_builtClusters = move.m_builtClusters;
+        m_builtMode     = move.m_builtMode;
+        m_cacheReport   = std::move (move.m_cacheReport);
         
         m_divisor       = move.m_divisor;
+        m_upscaleMode   = move.m_upscaleMode;
+        m_vertexFormat  = move.m_vertexFormat;
+        m_elementMode   = move.m_elementMode;
+        m_patchLayout   = move.m_patchLayout;
+        m_optimiseCache = move.m_optimiseCache;
+        m_clusterSize   = move.m_clusterSize;
+        m_cullHorizon   = move.m_cullHorizon;
+        m_cullOcclusion = move.m_cullOcclusion;
+        m_sortPatches   = move.m_sortPatches;
+        m_sortEstimate  = move.m_sortEstimate;
+        m_renderMode    = move.m_renderMode;
+        m_lodPixelError = move.m_lodPixelError;
+        m_decimateError = move.m_decimateError;
+        m_bakeFile      = std::move (move.m_bakeFile);
 
         // Reset primitives.
-        move.m_divisor = 0;
+        move.m_divisor       = 0;
+        move.m_patchDivisor  = 0;
+        move.m_basePrimitive = 0;
+        move.m_baseIndexType = 0;
+        move.m_restartIndex  = 0;
+        move.m_builtClusters = 0;
+        move.m_heightTexture = 0;
+        move.m_nodeUniform   = -1;
+        move.m_morphUniform  = -1;
+        move.m_cameraUniform = -1;
+        move.m_levelUniform  = -1;
+        move.m_texelUniform  = -1;
     }
 
     return *this;
@@ -67,183 +179,1199 @@ void Terrain::setDivisor (const unsigned int divisor)
     // Don't allow silly values.
     assert (divisor > 1);
 
-    m_divisor = divisor;
+    m_divisor = divisor;
+}
+
+
+void Terrain::setClusterSize (const unsigned int size)
+{
+    // Every cluster must begin with the same diagonal as the patch grid.
+    assert (size % 2 == 0);
+
+    m_clusterSize = size;
+}
+
+
+void Terrain::setLodPixelError (const float pixels)
+{
+    // A bound of zero would require infinite ranges.
+    assert (pixels > 0.f);
+
+    m_lodPixelError = pixels;
+}
+
+
+void Terrain::setDecimationError (const float error)
+{
+    // A negative bound can never be met.
+    assert (error >= 0.f);
+
+    m_decimateError = error;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void Terrain::buildFromHeightMap (const HeightSource& heightMap, const NoiseArgs& normal, const NoiseArgs& height, 
+                                  const unsigned int upscaledWidth, const unsigned int upscaledDepth)
+{
+    // Ensure we have a clean set of data to work with.
+    cleanUp();
+    m_pool.generate();
+
+    // Determine the dimensions of the terrain.
+    const auto width   = upscaledWidth == 0 ? heightMap.getWidth()  : upscaledWidth,
+               depth   = upscaledDepth == 0 ? heightMap.getHeight() : upscaledDepth,
+               divisor = determineDivisor (width, depth);
+
+    assert (width % divisor == 0 && depth % divisor == 0);
+
+    // Create the construction data so we can build the terrain.
+    const ConstructionData data { width, depth, divisor, heightMap.getWorldScale().x, heightMap.getWorldScale().z };
+
+    // Vertices are evenly spaced across the world, the final vertex stops one step short of the world scale. The
+    // construction data only stores the magnitude so use the world scale directly, Z usually decreases.
+    m_spacing = { heightMap.getWorldScale().x / width, heightMap.getWorldScale().z / depth };
+
+    // The divisor and format may be changed before the next build so remember which ones the terrain was created with.
+    m_patchDivisor  = divisor;
+    m_builtFormat   = m_vertexFormat;
+    m_builtLayout   = m_patchLayout;
+    m_builtClusters = m_clusterSize;
+    m_builtMode     = m_renderMode;
+
+    // CDLOD nodes and clipmap levels draw a small grid of full precision vertices instead of the patches, so there are
+    // no clusters.
+    if (m_builtMode != RenderMode::Patches)
+    {
+        m_builtFormat   = VertexFormat::Float;
+        m_builtClusters = 0;
+    }
+
+    // Ensure the GPU has enough memory to process the terrain.
+    allocateGPUMemory (data);
+
+    // We need the elements data to be correct first, which depends on where each patch is stored. The CDLOD and
+    // clipmap modes only keep the heights of the patches so they have no elements at all.
+    determinePatchOrder (data);
+
+    if (m_builtMode == RenderMode::Patches)
+    {
+        generateElements (data);
+    }
+
+    // Generate the terrain!
+    generateVertices (heightMap, data, normal, height);
+
+    // Decimation needs the finished heights so the elements are only uploaded once the decimated patches are added.
+    if (m_decimateError > 0.f && m_builtMode == RenderMode::Patches)
+    {
+        decimatePatches();
+    }
+
+    if (m_builtMode == RenderMode::Patches)
+    {
+        m_pool.fillData (BufferType::Elements, m_elementData.size(), m_elementData.data());
+    }
+
+    m_elementData.clear();
+    m_elementData.shrink_to_fit();
+
+    if (m_builtMode == RenderMode::CDLOD)
+    {
+        createLodGrid();
+    }
+
+    else if (m_builtMode == RenderMode::Clipmap)
+    {
+        createClipmapGrid();
+    }
+
+    // Every patch is drawn.
+    m_visible.resize (m_patches.size());
+    std::iota (m_visible.begin(), m_visible.end(), 0U);
+
+    if (!m_farPatches.empty())
+    {
+        m_near = m_visible;
+    }
+
+    // We don't need the element data anymore.
+    m_elements.clear();
+    m_elements.shrink_to_fit();
+}
+
+
+HeightQuery Terrain::getHeightQuery() const
+{
+    // An unbuilt terrain has nothing to query.
+    return m_pyramid.getWidth() > 1 ? HeightQuery { m_pyramid, m_spacing.x, m_spacing.y } : HeightQuery { };
+}
+
+
+HeightRaycaster Terrain::getRaycaster() const
+{
+    return m_pyramid.getWidth() > 1 ? HeightRaycaster { m_pyramid, m_spacing.x, m_spacing.y, m_patchDivisor } : HeightRaycaster { };
+}
+
+
+void Terrain::cleanUp()
+{
+    // Put that memory away!
+    m_pool.clear();
+    m_patches.clear();
+    m_patchOrder.clear();
+    m_visible.clear();
+    m_near.clear();
+    m_far.clear();
+    m_decimator.clear();
+    m_farPatches.clear();
+    m_elementData.clear();
+    m_runCounts.clear();
+    m_cacheReport.clear();
+    m_bounds.clear();
+    m_quadtree.clear();
+    m_horizon.clear();
+    m_occlusion.clear();
+    m_clusters.clear();
+    m_pyramid.clear();
+    m_lod.clear();
+    m_lodGrid = { };
+    m_clipmap.clear();
+    m_clipmapShapes = { };
+
+    if (m_heightTexture != 0)
+    {
+        glDeleteTextures (1, &m_heightTexture);
+        m_heightTexture = 0;
+    }
+}
+
+
+void Terrain::prepareForRender (const GLuint program)
+{
+    // Pass on our best regards to the MeshPool.
+    m_pool.initialiseVAO (program, m_builtFormat);
+
+    // Quantised vertices find the bounds of their patch using their index, every patch has the same number of vertices.
+    // Height only vertices also need the size of the patches to rebuild their X and Z co-ordinates.
+    const auto shaderFormat = m_builtFormat == VertexFormat::Float      ? 0 :
+                              m_builtFormat == VertexFormat::HeightOnly ? 2 : 1;
+
+    glUseProgram (program);
+    glUniform1i (glGetUniformLocation (program, "vertex_format"), shaderFormat);
+    glUniform1i (glGetUniformLocation (program, "vertices_per_patch"), (GLint) (m_patchDivisor * m_patchDivisor));
+    glUniform1i (glGetUniformLocation (program, "patch_divisor"), (GLint) m_patchDivisor);
+    glUniform2f (glGetUniformLocation (program, "vertex_spacing"), m_spacing.x, m_spacing.y);
+    glUniform1i (glGetUniformLocation (program, "patch_transforms"), patchTextureUnit);
+
+    // CDLOD nodes find their heights in a texture with one texel per vertex, the node being drawn is set per draw.
+    // Clipmap levels find their heights in a texture buffer instead, the level being drawn is also set per draw.
+    const auto renderMode = m_builtMode == RenderMode::CDLOD   ? 1 :
+                            m_builtMode == RenderMode::Clipmap ? 2 : 0;
+
+    glUniform1i (glGetUniformLocation (program, "render_mode"), renderMode);
+    glUniform1i (glGetUniformLocation (program, "height_map"), heightTextureUnit);
+    glUniform2f (glGetUniformLocation (program, "height_map_size"), (float) m_pyramid.getWidth(), (float) m_pyramid.getDepth());
+    glUniform1i (glGetUniformLocation (program, "clipmap_heights"), clipmapTextureUnit);
+    glUniform1i (glGetUniformLocation (program, "clipmap_size"), (GLint) m_clipmap.getSize());
+    glUseProgram (0);
+
+    m_nodeUniform   = glGetUniformLocation (program, "node_transform");
+    m_morphUniform  = glGetUniformLocation (program, "morph_range");
+    m_cameraUniform = glGetUniformLocation (program, "camera_position");
+    m_levelUniform  = glGetUniformLocation (program, "level_transform");
+    m_texelUniform  = glGetUniformLocation (program, "level_storage");
+}
+
+
+void Terrain::cull (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const float viewportHeight)
+{
+    // The CDLOD and clipmap modes select their own geometry so the patches are neither built nor culled. Shapes are
+    // still tested against the occlusion buffer, so the occluders are rasterised on their own.
+    if (m_builtMode != RenderMode::Patches)
+    {
+        if (m_cullOcclusion)
+        {
+            m_occlusion.rasterise (projectionView, cameraPosition);
+        }
+
+        if (m_builtMode == RenderMode::CDLOD)
+        {
+            m_lod.select (projectionView, cameraPosition, viewportHeight, m_lodPixelError);
+        }
+
+        else
+        {
+            updateClipmap (cameraPosition);
+        }
+
+        return;
+    }
+
+    const util::Frustum frustum { projectionView };
+
+    m_quadtree.cull (frustum, m_visible);
+
+    if (m_cullHorizon)
+    {
+        m_horizon.cull (cameraPosition, m_bounds, m_visible);
+    }
+
+    if (m_cullOcclusion)
+    {
+        m_occlusion.cull (projectionView, cameraPosition, m_bounds, m_visible);
+    }
+
+    // Sorting comes after every culling stage so only the patches which are drawn are sorted. Everything drawn from the
+    // visible patches follows their order, including the clusters and decimated patches.
+    if (m_sortPatches)
+    {
+        m_sorter.sort (projectionView, cameraPosition, m_bounds, m_visible, m_sortEstimate);
+    }
+
+    // Clusters only cover the base grid so decimated patches don't need them.
+    if (!m_farPatches.empty())
+    {
+        separateFarPatches (projectionView, cameraPosition, viewportHeight);
+    }
+
+    if (m_builtClusters > 0)
+    {
+        m_clusters.cull (frustum, cameraPosition, m_farPatches.empty() ? m_visible : m_near);
+    }
+}
+
+
+void Terrain::draw()
+{
+    glBindVertexArray (m_pool.getVAO());
+
+    if (m_builtMode == RenderMode::CDLOD)
+    {
+        drawNodes();
+        glBindVertexArray (0);
+        return;
+    }
+
+    if (m_builtMode == RenderMode::Clipmap)
+    {
+        drawLevels();
+        glBindVertexArray (0);
+        return;
+    }
+
+    // Texture bindings aren't stored in the VAO.
+    glActiveTexture (GL_TEXTURE0 + patchTextureUnit);
+    glBindTexture (GL_TEXTURE_BUFFER, m_pool.getPatchTexture());
+
+    // Every visible patch is stitched but decimated patches replace their base grid, so only the patches drawn at full
+    // resolution are planned separately.
+    m_planner.plan (m_visible);
+
+    if (!m_farPatches.empty())
+    {
+        m_nearPlanner.plan (m_near);
+    }
+
+    // The restart index may also be a valid stitching index so restart is only enabled whilst the grids are drawn.
+    if (m_restartIndex != 0)
+    {
+        glEnable (GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex (m_restartIndex);
+    }
+
+    if (m_builtClusters > 0)
+    {
+        drawClusters();
+    }
+
+    else
+    {
+        drawGrids (m_farPatches.empty() ? m_planner : m_nearPlanner);
+    }
+
+    // Decimated patches index up to the last vertex of their patch, which may match the restart index.
+    if (m_restartIndex != 0)
+    {
+        glDisable (GL_PRIMITIVE_RESTART);
+    }
+
+    drawFarPatches();
+
+    drawStitching();
+
+    glBindTexture (GL_TEXTURE_BUFFER, 0);
+    glBindVertexArray (0);
+}
+
+
+size_t Terrain::countPatchDraws() const
+{
+    if (m_builtMode != RenderMode::Patches)
+    {
+        return 0;
+    }
+
+    // This follows draw() without touching the GPU, so the runs are planned the same way.
+    PatchDrawPlanner planner { }, nearPlanner { };
+    planner.plan (m_visible);
+    nearPlanner.plan (m_near);
+
+    size_t draws { 0 };
+
+    if (m_builtClusters > 0)
+    {
+        draws += m_clusters.getDrawCounts().empty() ? 0 : 1;
+    }
+
+    else if (m_baseTemplate.elementCount > 0)
+    {
+        const auto maxPatches = (unsigned int) m_runCounts.size();
+
+        for (const auto& run : (m_farPatches.empty() ? planner : nearPlanner).getRuns())
+        {
+            draws += (run.count + maxPatches - 1) / maxPatches;
+        }
+    }
+
+    if (!m_farPatches.empty())
+    {
+        draws += m_far.size();
+    }
+
+    for (const auto& run : planner.getRuns())
+    {
+        if (m_builtLayout == PatchLayout::Morton)
+        {
+            const auto& first = m_patches[run.first];
+            const auto& last  = m_patches[run.first + run.count - 1];
+
+            draws += ((last.elementsOffset - first.elementsOffset) / sizeof (GLuint) + last.elementCount) > 0 ? 1 : 0;
+            continue;
+        }
+
+        for (auto patch = run.first; patch < run.first + run.count; ++patch)
+        {
+            draws += m_patches[patch].elementCount > 0 ? 1 : 0;
+        }
+    }
+
+    return draws;
+}
+
+
+void Terrain::drawGrids (const PatchDrawPlanner& planner) const
+{
+    // Without a base template the grid of each patch is part of its stitching template.
+    if (m_baseTemplate.elementCount == 0)
+    {
+        return;
+    }
+
+    // The base template covers a fixed number of patches so longer runs are split up.
+    const auto maxPatches = (unsigned int) m_runCounts.size();
+
+    for (const auto& run : planner.getRuns())
+    {
+        const auto end = run.first + run.count;
+
+        for (auto patch = run.first; patch < end; patch += maxPatches)
+        {
+            const auto count = std::min (maxPatches, end - patch);
+
+            glDrawElementsBaseVertex (m_basePrimitive, m_runCounts[count - 1], m_baseIndexType, 
+                                      (GLuint*) m_baseTemplate.elementsOffset, m_patches[patch].firstVertex);
+        }
+    }
+}
+
+
+void Terrain::drawClusters() const
+{
+    const auto& counts = m_clusters.getDrawCounts();
+
+    if (!counts.empty())
+    {
+        glMultiDrawElementsBaseVertex (GL_TRIANGLES, counts.data(), m_clusters.getIndexType(), m_clusters.getDrawOffsets().data(), 
+                                       (GLsizei) counts.size(), m_clusters.getDrawBaseVertices().data());
+    }
+}
+
+
+void Terrain::drawStitching() const
+{
+    for (const auto& run : m_planner.getRuns())
+    {
+        // Stitching in the Morton layout uses absolute indices and is stored in patch order, so a run is one range.
+        if (m_builtLayout == PatchLayout::Morton)
+        {
+            const auto& first = m_patches[run.first];
+            const auto& last  = m_patches[run.first + run.count - 1];
+            const auto  count = (last.elementsOffset - first.elementsOffset) / sizeof (GLuint) + last.elementCount;
+
+            if (count > 0)
+            {
+                glDrawElements (GL_TRIANGLES, count, GL_UNSIGNED_INT, (GLuint*) first.elementsOffset);
+            }
+
+            continue;
+        }
+
+        // Row-major templates are relative to their patch so each patch needs its own draw.
+        for (auto patch = run.first; patch < run.first + run.count; ++patch)
+        {
+            const auto& mesh = m_patches[patch];
+
+            if (mesh.elementCount > 0)
+            {
+                glDrawElementsBaseVertex (GL_TRIANGLES, mesh.elementCount, GL_UNSIGNED_INT, (GLuint*) mesh.elementsOffset, mesh.firstVertex);
+            }
+        }
+    }
+}
+
+
+void Terrain::drawFarPatches() const
+{
+    // Each patch has its own triangulation so every patch needs its own draw.
+    for (const auto patch : m_far)
+    {
+        const auto& mesh = m_farPatches[patch];
+
+        glDrawElementsBaseVertex (GL_TRIANGLES, mesh.elementCount, GL_UNSIGNED_INT, (GLuint*) mesh.elementsOffset, mesh.firstVertex);
+    }
+}
+
+
+void Terrain::drawNodes() const
+{
+    glActiveTexture (GL_TEXTURE0 + heightTextureUnit);
+    glBindTexture (GL_TEXTURE_2D, m_heightTexture);
+
+    const auto& camera = m_lod.getCameraPosition();
+    glUniform3f (m_cameraUniform, camera.x, camera.y, camera.z);
+
+    // Every quarter of the grid is a quarter of the elements, so neighbouring quarters can be drawn together.
+    const auto quarterCount = m_lodGrid.elementCount / 4;
+
+    for (const auto& node : m_lod.getSelection())
+    {
+        const auto morph = m_lod.getMorphRange (node.level);
+
+        glUniform3f (m_nodeUniform, (float) node.x, (float) node.z, (float) (1U << node.level));
+        glUniform2f (m_morphUniform, morph.x, morph.y);
+
+        for (auto quarter = 0U; quarter < 4; ++quarter)
+        {
+            if ((node.quadrants & (1U << quarter)) == 0)
+            {
+                continue;
+            }
+
+            auto last = quarter;
+
+            while (last + 1 < 4 && (node.quadrants & (1U << (last + 1))) != 0)
+            {
+                ++last;
+            }
+
+            glDrawElements (GL_TRIANGLES, quarterCount * (last - quarter + 1), GL_UNSIGNED_SHORT, 
+                            (GLushort*) (m_lodGrid.elementsOffset + quarter * quarterCount * sizeof (GLushort)));
+
+            quarter = last;
+        }
+    }
+
+    glBindTexture (GL_TEXTURE_2D, 0);
+}
+
+
+void Terrain::drawLevels() const
+{
+    glActiveTexture (GL_TEXTURE0 + clipmapTextureUnit);
+    glBindTexture (GL_TEXTURE_BUFFER, m_pool.getHeightsTexture());
+
+    // Levels are placed by their first point and fetch their heights from wherever that point is stored. The coarsest
+    // level has nothing beyond it to morph into.
+    const auto& levels     = m_clipmap.getLevels();
+    const auto  levelCount = (unsigned int) levels.size();
+
+    for (auto index = 0U; index < levelCount; ++index)
+    {
+        const auto& level = levels[index];
+        const auto& shape = m_clipmapShapes[level.shape];
+        const auto  scale = 1 << index;
+        const auto  texel = m_clipmap.getIndex (index, 0, 0),
+                    wrapX = m_clipmap.getIndex (index, level.x, 0) - texel,
+                    wrapZ = (m_clipmap.getIndex (index, 0, level.z) - texel) / m_clipmap.getSize();
+
+        glUniform4f (m_levelUniform, (float) (level.x * scale), (float) (level.z * scale), (float) scale, 
+                     index + 1 < levelCount ? m_clipmap.getMorphWidth() : 0.f);
+        glUniform3i (m_texelUniform, (GLint) wrapX, (GLint) wrapZ, (GLint) texel);
+
+        glDrawElements (GL_TRIANGLES, shape.elementCount, GL_UNSIGNED_SHORT, (GLushort*) shape.elementsOffset);
+    }
+
+    glBindTexture (GL_TEXTURE_BUFFER, 0);
+}
+
+
+//////////////
+// Creation //
+//////////////
+
+unsigned int Terrain::determineDivisor (const unsigned int width, const unsigned int depth) const
+{
+    // If the width or depth exceeds the divisor we must use that value.
+    if (m_divisor > width && width <= depth)
+    {
+        return width;
+    }
+
+    if (m_divisor > depth && depth < width)
+    {
+        return depth;
+    }
+
+    return m_divisor;
+}
+
+
+void Terrain::determinePatchOrder (const ConstructionData& data)
+{
+    const auto meshCountX = data.getMeshCountX();
+
+    m_patchOrder.resize (data.getMeshTotal());
+    std::iota (m_patchOrder.begin(), m_patchOrder.end(), 0U);
+
+    // Terrains rarely have a power of two number of patches on each axis, sorting by Morton index skips the gaps.
+    if (m_builtLayout == PatchLayout::Morton)
+    {
+        std::sort (m_patchOrder.begin(), m_patchOrder.end(), [=] (const unsigned int lhs, const unsigned int rhs)
+        {
+            return util::mortonEncode (lhs % meshCountX, lhs / meshCountX) < util::mortonEncode (rhs % meshCountX, rhs / meshCountX);
+        });
+    }
+}
+
+
+void Terrain::allocateGPUMemory (const ConstructionData& data)
+{
+    // CDLOD nodes and clipmap levels replace the vertices of the patches with their own grid once the terrain is finished.
+    if (m_builtMode != RenderMode::Patches)
+    {
+        return;
+    }
+
+    // Elements are allocated when they're generated because their size depends on the element mode.
+    const auto verticesSize = data.getVertexCount() * MeshPool::getVertexSize (m_builtFormat);
+
+    m_pool.fillData (BufferType::Vertices, verticesSize, nullptr);
+}
+
+
+void Terrain::createLodGrid()
+{
+    m_lod.build (m_pyramid, m_spacing);
+
+    // The grid is placed by the vertex shader so its vertices only hold their position within the grid. Each quarter
+    // is stored separately so nodes can draw any combination of them, every quad uses the same diagonal so the grid
+    // of one level morphs exactly into the grid of the next.
+    const auto size = m_lod.getGridSize(),
+               row  = size + 1,
+               half = size / 2;
+
+    std::vector<Vertex> vertices { };
+    vertices.reserve (row * row);
+
+    for (auto z = 0U; z < row; ++z)
+    {
+        for (auto x = 0U; x < row; ++x)
+        {
+            vertices.emplace_back (glm::vec3 ((float) x, 0.f, (float) z), glm::vec3 (0.f, 1.f, 0.f));
+        }
+    }
+
+    std::vector<unsigned int> elements { };
+    elements.reserve (size * size * 6);
+
+    for (auto quarter = 0U; quarter < 4; ++quarter)
+    {
+        const auto firstX = (quarter & 1) * half,
+                   firstZ = (quarter >> 1) * half;
+
+        for (auto z = firstZ; z < firstZ + half; ++z)
+        {
+            for (auto x = firstX; x < firstX + half; ++x)
+            {
+                util::lowerTriangle (elements, x + z * row, 1, row, false);
+                util::upperTriangle (elements, x + z * row, 1, row, false);
+            }
+        }
+    }
+
+    const std::vector<GLushort> shortElements (elements.cbegin(), elements.cend());
+
+    m_pool.fillData (BufferType::Vertices, vertices.size() * sizeof (Vertex), vertices.data());
+    m_pool.fillData (BufferType::Elements, shortElements.size() * sizeof (GLushort), shortElements.data());
+    m_lodGrid = { 0, 0, (GLuint) shortElements.size() };
+
+    // Heights are filtered linearly so morphing vertices slide smoothly between the vertices of the terrain.
+    GLint maxSize { 0 };
+    glGetIntegerv (GL_MAX_TEXTURE_SIZE, &maxSize);
+
+    if (m_pyramid.getWidth() > (unsigned int) maxSize || m_pyramid.getDepth() > (unsigned int) maxSize)
+    {
+        throw std::runtime_error ("Terrain::createLodGrid(), the terrain is too large for a height texture.");
+    }
+
+    glGenTextures (1, &m_heightTexture);
+    glBindTexture (GL_TEXTURE_2D, m_heightTexture);
+    glTexImage2D (GL_TEXTURE_2D, 0, GL_R32F, (GLsizei) m_pyramid.getWidth(), (GLsizei) m_pyramid.getDepth(), 0, 
+                  GL_RED, GL_FLOAT, m_pyramid.getHeights().data());
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture (GL_TEXTURE_2D, 0);
+}
+
+
+void Terrain::createClipmapGrid()
+{
+    const auto levels = m_clipmap.getLevelsToCover (m_pyramid.getWidth(), m_pyramid.getDepth());
+
+    m_clipmap.build (std::min (levels, maxClipmapLevels));
+
+    // Every level draws the same points, placed by the vertex shader. Each template is stored one after the other and
+    // the points of a level fit within 16-bit indices.
+    const auto size = m_clipmap.getSize();
+
+    std::vector<Vertex> vertices { };
+    vertices.reserve (size * size);
+
+    for (auto z = 0U; z < size; ++z)
+    {
+        for (auto x = 0U; x < size; ++x)
+        {
+            vertices.emplace_back (glm::vec3 ((float) x, 0.f, (float) z), glm::vec3 (0.f, 1.f, 0.f));
+        }
+    }
+
+    std::vector<unsigned int> elements { };
+
+    for (auto shape = 0U; shape < GeometryClipmap::templateCount; ++shape)
+    {
+        const auto offset = elements.size();
+
+        m_clipmap.addElements (elements, shape);
+        m_clipmapShapes[shape] = { 0, (GLuint) (offset * sizeof (GLushort)), (GLuint) (elements.size() - offset) };
+    }
+
+    const std::vector<GLushort> shortElements (elements.cbegin(), elements.cend());
+
+    m_pool.fillData (BufferType::Vertices, vertices.size() * sizeof (Vertex), vertices.data());
+    m_pool.fillData (BufferType::Elements, shortElements.size() * sizeof (GLushort), shortElements.data());
+    m_pool.fillData (BufferType::Heights, m_clipmap.getHeights().size() * sizeof (float), nullptr);
+}
+
+
+void Terrain::updateClipmap (const glm::vec3& cameraPosition)
+{
+    const auto width      = m_pyramid.getWidth(),
+               depth      = m_pyramid.getDepth();
+    const auto worldScale = glm::vec3 (width * m_spacing.x, m_pyramid.getRange (0, 0, width - 1, depth - 1).max, depth * m_spacing.y);
+
+    m_clipmap.update (glm::vec2 (cameraPosition.x / m_spacing.x, cameraPosition.z / m_spacing.y), PyramidHeights { m_pyramid, worldScale });
+
+    // Only the rows and columns which entered a level are uploaded, usually a thin strip of a few levels.
+    const auto& heights = m_clipmap.getHeights();
+
+    for (const auto& section : m_clipmap.getSections())
+    {
+        m_pool.fillSection (BufferType::Heights, (GLint) (section.offset * sizeof (float)), section.count * sizeof (float), 
+                            &heights[section.offset]);
+    }
+}
+
+
+void Terrain::decimatePatches()
+{
+    // A bake of the same heights skips decimation entirely, otherwise the new patches replace it for the next build.
+    if (m_bakeFile.empty() || !m_decimator.load (m_bakeFile, m_pyramid, m_patchDivisor, m_decimateError))
+    {
+        m_decimator.build (m_pyramid, m_patchDivisor, m_decimateError);
+
+        if (!m_bakeFile.empty())
+        {
+            m_decimator.save (m_bakeFile);
+        }
+    }
+
+    // Decimated triangles index the vertices of their own patch, which is wherever the patch is stored.
+    const auto& elements = m_decimator.getElements();
+    const auto& patches  = m_decimator.getPatches();
+    const auto  bytes    = reinterpret_cast<const uint8_t*> (elements.data());
+
+    m_elementData.resize ((m_elementData.size() + 3) / 4 * 4);
+
+    const auto offset = (GLuint) m_elementData.size();
+    m_elementData.insert (m_elementData.end(), bytes, bytes + elements.size() * sizeof (uint32_t));
+
+    m_farPatches.reserve (m_patches.size());
+
+    for (auto patch = 0U; patch < m_patches.size(); ++patch)
+    {
+        const auto& decimated = patches[m_patchOrder[patch]];
+
+        m_farPatches.emplace_back (m_patches[patch].firstVertex, offset + decimated.first * (GLuint) sizeof (uint32_t), decimated.count);
+    }
+}
+
+
+void Terrain::separateFarPatches (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const float viewportHeight)
+{
+    // The decimation error is held to the same pixel error as CDLOD nodes, see LodQuadtree::select(). An error covers
+    // fewer pixels the further away it is, so each patch is judged by the nearest point of its bounds.
+    const auto projectionScale = glm::length (glm::vec3 (projectionView[0][1], projectionView[1][1], projectionView[2][1])),
+               farDistance     = m_decimator.getStatistics().error * projectionScale * viewportHeight * 0.5f / m_lodPixelError;
+
+    m_near.clear();
+    m_far.clear();
+
+    for (const auto patch : m_visible)
+    {
+        const auto nearest = glm::clamp (cameraPosition, m_bounds.getMinimum (patch), m_bounds.getMaximum (patch));
+
+        if (glm::distance (nearest, cameraPosition) >= farDistance)
+        {
+            m_far.push_back (patch);
+        }
+
+        else
+        {
+            m_near.push_back (patch);
+        }
+    }
+}
+
+
+//////////////////////
+// Element creation //
+//////////////////////
+
+void Terrain::generateElements (const ConstructionData& data)
+{
+    // Lets speed this process up by reserving enough capacity.
+    m_elements.reserve (data.getMeshVertices() * 3);
+
+    // Every template is collected before uploading so exactly the right amount of memory is allocated.
+    auto& buffer = m_elementData;
+    buffer.clear();
+    m_cacheReport.clear();
+
+    const auto append = [&] (const void* const elements, const size_t size)
+    {
+        // Offsets must be aligned to the size of an index, four bytes suits both index types.
+        buffer.resize ((buffer.size() + 3) / 4 * 4);
+
+        const auto offset = (GLuint) buffer.size();
+        const auto bytes  = static_cast<const uint8_t*> (elements);
+
+        buffer.insert (buffer.end(), bytes, bytes + size);
+
+        return offset;
+    };
+
+    // Compact modes and the Morton layout draw the base grid of every patch with a shared template, leaving the
+    // stitching templates with only the stitching. Stitching indexes neighbouring patches so it always needs 32-bit
+    // indices. Clusters replace the base grid with their own templates, as do decimated patches at a distance.
+    const auto morton       = m_builtLayout == PatchLayout::Morton;
+    const auto clustered    = m_builtClusters > 0;
+    const auto decimated    = m_decimateError > 0.f && m_builtMode == RenderMode::Patches;
+    const auto separateBase = clustered || morton || m_elementMode != ElementMode::Lists32 || decimated;
+
+    // We should just use the normal divisor for the dimensions.
+    const auto width = data.getDivisor(),
+               depth = data.getDivisor();
+
+    m_patches.reserve (data.getMeshTotal());
+
+    if (morton)
+    {
+        createPatchStitching (data, append);
+    }
+
+    else
+    {
+        // We have four types of elements to generate, one has stitching on two sides, one has stitching on the top, one
+        // has stitching on the right and one has no stitching.
+        const auto createElements = [&] (const MeshTemplate mesh)
+        {
+            // Start with clean data.
+            m_elements.clear();
+
+            // Generate the elements as normal.
+            if (!separateBase)
+            {
+                addElements (m_elements, width, depth);
+            }
+
+            addTemplateStitching (m_elements, data, mesh);
+
+            // Reorder the template for the vertex cache before it's uploaded.
+            optimiseElements (m_elements, templateNames[(unsigned int) mesh]);
+
+            // Update the mesh with the correct values.
+            const auto offset = append (m_elements.data(), m_elements.size() * sizeof (unsigned int));
+
+            m_meshTemplates[(unsigned int) mesh] = { 0, offset, m_elements.size() };
+        };
+    
+        // If we aren't segmenting then just load the top right corner template.
+        if (data.getMeshTotal() > 1)
+        {
+            createElements (MeshTemplate::Central);
+            createElements (MeshTemplate::TopRow);
+            createElements (MeshTemplate::RightColumn);
+        }
+    
+        // Do the top right corner last so we can cache the elements.
+        createElements (MeshTemplate::TopRightCorner);
+
+        // Each patch uses the template matching its position.
+        for (auto patch = 0U; patch < data.getMeshTotal(); ++patch)
+        {
+            const auto tile        = m_patchOrder[patch];
+            const bool isLastMeshX = tile % data.getMeshCountX() == data.getMeshCountX() - 1,
+                       isLastMeshZ = tile / data.getMeshCountX() == data.getMeshCountZ() - 1;
+
+            const auto& mesh = m_meshTemplates[templateIndex (isLastMeshX, isLastMeshZ)];
+
+            m_patches.emplace_back ((GLint) (patch * data.getMeshVertices()), mesh.elementsOffset, mesh.elementCount);
+        }
+    }
+
+    m_baseTemplate = { };
+    m_restartIndex = 0;
+    m_runCounts.clear();
+
+    if (separateBase)
+    {
+        if (clustered)
+        {
+            createClusterTemplates (data, append);
+        }
+
+        else
+        {
+            createBaseTemplate (width, depth, morton ? maxRunPatches : 1, append);
+        }
+
+        // Normals are calculated from the triangles of the base grid.
+        m_elements.clear();
+        addElements (m_elements, width, depth);
+    }
+}
+
+
+void Terrain::createBaseTemplate (const unsigned int width, const unsigned int depth, const unsigned int patchCount, const ElementAppender& append)
+{
+    // Up to 65536 vertices can be indexed with 16 bits so compact modes cover as many patches as 16 bits can reach.
+    // Strips can only use primitive restart when the largest 16-bit index is free to act as the restart index,
+    // otherwise rows are joined with degenerate triangles.
+    const auto patchVertices = width * depth,
+               shortLimit    = (unsigned int) std::numeric_limits<uint16_t>::max(),
+               shortPatches  = (shortLimit + 1) / patchVertices;
+
+    const auto compact       = m_elementMode != ElementMode::Lists32;
+    const auto patches       = compact && shortPatches > 0 ? std::min (patchCount, shortPatches) : patchCount;
+    const auto vertexCount   = patches * patchVertices;
+
+    const auto useShort      = compact && vertexCount - 1 <= shortLimit,
+               useStrips     = m_elementMode == ElementMode::Strips16,
+               useRestart    = useStrips && (!useShort || vertexCount - 1 < shortLimit);
+
+    m_basePrimitive = useStrips ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+    m_baseIndexType = useShort ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    m_restartIndex  = useRestart ? (useShort ? shortLimit : std::numeric_limits<unsigned int>::max()) : 0;
+
+    // Create the grid of a single patch then repeat it for every patch the template covers.
+    std::vector<unsigned int> grid { }, elements { };
+
+    if (useStrips)
+    {
+        createStripGrid (grid, width, depth, useRestart);
+    }
+
+    else
+    {
+        addElements (grid, width, depth);
+        optimiseElements (grid, "Base");
+    }
+
+    for (auto patch = 0U; patch < patches; ++patch)
+    {
+        const auto offset = patch * patchVertices;
+
+        if (patch > 0 && useStrips)
+        {
+            if (useRestart)
+            {
+                elements.push_back (m_restartIndex);
+            }
+
+            else
+            {
+                // Each strip must begin on an even triangle to keep its winding, every joining triangle is degenerate.
+                elements.push_back (elements.back());
+                elements.push_back (grid.front() + offset);
+
+                if (elements.size() % 2 == 1)
+                {
+                    elements.push_back (grid.front() + offset);
+                }
+            }
+        }
+
+        for (const auto element : grid)
+        {
+            elements.push_back (useRestart && element == m_restartIndex ? element : element + offset);
+        }
+
+        // Any number of patches up to this one can be drawn by stopping here.
+        m_runCounts.push_back ((GLuint) elements.size());
+    }
+
+    GLuint offset { 0 };
+
+    if (useShort)
+    {
+        const std::vector<uint16_t> shortElements (elements.cbegin(), elements.cend());
+        offset = append (shortElements.data(), shortElements.size() * sizeof (uint16_t));
+    }
+
+    else
+    {
+        offset = append (elements.data(), elements.size() * sizeof (unsigned int));
+    }
+
+    m_baseTemplate = { 0, offset, elements.size() };
 }
 
 
-//////////////////////
-// Public interface //
-//////////////////////
-
-void Terrain::buildFromHeightMap (const HeightMap& heightMap, const NoiseArgs& normal, const NoiseArgs& height, 
-                                  const unsigned int upscaledWidth, const unsigned int upscaledDepth)
+void Terrain::createStripGrid (std::vector<unsigned int>& grid, const unsigned int width, const unsigned int depth, const bool useRestart)
 {
-    // Ensure we have a clean set of data to work with.
-    cleanUp();
-    m_pool.generate();
+    // Strips which cross the whole patch leave a row behind before it's used again, when the row is wider than the
+    // vertex cache every vertex is transformed twice. Narrow bands of columns keep the previous row in the cache at the
+    // cost of joining more strips. Each band holds half of the cache so its bottom row survives the row above it.
+    const auto quads     = width - 1,
+               bandLimit = util::VertexCache::defaultSize / 2 - 1,
+               bandCount = (quads + bandLimit - 1) / bandLimit;
 
-    // Determine the dimensions of the terrain.
-    const auto width   = upscaledWidth == 0 ? heightMap.getWidth()  : upscaledWidth,
-               depth   = upscaledDepth == 0 ? heightMap.getHeight() : upscaledDepth,
-               divisor = determineDivisor (width, depth);
+    util::triangleStripAlgorithm (grid, 0, quads, depth - 1, 1, width, false, useRestart, m_restartIndex);
 
-    assert (width % divisor == 0 && depth % divisor == 0);
+    if (!m_optimiseCache || bandCount < 2)
+    {
+        return;
+    }
 
-    // Create the construction data so we can build the terrain.
-    const ConstructionData data { width, depth, divisor, heightMap.getWorldScale().x, heightMap.getWorldScale().z };
+    std::vector<unsigned int> bands { };
 
-    // Ensure the GPU has enough memory to process the terrain.
-    allocateGPUMemory (data);
+    for (auto band = 0U; band < bandCount; ++band)
+    {
+        // Bands share their edge columns and keep the diagonal pattern of the whole grid.
+        const auto firstX = quads * band / bandCount,
+                   lastX  = quads * (band + 1) / bandCount;
 
-    // We need the elements data to be correct first.
-    generateElements (data);
+        if (band > 0)
+        {
+            if (useRestart)
+            {
+                bands.push_back (m_restartIndex);
+            }
 
-    // Generate the terrain!
-    generateVertices (heightMap, data, normal, height);
+            else
+            {
+                // The same join as between patches, the first vertex of a row depends on whether it's mirrored.
+                const auto first = firstX % 2 == 1 ? firstX : firstX + width;
 
-    // We don't need the element data anymore.
-    m_elements.clear();
-    m_elements.shrink_to_fit();
-}
+                bands.push_back (bands.back());
+                bands.push_back (first);
 
+                if (bands.size() % 2 == 1)
+                {
+                    bands.push_back (first);
+                }
+            }
+        }
 
-void Terrain::cleanUp()
-{
-    // Put that memory away!
-    m_pool.clear();
-    m_patches.clear();
-}
+        util::triangleStripAlgorithm (bands, firstX, lastX - firstX, depth - 1, 1, width, firstX % 2 == 1, useRestart, m_restartIndex);
+    }
 
+    // Both orders are measured as the lists they draw, the bands are only kept when they make better use of the cache.
+    using Model = util::VertexCache::Model;
 
-void Terrain::prepareForRender (const GLuint program)
-{
-    // Pass on our best regards to the MeshPool.
-    m_pool.initialiseVAO (program);
-}
+    std::vector<unsigned int> rowList { }, bandList { };
+    util::triangleStripToList (rowList, grid, useRestart, m_restartIndex);
+    util::triangleStripToList (bandList, bands, useRestart, m_restartIndex);
 
+    VertexCacheReport report { };
+    report.name       = "Base strip";
+    report.fifoBefore = util::VertexCache::analyse (rowList, Model::FIFO);
+    report.lruBefore  = util::VertexCache::analyse (rowList, Model::LRU);
+    report.fifoAfter  = util::VertexCache::analyse (bandList, Model::FIFO);
+    report.lruAfter   = util::VertexCache::analyse (bandList, Model::LRU);
 
-void Terrain::draw()
-{
-    glBindVertexArray (m_pool.getVAO());
+    if (report.fifoAfter.acmr < report.fifoBefore.acmr)
+    {
+        grid = std::move (bands);
+    }
 
-    for (const auto& mesh : m_patches)
+    else
     {
-        glDrawElementsBaseVertex (GL_TRIANGLES, mesh.elementCount, GL_UNSIGNED_INT, (GLuint*) mesh.elementsOffset, mesh.firstVertex);
+        report.fifoAfter = report.fifoBefore;
+        report.lruAfter  = report.lruBefore;
     }
 
-    glBindVertexArray (0);
+    m_cacheReport.push_back (report);
 }
 
 
-//////////////
-// Creation //
-//////////////
-
-unsigned int Terrain::determineDivisor (const unsigned int width, const unsigned int depth) const
+void Terrain::createPatchStitching (const ConstructionData& data, const ElementAppender& append)
 {
-    // If the width or depth exceeds the divisor we must use that value.
-    if (m_divisor > width && width <= depth)
+    const auto meshCountX    = data.getMeshCountX(),
+               meshCountZ    = data.getMeshCountZ(),
+               patchVertices = data.getMeshVertices();
+
+    // Stitching is created as if patches were stored row by row, each index is then moved to where its patch is stored.
+    std::vector<unsigned int> storedIndex (m_patchOrder.size()), stitching { };
+
+    for (auto patch = 0U; patch < m_patchOrder.size(); ++patch)
     {
-        return width;
+        storedIndex[m_patchOrder[patch]] = patch;
     }
 
-    if (m_divisor > depth && depth < width)
+    for (auto patch = 0U; patch < m_patchOrder.size(); ++patch)
     {
-        return depth;
-    }
+        const auto tile        = m_patchOrder[patch];
+        const bool isLastMeshX = tile % meshCountX == meshCountX - 1,
+                   isLastMeshZ = tile / meshCountX == meshCountZ - 1;
 
-    return m_divisor;
-}
+        m_elements.clear();
+        addTemplateStitching (m_elements, data, (MeshTemplate) templateIndex (isLastMeshX, isLastMeshZ));
 
+        const auto first = stitching.size();
 
-void Terrain::allocateGPUMemory (const ConstructionData& data)
-{
-    // We only store the elements it takes to render an entire patch.
-    const auto quadCount = data.getMeshVertices();
+        for (const auto element : m_elements)
+        {
+            const auto rowMajor = tile * patchVertices + element;
 
-    // If we have more than one mesh we need four sets of elements data for the four types of patches. Two triangles make a quad.
-    const auto triangleCount = data.getMeshTotal() > 1 ? quadCount * 4 * 2 : quadCount * 2;
+            stitching.push_back (storedIndex[rowMajor / patchVertices] * patchVertices + rowMajor % patchVertices);
+        }
 
-    // Three elements are required to draw a single triangle.
-    const auto elementCount = triangleCount * 3;
+        // The offset is relative to the stitching until it has been appended.
+        m_patches.emplace_back ((GLint) (patch * patchVertices), (GLuint) (first * sizeof (unsigned int)), (GLuint) (stitching.size() - first));
+    }
 
-    // Now we can convert these values to bytes and allocate memory. Elements are stored using an unsigned int.
-    const auto verticesSize = data.getVertexCount() * sizeof (Vertex),
-               elementsSize = elementCount * sizeof (unsigned int);
+    const auto offset = append (stitching.data(), stitching.size() * sizeof (unsigned int));
 
-    // Finally allocate the memory. The calculated element size will always reserve more memory than necessary.
-    m_pool.fillData (BufferType::Vertices, verticesSize, nullptr);
-    m_pool.fillData (BufferType::Elements, elementsSize, nullptr);
+    for (auto& mesh : m_patches)
+    {
+        mesh.elementsOffset += offset;
+    }
 }
 
 
-//////////////////////
-// Element creation //
-//////////////////////
-
-void Terrain::generateElements (const ConstructionData& data)
+void Terrain::createClusterTemplates (const ConstructionData& data, const ElementAppender& append)
 {
-    // Lets speed this process up by reserving enough capacity.
-    m_elements.reserve (data.getMeshVertices() * 3);
-
-    // Keep track of the element offset for the meshes.
-    GLuint elementOffset { 0 };
+    m_clusters.reset (data.getDivisor(), m_builtClusters, data.getMeshTotal());
 
-    // We have four types of elements to generate, one has stitching on two sides, one has stitching on the top, one
-    // has stitching on the right and one has no stitching.
-    const auto createElements = [&] (const MeshTemplate mesh, const unsigned int width, const unsigned int depth)
+    for (auto& shape : m_clusters.getShapes())
     {
-        // Start with clean data.
-        m_elements.clear();
+        // Every cluster of the same size shares a template so they're worth reordering for the vertex cache.
+        optimiseElements (shape.elements, "Cluster");
 
-        // Generate the elements as normal.
-        addElements (m_elements, width, depth);
-        
-        // Stitch the X.
-        if (mesh == MeshTemplate::Central || mesh == MeshTemplate::TopRow)
-        {
-            addStitching (m_elements, data, depth, StitchingMode::XAxis);
-        }
+        GLuint offset { 0 };
 
-        // Stitch the Z.
-        if (mesh == MeshTemplate::Central || mesh == MeshTemplate::RightColumn)
+        if (m_clusters.getIndexType() == GL_UNSIGNED_SHORT)
         {
-            addStitching (m_elements, data, width, StitchingMode::ZAxis);
+            const std::vector<uint16_t> shortElements (shape.elements.cbegin(), shape.elements.cend());
+            offset = append (shortElements.data(), shortElements.size() * sizeof (uint16_t));
         }
 
-        // Clean up after ourselves.
-        if (mesh == MeshTemplate::Central)
+        else
         {
-            // The length is ignored.
-            addStitching (m_elements, data, 1, StitchingMode::Corner);
+            offset = append (shape.elements.data(), shape.elements.size() * sizeof (unsigned int));
         }
 
-        // Load the data into the GPU.
-        const auto size = m_elements.size() * sizeof (unsigned int);
-        
-        m_pool.fillSection (BufferType::Elements, elementOffset, size, m_elements.data());
+        shape.mesh = { 0, offset, shape.elements.size() };
+    }
+}
 
-        // Update the mesh with the correct values.
-        m_meshTemplates[(unsigned int) mesh] = { 0, elementOffset, m_elements.size() };
-        
-        // Increment the sausage!
-        elementOffset += size;
-    };
-    
-    // We should just use the normal divisor for the dimensions.
-    const auto width = data.getDivisor(),
-               depth = data.getDivisor();
-    
-    // If we aren't segmenting then just load the top right corner template.
-    if (data.getMeshTotal() > 1)
+
+void Terrain::addTemplateStitching (std::vector<unsigned int>& elements, const ConstructionData& data, const MeshTemplate mesh)
+{
+    // Patches are square so the stitching is the length of the divisor.
+    const auto length = data.getDivisor();
+
+    // Stitch the X.
+    if (mesh == MeshTemplate::Central || mesh == MeshTemplate::TopRow)
     {
-        createElements (MeshTemplate::Central, width, depth);
-        createElements (MeshTemplate::TopRow, width, depth);
-        createElements (MeshTemplate::RightColumn, width, depth);
+        addStitching (elements, data, length, StitchingMode::XAxis);
     }
-    
-    // Do the top right corner last so we can cache the elements.
-    createElements (MeshTemplate::TopRightCorner, width, depth);
+
+    // Stitch the Z.
+    if (mesh == MeshTemplate::Central || mesh == MeshTemplate::RightColumn)
+    {
+        addStitching (elements, data, length, StitchingMode::ZAxis);
+    }
+
+    // Clean up after ourselves.
+    if (mesh == MeshTemplate::Central)
+    {
+        // The length is ignored.
+        addStitching (elements, data, 1, StitchingMode::Corner);
+    }
+}
+
+
+void Terrain::optimiseElements (std::vector<unsigned int>& elements, const char* const name)
+{
+    if (!m_optimiseCache || elements.empty())
+    {
+        return;
+    }
+
+    using Model = util::VertexCache::Model;
+
+    VertexCacheReport report { };
+    report.name       = name;
+    report.fifoBefore = util::VertexCache::analyse (elements, Model::FIFO);
+    report.lruBefore  = util::VertexCache::analyse (elements, Model::LRU);
+
+    auto optimised = elements;
+    util::VertexCache::optimise (optimised);
+
+    report.fifoAfter  = util::VertexCache::analyse (optimised, Model::FIFO);
+    report.lruAfter   = util::VertexCache::analyse (optimised, Model::LRU);
+
+    // Most GPUs use FIFO caches so that decides which order is kept.
+    if (report.fifoAfter.acmr < report.fifoBefore.acmr)
+    {
+        elements = std::move (optimised);
+    }
+
+    else
+    {
+        report.fifoAfter = report.fifoBefore;
+        report.lruAfter  = report.lruBefore;
+    }
+
+    m_cacheReport.push_back (report);
 }
 
 
@@ -336,131 +1464,321 @@ void Terrain::addStitching (std::vector<unsigned int>& elements, const Construct
 // Vertices Creation //
 ///////////////////////
 
-void Terrain::generateVertices (const HeightMap& heightMap, const ConstructionData& data, const NoiseArgs& normal, const NoiseArgs& height)
+void Terrain::generateVertices (const HeightSource& heightMap, const ConstructionData& data, const NoiseArgs& normal, const NoiseArgs& height)
+{
+    if (m_upscaleMode == UpscaleMode::BezierSurface)
+    {
+        // Patches are generated a row at a time so only the control points used by the current row are kept, this
+        // bounds the working set when the height map is larger than memory.
+        ControlNetGrid grid { };
+        auto           bandOffset = std::numeric_limits<unsigned int>::max();
+
+        const auto bezierPatch = [&] (std::vector<Vertex>& vertices, const unsigned int xOffset, const unsigned int zOffset)
+        {
+            if (zOffset != bandOffset)
+            {
+                const auto maxZ = heightMap.getHeight() - 1;
+
+                grid.buildBand (heightMap, (float) zOffset / data.getDepth() * maxZ, 
+                                (float) (zOffset + data.getDivisor() - 1) / data.getDepth() * maxZ);
+
+                bandOffset = zOffset;
+            }
+
+            for (auto z = zOffset; z < zOffset + data.getDivisor(); ++z)
+            {
+                addRow (vertices, heightMap, grid, data, xOffset, z);
+            }
+        };
+
+        generatePatches (data, bezierPatch, normal, height);
+    }
+
+    else
+    {
+        // The separable modes only differ by their kernel.
+        const auto kernel = m_upscaleMode == UpscaleMode::SeparableCatmullRom ? util::CubicKernel::Type::CatmullRom :
+                            m_upscaleMode == UpscaleMode::SeparableBSpline    ? util::CubicKernel::Type::BSpline :
+                                                                                util::CubicKernel::Type::Bezier;
+
+        const SeparableUpscaler upscaler { heightMap, data, kernel };
+
+        const auto separablePatch = [&] (std::vector<Vertex>& vertices, const unsigned int xOffset, const unsigned int zOffset)
+        {
+            upscaler.addPatch (vertices, xOffset, zOffset);
+        };
+
+        generatePatches (data, separablePatch, normal, height);
+    }
+}
+
+
+void Terrain::generatePatches (const ConstructionData& data, const PatchGenerator& generator, const NoiseArgs& normal, const NoiseArgs& height)
 {
     // Cache some constants we'll be using.
     const auto divisor       = data.getDivisor();
 
-    const auto meshCountX    = data.getMeshCountX(),
-               meshCountZ    = data.getMeshCountZ();
-               
-    const auto lastMeshX     = meshCountX - 1,
-               lastMeshZ     = meshCountZ - 1;
+    const auto meshCountX    = data.getMeshCountX();
 
     // We're going to need a vector to store the data of each patch.
     std::vector<Vertex> vertices { };
 
+    // Quantised formats also need somewhere to store the converted patch and the bounds of every patch.
+    const auto             vertexSize = MeshPool::getVertexSize (m_builtFormat);
+    std::vector<uint8_t>   quantised  { };
+    std::vector<glm::vec4> transforms { };
+
+    if (m_builtFormat != VertexFormat::Float)
+    {
+        transforms.resize (data.getMeshTotal() * 2);
+    }
+
     // Lets reserve us some memory to speed this process up!
     vertices.reserve (data.getMeshVertices());
-    m_patches.reserve (data.getMeshTotal());
 
-    // Keep track of the elements offset.
-    GLint firstVertex { 0 };
+    // The final heights are kept so that the terrain can be summarised once every patch is complete.
+    std::vector<float> heights (data.getVertexCount());
+
+    // Stitching reaches the first column, first row and first vertex of the patches ahead so those are bound too. They
+    // are kept by row-major tile until every patch has been generated.
+    struct Box final
+    {
+        glm::vec3 minimum, maximum;
+
+        void include (const glm::vec3& position)
+        {
+            minimum = glm::min (minimum, position);
+            maximum = glm::max (maximum, position);
+        }
+    };
+
+    // The CDLOD and clipmap modes only need the final heights, everything else describes the patches being drawn.
+    const auto drawPatches = m_builtMode == RenderMode::Patches;
+
+    std::vector<Box>       columns { }, rows { };
+    std::vector<glm::vec3> corners { };
+
+    if (drawPatches)
+    {
+        columns.resize (data.getMeshTotal());
+        rows.resize (data.getMeshTotal());
+        corners.resize (data.getMeshTotal());
+
+        m_bounds.reset (data.getMeshTotal());
+        m_horizon.reset (data.getMeshTotal(), horizonBlocks * horizonBlocks);
+    }
+
+    // Patches are generated row by row, whatever order they're stored in, so that the generator reads the height map
+    // one band at a time. Each patch is then scattered into the slot it is stored in.
+    std::vector<unsigned int> storedIndex (m_patchOrder.size());
 
-    // We're going to need two loops to determine the correct mesh and two loops to calculate interpolated co-ordinates.
-    for (auto zTile = 0U; zTile < meshCountZ; ++zTile)
+    for (auto patch = 0U; patch < m_patchOrder.size(); ++patch)
     {
-        for (auto xTile = 0U; xTile < meshCountX; ++xTile)
+        storedIndex[m_patchOrder[patch]] = patch;
+    }
+
+    for (auto tile = 0U; tile < storedIndex.size(); ++tile)
+    {
+        const auto patch = storedIndex[tile];
+
+        // We need the vertex offsets so can we get the obtain the correct data from the height map.
+        const auto xOffset = tile % meshCountX * divisor,
+                   zOffset = tile / meshCountX * divisor;
+
+        // Upscale the patch.
+        generator (vertices, xOffset, zOffset);
+
+        // Apply some beautiful noise to the terrain.
+        applyNoise (vertices, normal, height);
+
+        // Place each height back into the grid of the whole terrain, which is always row by row.
+        for (auto i = 0U; i < vertices.size(); ++i)
+        {
+            heights[xOffset + i % divisor + (zOffset + i / divisor) * data.getWidth()] = vertices[i].position.y;
+        }
+
+        if (!drawPatches)
+        {
+            vertices.clear();
+            continue;
+        }
+
+        // Recalculate the normals since we've ruined them with noise.
+        calculateNormals (vertices, data);
+
+        // Bound the patch using the final positions, noise moves vertices in every direction.
+        auto box = Box { vertices.front().position, vertices.front().position };
+
+        columns[tile] = box;
+        rows[tile]    = box;
+        corners[tile] = vertices.front().position;
+
+        for (auto i = 0U; i < vertices.size(); ++i)
         {
-            // We need the vertex offsets so can we get the obtain the correct data from the height map.
-            const auto xOffset = xTile * divisor,
-                       zOffset = zTile * divisor;
+            const auto& position = vertices[i].position;
 
-            // Cache the values which end the loops so we don't calculate them every time.
-            const auto widthEnd = xOffset + divisor,
-                       depthEnd = zOffset + divisor;
+            box.include (position);
 
-            for (auto z = zOffset; z < depthEnd; ++z)
+            if (i % divisor == 0)
             {
-                for (auto x = xOffset; x < widthEnd; ++x)
-                {
-                    // Obtain the necessary UV co-ordinates to create the vertex. 
-                    const auto u = (float) x / data.getWidth(),
-                               v = (float) z / data.getDepth();
+                columns[tile].include (position);
+            }
+
+            if (i < divisor)
+            {
+                rows[tile].include (position);
+            }
+        }
+
+        m_bounds.include (patch, box.minimum, box.maximum);
 
-                    addVertex (vertices, heightMap, u, v);
+        // The surface over a block of quads is never below the lowest vertex of the block, so everything beneath it is
+        // hidden. Vertices are taken to sit on their grid position, the noise barely moves them horizontally.
+        for (auto block = 0U; block < horizonBlocks * horizonBlocks; ++block)
+        {
+            const auto quads  = divisor - 1,
+                       startX = quads * (block % horizonBlocks) / horizonBlocks,
+                       startZ = quads * (block / horizonBlocks) / horizonBlocks,
+                       endX   = quads * (block % horizonBlocks + 1) / horizonBlocks,
+                       endZ   = quads * (block / horizonBlocks + 1) / horizonBlocks;
+
+            auto lowest = vertices[startX + startZ * divisor].position.y;
+
+            for (auto z = startZ; z <= endZ; ++z)
+            {
+                for (auto x = startX; x <= endX; ++x)
+                {
+                    lowest = std::min (lowest, vertices[x + z * divisor].position.y);
                 }
             }
 
-            // Apply some beautiful noise to the terrain.
-            applyNoise (vertices, normal, height);
+            const auto gridStart = glm::vec2 ((xOffset + startX) * m_spacing.x, (zOffset + startZ) * m_spacing.y),
+                       gridEnd   = glm::vec2 ((xOffset + endX) * m_spacing.x, (zOffset + endZ) * m_spacing.y);
+
+            m_horizon.setOccluder (patch, block, glm::min (gridStart, gridEnd), glm::max (gridStart, gridEnd), lowest);
+        }
 
-            // Recalculate the normals since we've ruined them with noise.
-            calculateNormals (vertices, data);
+        // Clusters are bound by the final positions so they must be added after the noise.
+        if (m_builtClusters > 0)
+        {
+            m_clusters.addPatch (patch, vertices, m_patches[patch].firstVertex);
+        }
 
-            // Add the data to the GPU.
-            const auto verticesSize = vertices.size() * sizeof (Vertex);
+        // Add the data to the GPU, quantising it first if necessary.
+        const void* patchData = vertices.data();
 
-            m_pool.fillSection (BufferType::Vertices, firstVertex * sizeof (Vertex), verticesSize, vertices.data());
+        if (m_builtFormat != VertexFormat::Float)
+        {
+            quantisePatch (vertices, xOffset, zOffset, quantised, &transforms[patch * 2]);
+            patchData = quantised.data();
+        }
 
-            // Check if we're on the last tile on either axis.
-            const bool isLastMeshX = xTile == lastMeshX,
-                       isLastMeshZ = zTile == lastMeshZ;
+        m_pool.fillSection (BufferType::Vertices, m_patches[patch].firstVertex * vertexSize, vertices.size() * vertexSize, patchData);
 
-            // Now construct the mesh.
-            const auto& mesh = m_meshTemplates[templateIndex (isLastMeshX, isLastMeshZ)];
+        vertices.clear();
+    }
 
-            m_patches.emplace_back (firstVertex, mesh.elementsOffset, mesh.elementCount);
+    if (drawPatches)
+    {
+        // Grow each patch to contain the vertices its stitching joins to.
+        for (auto patch = 0U; patch < m_patchOrder.size(); ++patch)
+        {
+            const auto tile        = m_patchOrder[patch];
+            const bool isLastMeshX = tile % meshCountX == meshCountX - 1,
+                       isLastMeshZ = tile / meshCountX == data.getMeshCountZ() - 1;
 
-            // Increment everything captain!
-            firstVertex += vertices.size();
-            vertices.clear();
+            if (!isLastMeshX)
+            {
+                m_bounds.include (patch, columns[tile + 1].minimum, columns[tile + 1].maximum);
+            }
+
+            if (!isLastMeshZ)
+            {
+                m_bounds.include (patch, rows[tile + meshCountX].minimum, rows[tile + meshCountX].maximum);
+            }
+
+            if (!isLastMeshX && !isLastMeshZ)
+            {
+                m_bounds.include (patch, corners[tile + meshCountX + 1], corners[tile + meshCountX + 1]);
+            }
         }
+
+        // The quadtree merges the finished bounds so whole areas of the terrain can be culled at once.
+        m_quadtree.build (m_bounds, m_patchOrder, meshCountX, data.getMeshCountZ());
+    }
+
+    // The vertex shader needs the bounds of each patch to restore quantised positions.
+    if (m_builtFormat != VertexFormat::Float)
+    {
+        m_pool.fillData (BufferType::PatchTransforms, transforms.size() * sizeof (glm::vec4), transforms.data());
     }
+
+    // Summarise the final heights so bounds can be found without touching every vertex.
+    m_pyramid.build (data.getWidth(), data.getDepth(), std::move (heights));
+
+    // Occluders stand on the lowest heights of the finished terrain.
+    m_occlusion.build (m_pyramid, m_patchOrder, meshCountX, data.getMeshCountZ(), divisor, m_spacing, occluderBlocks);
 }
 
 
-void Terrain::addVertex (std::vector<Vertex>& vector, const HeightMap& heightMap, const float u, const float v)
+void Terrain::addRow (std::vector<Vertex>& vector, const HeightSource& heightMap, const ControlNetGrid& grid, const ConstructionData& data, 
+                      const unsigned int firstX, const unsigned int z) const
 {
-    // We need a vector of 16 control points, four by four.
-    const auto bezierWidth     = 4U,
-               bezierHeight    = 4U,
-               bezierWidthInc  = 3U,
-               bezierHeightInc = 3U,
-               gridSize        = bezierWidth * bezierHeight;
-
-    static std::vector<glm::vec3> controlPoints { 0 };
-    controlPoints.reserve (gridSize);
+    // A set of control points spans this many points of the height map.
+    const auto bezierWidthInc  = bezierDegree,
+               bezierHeightInc = bezierDegree;
 
     // Ensure we don't go beyond the maximum array values.
     const auto maxX = heightMap.getWidth() - 1,
                maxY = heightMap.getHeight() - 1;
 
-    // Calculate where we are in the height map.
-    const auto smallX = u * maxX,
-               smallY = v * maxY;
+    // The whole row shares a V co-ordinate so calculate where we are in the height map once.
+    const auto v         = (float) z / data.getDepth(),
+               smallY    = v * maxY;
+
+    const auto netZ      = grid.netZ (smallY),
+               baseY     = netZ * bezierHeightInc;
 
-    // Determine the base control point.
-    const auto unsignedX = (unsigned int) smallX,
-               unsignedY = (unsigned int) smallY,
-               baseX     = unsignedX - unsignedX % bezierWidthInc,
-               baseY     = unsignedY - unsignedY % bezierHeightInc;
-               
-    auto       basePoint = baseX + baseY * heightMap.getWidth();
+    const auto localV    = (smallY - baseY) / bezierHeightInc;
 
-    // Check if we need to change the control points stored.
-    if (controlPoints.empty() || controlPoints.front() != heightMap[basePoint])
+    // Make room for the row so the vertices can be written straight into the vector.
+    auto       output    = vector.size();
+    vector.resize (output + data.getDivisor());
+
+    // Points are evaluated in batches which share the same control points, this keeps the SIMD lanes busy.
+    const auto batchSize = 64U;
+    float      localU[batchSize];
+
+    const auto endX      = firstX + data.getDivisor();
+    auto       x         = firstX;
+
+    while (x < endX)
     {
-        controlPoints.clear();
-        
-        const auto newLine = heightMap.getWidth() - bezierWidth;
+        // Determine which control points the batch uses.
+        const auto netX  = grid.netX ((float) x / data.getWidth() * maxX),
+                   baseX = netX * bezierWidthInc;
 
-        for (auto j = 0U; j < bezierHeight; ++j)
+        auto       count = 0U;
+
+        // Keep adding points until they need different control points or the batch is full.
+        while (x < endX && count < batchSize)
         {
-            for (auto i = 0U; i < bezierWidth; ++i)
+            const auto pointX = (float) x / data.getWidth() * maxX;
+
+            if (grid.netX (pointX) != netX)
             {
-                controlPoints.push_back (heightMap[basePoint++]);
+                break;
             }
 
-            basePoint += newLine;
+            // Create the local co-ordinates used by the bezier surface algorithm.
+            localU[count++] = (pointX - baseX) / bezierWidthInc;
+            ++x;
         }
-    }
 
-    // Create the local co-ordinates used by the bezier surface algorithm.
-    const auto localU = (smallX - baseX) / bezierWidthInc,
-               localV = (smallY - baseY) / bezierHeightInc;
+        util::BezierSurface::calculateRow<bezierDegree> (grid.getNet (netX, netZ), localU, localV, count, &vector[output]);
 
-    vector.push_back (util::BezierSurface::calculatePoint (controlPoints, localU, localV, util::BezierSurface::BezierAlgorithm::Cubic));
+        output += count;
+    }
 }
 
 
@@ -499,6 +1817,52 @@ void Terrain::applyNoise (std::vector<Vertex>& vertices, const NoiseArgs& normal
 }
 
 
+void Terrain::quantisePatch (const std::vector<Vertex>& vertices, const unsigned int xOffset, const unsigned int zOffset, 
+                             std::vector<uint8_t>& output, glm::vec4* const transform) const
+{
+    // Find the bounds of the patch after noise has been applied.
+    auto minimum = vertices.front().position,
+         maximum = vertices.front().position;
+
+    for (const auto& vertex : vertices)
+    {
+        minimum = glm::min (minimum, vertex.position);
+        maximum = glm::max (maximum, vertex.position);
+    }
+
+    // Flat axes can't be divided by, every vertex simply sits at the origin on that axis.
+    const auto extent  = maximum - minimum;
+    const auto inverse = glm::vec3 (extent.x > 0.f ? 1.f / extent.x : 0.f, 
+                                    extent.y > 0.f ? 1.f / extent.y : 0.f, 
+                                    extent.z > 0.f ? 1.f / extent.z : 0.f);
+
+    // Height only vertices rebuild their X and Z co-ordinates from the position of the patch, which is stored in the 
+    // spare components because patches aren't necessarily stored row by row.
+    transform[0] = glm::vec4 (minimum, (float) xOffset);
+    transform[1] = glm::vec4 (extent, (float) zOffset);
+
+    output.resize (vertices.size() * MeshPool::getVertexSize (m_builtFormat));
+
+    switch (m_builtFormat)
+    {
+        case VertexFormat::Quantised16:
+            quantiseVertices (vertices, minimum, inverse, reinterpret_cast<QuantisedVertex16*> (output.data()));
+            break;
+
+        case VertexFormat::Quantised8:
+            quantiseVertices (vertices, minimum, inverse, reinterpret_cast<QuantisedVertex8*> (output.data()));
+            break;
+
+        case VertexFormat::HeightOnly:
+            quantiseVertices (vertices, minimum, inverse, reinterpret_cast<HeightVertex*> (output.data()));
+            break;
+
+        default:
+            throw std::logic_error ("Terrain::quantisePatch(), this should never be thrown.");
+    }
+}
+
+
 void Terrain::calculateNormals (std::vector<Vertex>& vertices, const ConstructionData& data)
 {
     // Firstly we need to invalidate the normal of each vertex.
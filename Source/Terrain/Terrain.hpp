@@ -4,17 +4,35 @@
 
 // STL headers.
 #include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
 #include <vector>
 
 
 // Personal headers.
 #include <Renderer/Mesh.hpp>
 #include <Renderer/MeshPool.hpp>
+#include <Terrain/GeometryClipmap.hpp>
+#include <Terrain/HeightPyramid.hpp>
+#include <Terrain/HeightQuery.hpp>
+#include <Terrain/HeightRaycaster.hpp>
+#include <Terrain/HorizonCuller.hpp>
+#include <Terrain/LodQuadtree.hpp>
+#include <Terrain/OcclusionCuller.hpp>
+#include <Terrain/PatchDecimator.hpp>
+#include <Terrain/PatchBounds.hpp>
+#include <Terrain/PatchClusters.hpp>
+#include <Terrain/PatchDrawPlanner.hpp>
+#include <Terrain/PatchQuadtree.hpp>
+#include <Terrain/PatchSorter.hpp>
+#include <Utility/BezierSurface.hpp>
 #include <Utility/NoiseGenerator.hpp>
+#include <Utility/VertexCache.hpp>
 
 
 // Forward decalarations & aliases.
-class HeightMap;
+class HeightSource;
 struct Vertex;
 
 using NoiseArgs = util::NoiseArgs<float>;
@@ -28,6 +46,60 @@ class Terrain final
 {
     public:
 
+        /// <summary>
+        /// Determines how the height map is upscaled to the dimensions of the terrain.
+        /// </summary>
+        enum class UpscaleMode : int
+        {
+            BezierSurface,          //!< Evaluates a bicubic Bezier surface over the points of the height map.
+            SeparableBezier,        //!< Filters only the heights with the Bezier basis, one axis at a time.
+            SeparableCatmullRom,    //!< Filters only the heights with a Catmull-Rom spline, one axis at a time.
+            SeparableBSpline        //!< Filters only the heights with a cubic B-spline, one axis at a time.
+        };
+
+        /// <summary>
+        /// Determines how the element templates of each patch are stored and drawn.
+        /// </summary>
+        enum class ElementMode : int
+        {
+            Lists32,    //!< Each template is a 32-bit triangle list containing the grid and stitching of the patch.
+            Lists16,    //!< The grid is a shared 16-bit triangle list, the stitching remains 32-bit.
+            Strips16    //!< The grid is a shared 16-bit triangle strip, the stitching remains a 32-bit list.
+        };
+
+        /// <summary>
+        /// Determines the order patches are stored in the vertex buffer.
+        /// </summary>
+        enum class PatchLayout : int
+        {
+            RowMajor,   //!< Patches are stored row by row and drawn one at a time using the shared element templates.
+            Morton      //!< Patches are stored in Morton order so consecutive visible patches can be drawn together.
+        };
+
+        /// <summary>
+        /// Determines how the terrain is drawn.
+        /// </summary>
+        enum class RenderMode : int
+        {
+            Patches,    //!< Every visible patch is drawn at full resolution with the element templates and their stitching.
+            CDLOD,      //!< A quadtree of nodes is drawn with a shared grid which morphs between levels of detail by distance.
+            Clipmap     //!< Nested rings of a fixed grid are centred on the camera, only the heights entering each ring are uploaded.
+        };
+
+        /// <summary>
+        /// How well a triangle list template uses the vertex cache before and after optimisation, measured with both
+        /// simulated cache models at the default cache size.
+        /// </summary>
+        struct VertexCacheReport final
+        {
+            const char*                     name        { nullptr };    //!< The template which was measured.
+            util::VertexCache::Statistics   fifoBefore  { };            //!< The generated order in a FIFO cache.
+            util::VertexCache::Statistics   fifoAfter   { };            //!< The uploaded order in a FIFO cache.
+            util::VertexCache::Statistics   lruBefore   { };            //!< The generated order in an LRU cache.
+            util::VertexCache::Statistics   lruAfter    { };            //!< The uploaded order in an LRU cache.
+        };
+
+
         /////////////////////////////////
         // Constructors and destructor //
         /////////////////////////////////
@@ -52,19 +124,176 @@ class Terrain final
         /// <param name="divisor"> The maximum numbers of vertices wide/deep of each terrain patch. </param>
         void setDivisor (const unsigned int divisor);
 
+        /// <summary> Gets the method used to upscale height maps. </summary>
+        UpscaleMode getUpscaleMode() const  { return m_upscaleMode; }
+
+        /// <summary> Sets how height maps are upscaled. Note this value will only be used during future build calls. </summary>
+        /// <param name="mode"> The upscaling method to use. </param>
+        void setUpscaleMode (const UpscaleMode mode)    { m_upscaleMode = mode; }
+
+        /// <summary> Gets how the element templates are stored. </summary>
+        ElementMode getElementMode() const      { return m_elementMode; }
+
+        /// <summary> Sets how the element templates are stored. Note this value will only be used during future build calls. </summary>
+        /// <param name="mode"> The element mode to use. Patches with more than 65536 vertices fall back to 32-bit indices. </param>
+        void setElementMode (const ElementMode mode)    { m_elementMode = mode; }
+
+        /// <summary> Gets the order patches are stored in. </summary>
+        PatchLayout getPatchLayout() const      { return m_patchLayout; }
+
+        /// <summary> Sets the order patches are stored in. Note this value will only be used during future build calls. </summary>
+        /// <param name="layout"> The patch layout to use. </param>
+        void setPatchLayout (const PatchLayout layout)  { m_patchLayout = layout; }
+
+        /// <summary> Gets how vertices are stored on the GPU. </summary>
+        VertexFormat getVertexFormat() const    { return m_vertexFormat; }
+
+        /// <summary> Sets how vertices are stored on the GPU. Note this value will only be used during future build calls. </summary>
+        /// <param name="format"> The vertex format to use. </param>
+        void setVertexFormat (const VertexFormat format)    { m_vertexFormat = format; }
+
+        /// <summary> Gets whether triangle list templates are reordered to make better use of the vertex cache. </summary>
+        bool getOptimiseVertexCache() const     { return m_optimiseCache; }
+
+        /// <summary> Sets whether triangle list templates are reordered. Note this value will only be used during future build calls. </summary>
+        /// <param name="optimise"> Whether to optimise, strips are never reordered. </param>
+        void setOptimiseVertexCache (const bool optimise)   { m_optimiseCache = optimise; }
+
+        /// <summary> Gets how many quads wide and deep each culling cluster is, zero when patches aren't clustered. </summary>
+        unsigned int getClusterSize() const     { return m_clusterSize; }
+
+        /// <summary> Sets the size of the culling clusters. Note this value will only be used during future build calls. </summary>
+        /// <param name="size"> How many quads wide and deep each cluster is, zero disables clustering and otherwise it must be even. Clusters replace the grid templates of the element mode. </param>
+        void setClusterSize (const unsigned int size);
+
+        /// <summary> Gets how the terrain is drawn. </summary>
+        RenderMode getRenderMode() const        { return m_renderMode; }
+
+        /// <summary> Sets how the terrain is drawn. Note this value will only be used during future build calls. </summary>
+        /// <param name="mode"> The render mode to use. The CDLOD and clipmap modes ignore the vertex format, element mode, layout and cluster size. </param>
+        void setRenderMode (const RenderMode mode)  { m_renderMode = mode; }
+
+        /// <summary> Gets the largest error in pixels the CDLOD mode allows a node to show. </summary>
+        float getLodPixelError() const          { return m_lodPixelError; }
+
+        /// <summary> Sets the largest error in pixels the CDLOD mode allows a node to show, used by future calls to cull(). </summary>
+        /// <param name="pixels"> The error bound, smaller values draw more triangles. </param>
+        void setLodPixelError (const float pixels);
+
+        /// <summary> Gets the CDLOD quadtree with the nodes chosen by the last call to cull(), empty unless built in the CDLOD mode. </summary>
+        const LodQuadtree& getLodQuadtree() const   { return m_lod; }
+
+        /// <summary> Gets the geometry clipmap placed by the last call to cull(), empty unless built in the clipmap mode. </summary>
+        const GeometryClipmap& getClipmap() const   { return m_clipmap; }
+
+        /// <summary> Gets the vertical error in world units each patch is decimated to for drawing at a distance, zero when patches aren't decimated. </summary>
+        float getDecimationError() const        { return m_decimateError; }
+
+        /// <summary>
+        /// Sets the vertical error in world units each patch is decimated to. Note this value will only be used during future
+        /// build calls. Only terrain built in the patches mode is decimated, the decimated patches are drawn once they're
+        /// far enough away that the error covers fewer pixels than the CDLOD pixel error.
+        /// </summary>
+        /// <param name="error"> The largest vertical error allowed, zero disables decimation. </param>
+        void setDecimationError (const float error);
+
+        /// <summary> Gets the file decimated patches are baked to, empty when they're decimated on every build. </summary>
+        const std::string& getDecimationBakeFile() const    { return m_bakeFile; }
+
+        /// <summary> Sets the file decimated patches are loaded from when it matches the terrain, otherwise it's replaced by a new bake. </summary>
+        /// <param name="file"> The location of the bake file, empty to always decimate. </param>
+        void setDecimationBakeFile (const std::string& file)    { m_bakeFile = file; }
+
+        /// <summary> Gets the decimated patches of the built terrain with how much they were simplified, empty unless decimation is enabled. </summary>
+        const PatchDecimator& getDecimator() const  { return m_decimator; }
+
+        /// <summary> Gets the bounding box of every patch, including its stitching, in the order the patches are stored. </summary>
+        const PatchBounds& getPatchBounds() const   { return m_bounds; }
+
+        /// <summary> Gets the quadtree used to find the visible patches, with the work done by the last call to cull(). </summary>
+        const PatchQuadtree& getPatchQuadtree() const   { return m_quadtree; }
+
+        /// <summary> Gets whether cull() also removes patches hidden behind nearer terrain. </summary>
+        bool getHorizonCulling() const          { return m_cullHorizon; }
+
+        /// <summary> Sets whether cull() also removes patches hidden behind nearer terrain, the camera must be above the terrain. </summary>
+        /// <param name="cull"> Whether to cull hidden patches. </param>
+        void setHorizonCulling (const bool cull)    { m_cullHorizon = cull; }
+
+        /// <summary> Gets how many patches were hidden by nearer terrain during the last call to cull(). </summary>
+        const HorizonCuller::Statistics& getHorizonStatistics() const   { return m_horizon.getStatistics(); }
+
+        /// <summary> Gets whether cull() also draws the nearest patches on the CPU and removes the patches hidden behind them. </summary>
+        bool getOcclusionCulling() const        { return m_cullOcclusion; }
+
+        /// <summary> Sets whether cull() also draws the nearest patches on the CPU and removes the patches hidden behind them. </summary>
+        /// <param name="cull"> Whether to cull occluded patches. </param>
+        void setOcclusionCulling (const bool cull)  { m_cullOcclusion = cull; }
+
+        /// <summary> Gets how many patches were occluded during the last call to cull() and how long it took. </summary>
+        const OcclusionCuller::Statistics& getOcclusionStatistics() const   { return m_occlusion.getStatistics(); }
+
+        /// <summary> Gets whether cull() sorts the visible patches front to back so the nearest fill the depth buffer first. </summary>
+        bool getPatchSorting() const            { return m_sortPatches; }
+
+        /// <summary> Sets whether cull() sorts the visible patches front to back, fewer patches are drawn together when sorted. Only the patches mode sorts. </summary>
+        /// <param name="sort"> Whether to sort the visible patches. </param>
+        void setPatchSorting (const bool sort)      { m_sortPatches = sort; }
+
+        /// <summary> Gets whether sorting also estimates the overdraw of the visible patches before and after they're sorted. </summary>
+        bool getOverdrawEstimation() const      { return m_sortEstimate; }
+
+        /// <summary> Sets whether sorting also estimates the overdraw of the visible patches on the CPU before and after they're sorted. </summary>
+        /// <param name="estimate"> Whether to estimate the overdraw. </param>
+        void setOverdrawEstimation (const bool estimate)    { m_sortEstimate = estimate; }
+
+        /// <summary> Gets how long the last call to cull() took to sort the visible patches and their estimated overdraw. </summary>
+        const PatchSorter::Statistics& getSortStatistics() const    { return m_sorter.getStatistics(); }
+
+        /// <summary> Gets how many patches the terrain is split into. </summary>
+        size_t getPatchCount() const                { return m_patches.size(); }
+
+        /// <summary> Gets how many patches were found to be visible by the last call to cull(). </summary>
+        size_t getVisiblePatchCount() const         { return m_visible.size(); }
+
+        /// <summary> Counts the draw calls the next call to draw() will make for the patches found by the last call to cull(). </summary>
+        /// <returns> How many draw calls are made in the patches mode, zero in the other modes. </returns>
+        size_t countPatchDraws() const;
+
+        /// <summary> Gets the index of every patch found to be visible by the last call to cull(), in ascending order unless sorted front to back. </summary>
+        const std::vector<unsigned int>& getVisiblePatches() const  { return m_visible; }
+
+        /// <summary> Gets how many of the visible patches were drawn decimated after the last call to cull(). </summary>
+        size_t getDecimatedPatchCount() const       { return m_far.size(); }
+
+        /// <summary> Gets how many clusters and triangles were culled by the last call to cull(). </summary>
+        const PatchClusters::Statistics& getClusterStatistics() const   { return m_clusters.getStatistics(); }
+
+        /// <summary> Gets the vertex cache efficiency of every optimised template, empty if optimisation was disabled. </summary>
+        const std::vector<VertexCacheReport>& getVertexCacheReport() const     { return m_cacheReport; }
+
+        /// <summary> Gets the minimum and maximum heights of the built terrain, after noise has been applied. </summary>
+        const HeightPyramid& getHeightPyramid() const   { return m_pyramid; }
+
+        /// <summary> Creates a view which can query the height and normal of the built terrain at any world position. </summary>
+        HeightQuery getHeightQuery() const;
+
+        /// <summary> Creates a raycaster which intersects rays with the built terrain, it is invalid until the terrain is built. </summary>
+        HeightRaycaster getRaycaster() const;
+
         
         //////////////////////
         // Public interface //
         //////////////////////
 
-        /// <summary> Attempt to build the terrain from a given height map. </summary>
+        /// <summary> Attempt to build the terrain from a given height map, which may be in memory or tiled on disk. </summary>
         /// <param name="heightMap"> The height map data to load from. </param>
         /// <param name="normal"> The noise parameters to be applied during normal displacement. </param>
         /// <param name="height"> The noise parameters to be applied during height displacement. </param>
         /// <param name="upscaledWidth"> How many vertices wide the final terrain should be, leave this at 0 to avoid upscaling the width. </param>
         /// <param name="upscaledDepth"> How many vertices deep the final terrain should be, leave this at 0 to avoid upscaling the depth. </param>
         /// <returns> Whether the terrain was successfully built. </returns>
-        void buildFromHeightMap (const HeightMap& heightMap, const NoiseArgs& normal, const NoiseArgs& height,
+        void buildFromHeightMap (const HeightSource& heightMap, const NoiseArgs& normal, const NoiseArgs& height,
                                  const unsigned int width = 0, const unsigned int depth = 0);
 
         /// <summary> Delete any allocated memory. </summary>
@@ -74,6 +303,26 @@ class Terrain final
         /// <param name="program"> The program to use when preparing the terrain. </param>
         void prepareForRender (const GLuint program);
 
+        /// <summary> 
+        /// Chooses the patches to draw from the camera, skipping those which are off-screen. When the terrain was built
+        /// with clusters those which are off-screen or face away from the camera are skipped too, in which case this must
+        /// be called before drawing. Every patch is drawn until this is first called. In the CDLOD mode this instead
+        /// chooses the nodes to draw and in the clipmap mode this centres the levels on the camera, uploading the heights
+        /// which enter them, only the occluders are drawn for isOccluded(). Nothing is drawn in either mode until it is
+        /// first called. The visible patches are drawn in ascending order unless patch sorting is enabled, in which case
+        /// they're drawn front to back.
+        /// </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform of the camera. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        /// <param name="viewportHeight"> How many pixels tall the view is, the CDLOD mode bounds the error of each node in pixels. </param>
+        void cull (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const float viewportHeight = 1080.f);
+
+        /// <summary> Tests whether a box is hidden behind the terrain drawn into the occlusion buffer by the last call to cull(). </summary>
+        /// <param name="minimum"> The minimum corner of the box. </param>
+        /// <param name="maximum"> The maximum corner of the box. </param>
+        /// <returns> False unless occlusion culling is enabled and the box is entirely hidden. </returns>
+        bool isOccluded (const glm::vec3& minimum, const glm::vec3& maximum) const  { return m_cullOcclusion && m_occlusion.getBuffer().isOccluded (minimum, maximum); }
+
         /// <summary> Draw the terrain bro! </summary>
         void draw();
 
@@ -84,6 +333,41 @@ class Terrain final
         //////////////////////////
 
         class ConstructionData;
+        class ControlNetGrid;
+        class SeparableUpscaler;
+
+        /// <summary> The texture unit the patch transforms are bound to when drawing quantised vertices. </summary>
+        static const int patchTextureUnit = 0;
+
+        /// <summary> The texture unit the heights are bound to when drawing in the CDLOD mode. </summary>
+        static const int heightTextureUnit = 1;
+
+        /// <summary> The texture unit the heights of every level are bound to when drawing in the clipmap mode. </summary>
+        static const int clipmapTextureUnit = 2;
+
+        /// <summary> The most levels the clipmap mode creates, the terrain beyond the coarsest level isn't drawn. </summary>
+        static const unsigned int maxClipmapLevels = 8;
+
+        /// <summary> The most patches drawn by a single draw of the base template in the Morton layout, a 2x2 square of patches. </summary>
+        static const unsigned int maxRunPatches = 4;
+
+        /// <summary> How many blocks each patch is split into on each axis when occluding nearer patches for horizon culling. </summary>
+        static const unsigned int horizonBlocks = 4;
+
+        /// <summary> How many blocks the occluder of each patch is split into on each axis for occlusion culling. </summary>
+        static const unsigned int occluderBlocks = 4;
+
+        /// <summary> The degree of the Bezier surface used when upscaling, 3 is cubic and 2 is quadratic. </summary>
+        static const unsigned int bezierDegree = 3;
+
+        /// <summary> The fixed-size grid of height map points used to calculate a single vertex. </summary>
+        using ControlNet = util::BezierSurface::ControlNet<bezierDegree>;
+
+        /// <summary> Appends elements to the element buffer being built and returns their offset in bytes. </summary>
+        using ElementAppender = std::function<GLuint (const void* const, const size_t)>;
+
+        /// <summary> Adds every vertex of the patch beginning at the given X and Z vertex offsets to the given vector. </summary>
+        using PatchGenerator = std::function<void (std::vector<Vertex>&, const unsigned int, const unsigned int)>;
 
         /// <summary>
         /// Contains the index for use in the m_meshTemplates array to obtain the correct element count and offset data.
@@ -108,6 +392,30 @@ class Terrain final
         };
 
         
+        /////////////
+        // Drawing //
+        /////////////
+
+        /// <summary> Draws the base grid of each run of patches, using as few draws as the base template allows. </summary>
+        /// <param name="planner"> Contains the runs of patches to draw. </param>
+        void drawGrids (const PatchDrawPlanner& planner) const;
+
+        /// <summary> Draws every cluster which survived the last cull with a single draw. </summary>
+        void drawClusters() const;
+
+        /// <summary> Draws the stitching of each visible run of patches, or the whole template of each patch in the Lists32 mode. </summary>
+        void drawStitching() const;
+
+        /// <summary> Draws the decimated triangles of every patch far enough away, in place of their base grids. </summary>
+        void drawFarPatches() const;
+
+        /// <summary> Draws every node chosen by the CDLOD quadtree, each whole node or quarter of a node with a single draw. </summary>
+        void drawNodes() const;
+
+        /// <summary> Draws every level of the clipmap with the element template which leaves a hole for the level inside. </summary>
+        void drawLevels() const;
+
+        
         //////////////
         // Creation //
         //////////////
@@ -118,10 +426,42 @@ class Terrain final
         /// <returns> A valid divisor value which won't exceed the terrain dimensions. </returns>
         unsigned int determineDivisor (const unsigned int width, const unsigned int depth) const;
 
+        /// <summary> Determines the order patches are stored in according to the patch layout. </summary>
+        /// <param name="data"> Contains the number of patches on each axis. </param>
+        void determinePatchOrder (const ConstructionData& data);
+
         /// <summary> Allocates enough memory in the GPU for the upscaled terrain according to the data given. </summary>
         /// <param name="data"> Contains the data required to allocate enough memory for the terrain. </param>
         void allocateGPUMemory (const ConstructionData& data);
 
+        /// <summary> 
+        /// Builds the CDLOD quadtree over the finished heights, then replaces the vertices and elements with the grid 
+        /// shared by every node and uploads the heights as a texture.
+        /// </summary>
+        void createLodGrid();
+
+        /// <summary>
+        /// Replaces the vertices and elements with the grid shared by every level of the clipmap and its templates, then
+        /// allocates the heights of every level. The heights are read when the clipmap is first updated.
+        /// </summary>
+        void createClipmapGrid();
+
+        /// <summary>
+        /// Decimates the grid of every patch once the heights are finished, or loads them from the bake file, then appends
+        /// the decimated triangles to the elements so each patch has a mesh to draw at a distance.
+        /// </summary>
+        void decimatePatches();
+
+        /// <summary> Moves the visible patches far enough away for their decimation error to be unnoticeable into their own list. </summary>
+        /// <param name="projectionView"> The projection transform multiplied by the view transform of the camera. </param>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        /// <param name="viewportHeight"> How many pixels tall the view is. </param>
+        void separateFarPatches (const glm::mat4& projectionView, const glm::vec3& cameraPosition, const float viewportHeight);
+
+        /// <summary> Centres the clipmap on the camera and uploads the sections of heights which changed. </summary>
+        /// <param name="cameraPosition"> The world position of the camera. </param>
+        void updateClipmap (const glm::vec3& cameraPosition);
+
 
         //////////////////////
         // Element creation //
@@ -131,6 +471,54 @@ class Terrain final
         /// <param name="data"> The data required to create the correct element data. </param>
         void generateElements (const ConstructionData& data);
 
+        /// <summary> 
+        /// Creates the shared template used to draw the grid of every patch in the compact element modes and the Morton
+        /// layout. The template repeats the grid for consecutive patches so a run of patches can be drawn at once.
+        /// </summary>
+        /// <param name="width"> How many vertices wide the patch is. </param>
+        /// <param name="depth"> How many vertices deep the patch is. </param>
+        /// <param name="patchCount"> The most patches the template should cover, fewer are used if 16-bit indices can't reach them. </param>
+        /// <param name="append"> Adds the elements to the element buffer. </param>
+        void createBaseTemplate (const unsigned int width, const unsigned int depth, const unsigned int patchCount, const ElementAppender& append);
+
+        /// <summary> 
+        /// Creates the triangle strip of a single patch grid. When vertex cache optimisation is enabled the grid is also
+        /// split into bands of columns narrow enough for the cache, which are kept if they miss the cache less often.
+        /// </summary>
+        /// <param name="grid"> Filled with the strip of the grid. </param>
+        /// <param name="width"> How many vertices wide the patch is. </param>
+        /// <param name="depth"> How many vertices deep the patch is. </param>
+        /// <param name="useRestart"> Whether strips are joined with the primitive restart index rather than degenerate triangles. </param>
+        void createStripGrid (std::vector<unsigned int>& grid, const unsigned int width, const unsigned int depth, const bool useRestart);
+
+        /// <summary> 
+        /// Creates the stitching of every patch in the Morton layout. Neighbouring patches aren't a fixed distance apart
+        /// so each patch has its own stitching, stored in patch order using absolute indices. Any run of patches can
+        /// therefore be stitched with one draw.
+        /// </summary>
+        /// <param name="data"> The data required for the stitching to calculate required values for. </param>
+        /// <param name="append"> Adds the elements to the element buffer. </param>
+        void createPatchStitching (const ConstructionData& data, const ElementAppender& append);
+
+        /// <summary> Creates the template of each size of cluster, using 16-bit indices when a cluster is small enough. </summary>
+        /// <param name="data"> Contains the number of patches and their size. </param>
+        /// <param name="append"> Adds the elements to the element buffer. </param>
+        void createClusterTemplates (const ConstructionData& data, const ElementAppender& append);
+
+        /// <summary> Adds the stitching required by a type of patch, indices are relative to the patch in the row-major layout. </summary>
+        /// <param name="elements"> The vector to add the elements to. </param>
+        /// <param name="data"> The data required for the stitching to calculate required values for. </param>
+        /// <param name="mesh"> The type of patch to stitch. </param>
+        void addTemplateStitching (std::vector<unsigned int>& elements, const ConstructionData& data, const MeshTemplate mesh);
+
+        /// <summary> 
+        /// Reorders a triangle list template for the vertex cache if enabled, recording its efficiency in the report. The
+        /// original order is kept if reordering doesn't help, small templates may already fit in the cache.
+        /// </summary>
+        /// <param name="elements"> The triangle list to reorder. </param>
+        /// <param name="name"> The name of the template to use in the report. </param>
+        void optimiseElements (std::vector<unsigned int>& elements, const char* const name);
+
         /// <summary> Calculates the element array required to render an entire patch of terrain. </summary>
         /// <param name="elements"> The vector to add the elements to. </param>
         /// <param name="width"> How many vertices wide the patch is. </param>
@@ -154,20 +542,39 @@ class Terrain final
         /// <param name="data"> The data required to construct the terrain to specific dimensions. </param>
         /// <param name="normal"> The noise parameters to be applied during normal displacement. </param>
         /// <param name="height"> The noise parameters to be applied during height displacement. </param>
-        void generateVertices (const HeightMap& heightMap, const ConstructionData& data, const NoiseArgs& normal, const NoiseArgs& height);
+        void generateVertices (const HeightSource& heightMap, const ConstructionData& data, const NoiseArgs& normal, const NoiseArgs& height);
+
+        /// <summary> Generates the vertices of every patch with the given generator, then applies noise and uploads them. </summary>
+        /// <param name="data"> The data required to construct the terrain to specific dimensions. </param>
+        /// <param name="generator"> Calculates the upscaled vertices of a single patch. </param>
+        /// <param name="normal"> The noise parameters to be applied during normal displacement. </param>
+        /// <param name="height"> The noise parameters to be applied during height displacement. </param>
+        void generatePatches (const ConstructionData& data, const PatchGenerator& generator, const NoiseArgs& normal, const NoiseArgs& height);
         
-        /// <summary> Adds a calculated vertex to the given vector from the U and V values passed. </summary>
-        /// <param name="vector"> The vector to contain the new Vertex. </param>
+        /// <summary> Adds a row of calculated vertices for a terrain patch to the given vector. </summary>
+        /// <param name="vector"> The vector to contain the new vertices. </param>
         /// <param name="heightMap"> The height map containing desired vertex data. </param>
-        /// <param name="u"> A 0 to 1 co-ordinate on the X axis where the vertex should be. </param>
-        /// <param name="v"> A 0 to 1 co-ordinate on the Z axis where the vertex should be. </param>
-        void addVertex (std::vector<Vertex>& vector, const HeightMap& heightMap, const float u, const float v);
+        /// <param name="grid"> Every set of control points contained in the height map. </param>
+        /// <param name="data"> The data required to construct the terrain to specific dimensions. </param>
+        /// <param name="firstX"> The X co-ordinate of the first vertex in the row. </param>
+        /// <param name="z"> The Z co-ordinate of the row. </param>
+        void addRow (std::vector<Vertex>& vector, const HeightSource& heightMap, const ControlNetGrid& grid, const ConstructionData& data, 
+                     const unsigned int firstX, const unsigned int z) const;
 
         /// <summary> Appies Fractional Brownian Motion to the given vertices, moving them along their normal vector. </summary>
         /// <param name="normal"> The normal displacement parameters to be applied first. </param>
         /// <param name="height"> The parameters for height displacement which happens after normal displacement. </param>
         void applyNoise (std::vector<Vertex>& vertices, const NoiseArgs& normal, const NoiseArgs& height);
 
+        /// <summary> Quantises the vertices of a patch relative to its bounds, writing the origin and extent of the bounds to its transform. </summary>
+        /// <param name="vertices"> The full precision vertices of the patch. </param>
+        /// <param name="xOffset"> The X co-ordinate of the first vertex of the patch within the terrain. </param>
+        /// <param name="zOffset"> The Z co-ordinate of the first vertex of the patch within the terrain. </param>
+        /// <param name="output"> Replaced with the quantised vertices in the format the terrain is being built with. </param>
+        /// <param name="transform"> The two texels which receive the origin and extent of the patch. </param>
+        void quantisePatch (const std::vector<Vertex>& vertices, const unsigned int xOffset, const unsigned int zOffset, 
+                            std::vector<uint8_t>& output, glm::vec4* const transform) const;
+
         /// <summary> Calculates the normal vector for each vertex. </summary>
         /// <param name="vertices"> The vector of vertices to calculate normals for. </param>
         /// <param name="data"> The construction data used in the generation of terrain. </param>
@@ -189,13 +596,71 @@ class Terrain final
         /// </summary>
         using MeshTemplates = std::array<Mesh, (size_t) MeshTemplate::Count>;
 
+        /// <summary> The element templates drawn by the levels of the clipmap. </summary>
+        using ClipmapTemplates = std::array<Mesh, GeometryClipmap::templateCount>;
+
+        /// <summary> The vertex cache efficiency of each triangle list template. </summary>
+        using VertexCacheReports = std::vector<VertexCacheReport>;
+
 
         MeshPool                    m_pool          { };        //!< A pool to store the entire generated terrain inside.
         MeshTemplates               m_meshTemplates { };        //!< Each Mesh has the element offset and count required for the four patch types.
-        std::vector<Mesh>           m_patches       { };        //!< A collection of patches which make up the entire terrain.
+        Mesh                        m_baseTemplate  { };        //!< The grid shared by every patch in the compact element modes, empty otherwise.
+        GLenum                      m_basePrimitive { 0 };      //!< Whether the base template is a list or strip of triangles.
+        GLenum                      m_baseIndexType { 0 };      //!< Whether the base template uses 16-bit or 32-bit indices.
+        GLuint                      m_restartIndex  { 0 };      //!< The primitive restart index of the base template, zero if unused.
+        std::vector<GLuint>         m_runCounts     { };        //!< How many elements of the base template draw one patch, two patches and so on.
+        std::vector<Mesh>           m_patches       { };        //!< A collection of patches which make up the entire terrain, in the order they're stored.
+        std::vector<unsigned int>   m_patchOrder    { };        //!< The row-major index of each stored patch.
+        std::vector<unsigned int>   m_visible       { };        //!< The index of every patch to draw, in the order they're drawn.
+        std::vector<unsigned int>   m_near          { };        //!< The visible patches drawn at full resolution when decimated, in the order they're drawn.
+        std::vector<unsigned int>   m_far           { };        //!< The visible patches drawn decimated, in the order they're drawn.
+        PatchSorter                 m_sorter        { };        //!< Sorts the visible patches front to back.
+        PatchDrawPlanner            m_planner       { };        //!< Merges the visible patches into runs each time the terrain is drawn.
+        PatchDrawPlanner            m_nearPlanner   { };        //!< Merges the patches drawn at full resolution into runs when decimated.
+        PatchDecimator              m_decimator     { };        //!< The decimated triangles of every patch, empty unless decimation is enabled.
+        std::vector<Mesh>           m_farPatches    { };        //!< The decimated triangles of each patch in the order they're stored, empty unless drawn.
+        std::vector<uint8_t>        m_elementData   { };        //!< Every element template being built, uploaded once the patches are decimated.
+        PatchBounds                 m_bounds        { };        //!< The bounding box of every patch, including the stitching to its neighbours.
+        PatchQuadtree               m_quadtree      { };        //!< Merges the bounds of neighbouring patches so they can be culled together.
+        HorizonCuller               m_horizon       { };        //!< Removes the patches hidden behind nearer terrain.
+        OcclusionCuller             m_occlusion     { };        //!< Removes the patches hidden behind the nearest patches using a CPU depth buffer.
+        PatchClusters               m_clusters      { };        //!< The culling clusters of every patch, empty unless built with a cluster size.
         std::vector<unsigned int>   m_elements      { };        //!< A copy 
+        HeightPyramid               m_pyramid       { };        //!< The height range of every area of the terrain, one height per vertex.
+        LodQuadtree                 m_lod           { };        //!< Chooses the level of detail of each area in the CDLOD mode.
+        Mesh                        m_lodGrid       { };        //!< The grid drawn by every CDLOD node, stored a quarter at a time.
+        GLuint                      m_heightTexture { 0 };      //!< The height of every vertex, sampled by the grid in the CDLOD mode.
+        GLint                       m_nodeUniform   { -1 };     //!< The location of the first vertex and spacing of the node being drawn.
+        GLint                       m_morphUniform  { -1 };     //!< The location of the morph range of the node being drawn.
+        GLint                       m_cameraUniform { -1 };     //!< The location of the camera position vertices morph by.
+        GeometryClipmap             m_clipmap       { };        //!< The heights of every level drawn in the clipmap mode.
+        ClipmapTemplates            m_clipmapShapes { };        //!< The rings and solid grid drawn by the levels of the clipmap.
+        GLint                       m_levelUniform  { -1 };     //!< The location of the first vertex, spacing and morph width of the level being drawn.
+        GLint                       m_texelUniform  { -1 };     //!< The location of where the heights of the level being drawn are stored.
+        glm::vec2                   m_spacing       { 0.f };    //!< The world distance between two vertices on the X and Z axes.
+        unsigned int                m_patchDivisor  { 0 };      //!< The divisor the current terrain was built with.
+        VertexFormat                m_builtFormat   { VertexFormat::Float };        //!< The vertex format the current terrain was built with.
+        PatchLayout                 m_builtLayout   { PatchLayout::RowMajor };      //!< The patch layout the current terrain was built with.
+        unsigned int                m_builtClusters { 0 };      //!< The cluster size the current terrain was built with.
+        RenderMode                  m_builtMode     { RenderMode::Patches };        //!< The render mode the current terrain was built with.
+        VertexCacheReports          m_cacheReport   { };        //!< The vertex cache efficiency of the templates of the current terrain.
 
         unsigned int                m_divisor       { 256 };    //!< The maximum number of vertices wide/deep of each terrain patch.
+        UpscaleMode                 m_upscaleMode   { UpscaleMode::BezierSurface }; //!< How height maps are upscaled.
+        VertexFormat                m_vertexFormat  { VertexFormat::Float };        //!< How vertices are stored on the GPU.
+        ElementMode                 m_elementMode   { ElementMode::Lists32 };       //!< How the element templates are stored.
+        PatchLayout                 m_patchLayout   { PatchLayout::RowMajor };      //!< The order patches are stored in.
+        bool                        m_optimiseCache { true };   //!< Whether triangle list templates are reordered for the vertex cache.
+        unsigned int                m_clusterSize   { 0 };      //!< How many quads wide and deep each culling cluster is, zero disables clustering.
+        bool                        m_cullHorizon   { false };  //!< Whether patches hidden behind nearer terrain are culled.
+        bool                        m_cullOcclusion { false };  //!< Whether patches hidden behind the nearest patches are culled.
+        bool                        m_sortPatches   { false };  //!< Whether the visible patches are sorted front to back.
+        bool                        m_sortEstimate  { false };  //!< Whether sorting also estimates the overdraw of the visible patches.
+        RenderMode                  m_renderMode    { RenderMode::Patches };        //!< How the terrain is drawn.
+        float                       m_lodPixelError { 2.f };    //!< The largest error in pixels a CDLOD node may show.
+        float                       m_decimateError { 0.f };    //!< The vertical error each patch is decimated to, zero disables decimation.
+        std::string                 m_bakeFile      { };        //!< The file decimated patches are baked to.
 };
 
 #endif
\ No newline at end of file
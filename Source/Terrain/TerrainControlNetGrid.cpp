@@ -0,0 +1,137 @@
+#include "TerrainControlNetGrid.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+
+
+// Personal headers.
+#include <Terrain/HeightSource.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+Terrain::ControlNetGrid::ControlNetGrid (const HeightSource& heightMap)
+{
+    build (heightMap);
+}
+
+
+Terrain::ControlNetGrid::ControlNetGrid (ControlNetGrid&& move)
+{
+    *this = std::move (move);
+}
+
+
+Terrain::ControlNetGrid& Terrain::ControlNetGrid::operator= (ControlNetGrid&& move)
+{
+    if (this != &move)
+    {
+        m_netCountX = move.m_netCountX;
+        m_netCountZ = move.m_netCountZ;
+        m_firstNetZ = move.m_firstNetZ;
+        m_bandRows  = move.m_bandRows;
+        m_nets      = std::move (move.m_nets);
+
+        // Reset primitives.
+        move.m_netCountX = 0;
+        move.m_netCountZ = 0;
+        move.m_firstNetZ = 0;
+        move.m_bandRows  = 0;
+    }
+
+    return *this;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void Terrain::ControlNetGrid::build (const HeightSource& heightMap)
+{
+    buildBand (heightMap, 0.f, (float) (heightMap.getHeight() - 1));
+}
+
+
+void Terrain::ControlNetGrid::buildBand (const HeightSource& heightMap, const float firstZ, const float lastZ)
+{
+    // Each set of control points shares its edges with its neighbours, so a new set begins every "degree" points.
+    const auto netSize = util::Bezier<bezierDegree>::order,
+               netStep = bezierDegree;
+
+    const auto width   = heightMap.getWidth(),
+               maxX    = width - 1,
+               maxZ    = heightMap.getHeight() - 1;
+
+    assert (maxX > 0 && maxZ > 0 && firstZ <= lastZ);
+
+    // Vertices are only ever sampled from 0 up to, but not including, the final point of the height map.
+    m_netCountX = (maxX - 1) / netStep + 1;
+    m_netCountZ = (maxZ - 1) / netStep + 1;
+
+    m_firstNetZ = netZ (firstZ);
+    m_bandRows  = netZ (lastZ) - m_firstNetZ + 1;
+
+    m_nets.resize (m_netCountX * m_bandRows);
+
+    // Read every height the band touches in one go, the final sets of control points may overhang the height map so
+    // clamp them to the edge.
+    const auto firstRow = m_firstNetZ * netStep,
+               lastRow  = std::min ((m_firstNetZ + m_bandRows - 1) * netStep + netSize - 1, maxZ),
+               rowCount = lastRow - firstRow + 1;
+
+    std::vector<float> heights (width * rowCount);
+    heightMap.readElevations (0, firstRow, width, rowCount, heights.data());
+
+    // The X and Z co-ordinates of each point come from its grid position.
+    const auto& scale   = heightMap.getWorldScale();
+    const auto  spacing = glm::vec2 (scale.x / maxX, scale.z / maxZ);
+
+    for (auto z = 0U; z < m_bandRows; ++z)
+    {
+        for (auto x = 0U; x < m_netCountX; ++x)
+        {
+            auto&      net   = m_nets[x + z * m_netCountX];
+
+            const auto baseX = x * netStep,
+                       baseZ = (m_firstNetZ + z) * netStep;
+
+            for (auto j = 0U; j < netSize; ++j)
+            {
+                for (auto i = 0U; i < netSize; ++i)
+                {
+                    const auto pointX = std::min (baseX + i, maxX),
+                               pointZ = std::min (baseZ + j, maxZ);
+
+                    net[i + j * netSize] = { pointX * spacing.x, heights[pointX + (pointZ - firstRow) * width], pointZ * spacing.y };
+                }
+            }
+        }
+    }
+}
+
+
+unsigned int Terrain::ControlNetGrid::netX (const float heightMapX) const
+{
+    return std::min ((unsigned int) heightMapX / bezierDegree, m_netCountX - 1);
+}
+
+
+unsigned int Terrain::ControlNetGrid::netZ (const float heightMapZ) const
+{
+    return std::min ((unsigned int) heightMapZ / bezierDegree, m_netCountZ - 1);
+}
+
+
+const Terrain::ControlNet& Terrain::ControlNetGrid::getNet (const unsigned int netX, const unsigned int netZ) const
+{
+    // Ensure we are accessing valid data.
+    assert (netX < m_netCountX && netZ >= m_firstNetZ && netZ < m_firstNetZ + m_bandRows);
+
+    return m_nets[netX + (netZ - m_firstNetZ) * m_netCountX];
+}
@@ -0,0 +1,87 @@
+#ifndef TERRAIN_CONTROL_NET_GRID_3GP_HPP
+#define TERRAIN_CONTROL_NET_GRID_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Personal headers.
+#include <Terrain/Terrain.hpp>
+
+
+/// <summary>
+/// An indexed grid of the sets of Bezier control points in a height map. The grid is built once per terrain build, or
+/// once per band of rows for height maps which don't fit in memory, which means looking up the control points for a
+/// vertex is a read-only operation that is safe to perform from many threads.
+/// </summary>
+class Terrain::ControlNetGrid final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Constructs the grid of control points from the given height map. </summary>
+        /// <param name="heightMap"> The height map to obtain control points from. </param>
+        ControlNetGrid (const HeightSource& heightMap);
+
+        ControlNetGrid (ControlNetGrid&& move);
+        ControlNetGrid& operator= (ControlNetGrid&& move);
+
+        ControlNetGrid()                                        = default;
+        ControlNetGrid (const ControlNetGrid& copy)             = default;
+        ControlNetGrid& operator= (const ControlNetGrid& copy)  = default;
+        ~ControlNetGrid()                                       = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Rebuilds every set of control points from the given height map. </summary>
+        /// <param name="heightMap"> The height map to obtain control points from. </param>
+        void build (const HeightSource& heightMap);
+
+        /// <summary> Rebuilds only the sets of control points needed between two height map co-ordinates on the Z axis. </summary>
+        /// <param name="heightMap"> The height map to obtain control points from. </param>
+        /// <param name="firstZ"> The first height map co-ordinate on the Z axis which will be sampled. </param>
+        /// <param name="lastZ"> The last height map co-ordinate on the Z axis which will be sampled. </param>
+        void buildBand (const HeightSource& heightMap, const float firstZ, const float lastZ);
+
+        /// <summary> Gets how many sets of control points span the width of the height map. </summary>
+        unsigned int getNetCountX() const   { return m_netCountX; }
+
+        /// <summary> Gets how many sets of control points span the height of the height map. </summary>
+        unsigned int getNetCountZ() const   { return m_netCountZ; }
+
+        /// <summary> Determines which set of control points contains the given height map co-ordinate on the X axis. </summary>
+        /// <param name="heightMapX"> A co-ordinate from 0 to width - 1. </param>
+        unsigned int netX (const float heightMapX) const;
+
+        /// <summary> Determines which set of control points contains the given height map co-ordinate on the Z axis. </summary>
+        /// <param name="heightMapZ"> A co-ordinate from 0 to height - 1. </param>
+        unsigned int netZ (const float heightMapZ) const;
+
+        /// <summary> Gets the set of control points at the given position in the grid, it must be within the built band. </summary>
+        /// <param name="netX"> The index of the net on the X axis. </param>
+        /// <param name="netZ"> The index of the net on the Z axis. </param>
+        const ControlNet& getNet (const unsigned int netX, const unsigned int netZ) const;
+
+    private:
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int            m_netCountX { 0 };  //!< How many sets of control points span the width of the height map.
+        unsigned int            m_netCountZ { 0 };  //!< How many sets of control points span the height of the height map.
+        unsigned int            m_firstNetZ { 0 };  //!< The first row of control points which has been built.
+        unsigned int            m_bandRows  { 0 };  //!< How many rows of control points have been built.
+
+        std::vector<ControlNet> m_nets      { };    //!< The built sets of control points, stored row by row.
+};
+
+
+#endif // TERRAIN_CONTROL_NET_GRID_3GP_HPP
@@ -0,0 +1,174 @@
+#include "TerrainSeparableUpscaler.hpp"
+
+
+// STL headers.
+#include <cassert>
+
+
+// Personal headers.
+#include <Renderer/Vertex.hpp>
+#include <Terrain/HeightSource.hpp>
+#include <Terrain/TerrainConstructionData.hpp>
+#include <Utility/SIMD.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+Terrain::SeparableUpscaler::SeparableUpscaler (const HeightSource& heightMap, const ConstructionData& data, const util::CubicKernel::Type type)
+{
+    const auto sourceWidth = heightMap.getWidth(),
+               sourceDepth = heightMap.getHeight();
+
+    const auto& scale      = heightMap.getWorldScale();
+
+    m_source       = &heightMap;
+    m_divisor      = data.getDivisor();
+
+    m_worldWidth   = scale.x;
+    m_worldDepth   = scale.z;
+    m_spacingX     = scale.x / (sourceWidth - 1);
+    m_spacingZ     = scale.z / (sourceDepth - 1);
+    m_inverseWidth = 1.f / data.getWidth();
+    m_inverseDepth = 1.f / data.getDepth();
+
+    // Every patch shares the same columns and rows so the taps only need calculating once.
+    m_tapsX = util::CubicKernel::buildTaps (type, sourceWidth, data.getWidth());
+    m_tapsZ = util::CubicKernel::buildTaps (type, sourceDepth, data.getDepth());
+}
+
+
+Terrain::SeparableUpscaler::SeparableUpscaler (SeparableUpscaler&& move)
+{
+    *this = std::move (move);
+}
+
+
+Terrain::SeparableUpscaler& Terrain::SeparableUpscaler::operator= (SeparableUpscaler&& move)
+{
+    if (this != &move)
+    {
+        m_source       = move.m_source;
+        m_divisor      = move.m_divisor;
+
+        m_worldWidth   = move.m_worldWidth;
+        m_worldDepth   = move.m_worldDepth;
+        m_spacingX     = move.m_spacingX;
+        m_spacingZ     = move.m_spacingZ;
+        m_inverseWidth = move.m_inverseWidth;
+        m_inverseDepth = move.m_inverseDepth;
+
+        m_tapsX        = std::move (move.m_tapsX);
+        m_tapsZ        = std::move (move.m_tapsZ);
+
+        // Reset primitives.
+        move.m_source       = nullptr;
+        move.m_divisor      = 0;
+        move.m_worldWidth   = 0.f;
+        move.m_worldDepth   = 0.f;
+        move.m_spacingX     = 0.f;
+        move.m_spacingZ     = 0.f;
+        move.m_inverseWidth = 0.f;
+        move.m_inverseDepth = 0.f;
+    }
+
+    return *this;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void Terrain::SeparableUpscaler::addPatch (std::vector<Vertex>& vertices, const unsigned int xOffset, const unsigned int zOffset) const
+{
+    assert (xOffset + m_divisor <= m_tapsX.size() && zOffset + m_divisor <= m_tapsZ.size());
+
+    // Rows are padded to a whole number of SIMD groups so the vertical pass never needs a scalar tail.
+    const auto stride   = (m_divisor + util::simd::width - 1) / util::simd::width * util::simd::width;
+
+    // The patch only touches the heights used by its first and last vertices, and everything in between.
+    const auto firstRow    = m_tapsZ[zOffset].first,
+               rowCount    = m_tapsZ[zOffset + m_divisor - 1].first + 4 - firstRow,
+               firstColumn = m_tapsX[xOffset].first,
+               columnCount = m_tapsX[xOffset + m_divisor - 1].first + 4 - firstColumn;
+
+    std::vector<float> window (rowCount * columnCount);
+    m_source->readElevations (firstColumn, firstRow, columnCount, rowCount, window.data());
+
+    // Horizontal pass: filter each height map row down to the vertex columns of the patch, along with the X slope.
+    std::vector<float> columns (rowCount * stride, 0.f),
+                       slopes (rowCount * stride, 0.f);
+
+    for (auto row = 0U; row < rowCount; ++row)
+    {
+        const auto source = &window[row * columnCount];
+        const auto output = row * stride;
+
+        for (auto i = 0U; i < m_divisor; ++i)
+        {
+            const auto& taps    = m_tapsX[xOffset + i];
+            const auto  samples = source + (taps.first - firstColumn);
+
+            columns[output + i] = samples[0] * taps.weights[0] + samples[1] * taps.weights[1] +
+                                  samples[2] * taps.weights[2] + samples[3] * taps.weights[3];
+
+            slopes[output + i]  = samples[0] * taps.derivatives[0] + samples[1] * taps.derivatives[1] +
+                                  samples[2] * taps.derivatives[2] + samples[3] * taps.derivatives[3];
+        }
+    }
+
+    // Vertical pass: every vertex in a row shares its taps so whole groups of columns can be filtered at once.
+    std::vector<float> heights (stride), slopesX (stride), slopesZ (stride);
+
+    for (auto z = zOffset; z < zOffset + m_divisor; ++z)
+    {
+        const auto& taps = m_tapsZ[z];
+        const auto  row  = taps.first - firstRow;
+
+        util::simd::Float weights[4], derivatives[4];
+
+        for (auto k = 0U; k < 4; ++k)
+        {
+            weights[k]     = util::simd::set (taps.weights[k]);
+            derivatives[k] = util::simd::set (taps.derivatives[k]);
+        }
+
+        for (auto i = 0U; i < stride; i += util::simd::width)
+        {
+            auto height = util::simd::set (0.f),
+                 slopeX = util::simd::set (0.f),
+                 slopeZ = util::simd::set (0.f);
+
+            for (auto k = 0U; k < 4; ++k)
+            {
+                const auto offset = (row + k) * stride + i;
+                const auto column = util::simd::load (&columns[offset]),
+                           slope  = util::simd::load (&slopes[offset]);
+
+                height = util::simd::madd (column, weights[k], height);
+                slopeX = util::simd::madd (slope, weights[k], slopeX);
+                slopeZ = util::simd::madd (column, derivatives[k], slopeZ);
+            }
+
+            util::simd::store (&heights[i], height);
+            util::simd::store (&slopesX[i], slopeX);
+            util::simd::store (&slopesZ[i], slopeZ);
+        }
+
+        // The X and Z co-ordinates come straight from the grid position, matching the Bezier surface upscaler.
+        const auto worldZ = z * m_inverseDepth * m_worldDepth;
+
+        for (auto i = 0U; i < m_divisor; ++i)
+        {
+            const auto worldX = (xOffset + i) * m_inverseWidth * m_worldWidth;
+
+            // The tangents are (spacingX, slopeX, 0) and (0, slopeZ, spacingZ), the normal is their cross product.
+            const auto normal = glm::vec3 (slopesX[i] * m_spacingZ, -m_spacingX * m_spacingZ, m_spacingX * slopesZ[i]);
+
+            vertices.push_back ({ glm::vec3 (worldX, heights[i], worldZ), glm::normalize (normal) });
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef TERRAIN_SEPARABLE_UPSCALER_3GP_HPP
+#define TERRAIN_SEPARABLE_UPSCALER_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Personal headers.
+#include <Terrain/Terrain.hpp>
+#include <Utility/CubicKernel.hpp>
+
+
+/// <summary>
+/// Upscales the heights of a height map with a separable cubic kernel. The X and Z co-ordinates of a height map form a
+/// regular grid so only the heights are filtered, first along each row and then down each column. The X and Z of each
+/// vertex are rebuilt from its grid position afterwards. Each patch only reads the heights it needs from the source.
+/// </summary>
+class Terrain::SeparableUpscaler final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Prepares the heights and kernel taps required to upscale the given height map. </summary>
+        /// <param name="heightMap"> The height map to upscale, it must outlive the upscaler. </param>
+        /// <param name="data"> The dimensions of the upscaled terrain. </param>
+        /// <param name="type"> The reconstruction filter to use. </param>
+        SeparableUpscaler (const HeightSource& heightMap, const ConstructionData& data, const util::CubicKernel::Type type);
+
+        SeparableUpscaler (SeparableUpscaler&& move);
+        SeparableUpscaler& operator= (SeparableUpscaler&& move);
+
+        SeparableUpscaler()                                             = default;
+        SeparableUpscaler (const SeparableUpscaler& copy)               = default;
+        SeparableUpscaler& operator= (const SeparableUpscaler& copy)    = default;
+        ~SeparableUpscaler()                                            = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Adds every vertex of a terrain patch to the given vector, row by row. This is safe to call from many threads. </summary>
+        /// <param name="vertices"> The vector to contain the new vertices. </param>
+        /// <param name="xOffset"> The X co-ordinate of the first vertex of the patch. </param>
+        /// <param name="zOffset"> The Z co-ordinate of the first vertex of the patch. </param>
+        void addPatch (std::vector<Vertex>& vertices, const unsigned int xOffset, const unsigned int zOffset) const;
+
+    private:
+
+        using Taps = std::vector<util::CubicKernel::Taps>;
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        const HeightSource* m_source        { nullptr };    //!< The height map being upscaled, it must outlive the upscaler.
+        unsigned int        m_divisor       { 0 };          //!< How many vertices wide and deep each patch is.
+
+        float               m_worldWidth    { 0.f };        //!< The width of the terrain in world units.
+        float               m_worldDepth    { 0.f };        //!< The depth of the terrain in world units.
+        float               m_spacingX      { 0.f };        //!< The world distance between two heights on the X axis.
+        float               m_spacingZ      { 0.f };        //!< The world distance between two heights on the Z axis.
+        float               m_inverseWidth  { 0.f };        //!< One over the width of the terrain in vertices.
+        float               m_inverseDepth  { 0.f };        //!< One over the depth of the terrain in vertices.
+
+        Taps                m_tapsX         { };            //!< The kernel taps of every vertex column.
+        Taps                m_tapsZ         { };            //!< The kernel taps of every vertex row.
+};
+
+
+#endif // TERRAIN_SEPARABLE_UPSCALER_3GP_HPP
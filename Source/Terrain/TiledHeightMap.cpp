@@ -0,0 +1,451 @@
+#include "TiledHeightMap.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+
+
+namespace
+{
+    /// <summary>
+    /// The header at the start of a tiled height map. It is followed by a 64-bit file offset for every tile, stored row by
+    /// row, and then the tiles themselves. Tiles on the right and top edges are padded by repeating the final height.
+    /// </summary>
+    struct TiledHeader final
+    {
+        char        magic[4];   //!< Always "HTIL".
+        uint32_t    version;    //!< The version of the header, currently 1.
+        uint32_t    format;     //!< The HeightMap::Format of every height.
+        uint32_t    width;      //!< How many heights make up a row.
+        uint32_t    height;     //!< How many rows there are.
+        uint32_t    tileSize;   //!< How many heights wide and deep each tile is.
+    };
+
+    const char      tiledMagic[4] = { 'H', 'T', 'I', 'L' };
+    const uint32_t  tiledVersion  = 1;
+
+
+    /// <summary> 
+    /// Checks a tile size is a power of two no larger than TiledHeightMap::maxTileSize, and that a single tile doesn't
+    /// cover more than the next power of two of the larger dimension of the map.
+    /// </summary>
+    bool isValidTileSize (const uint32_t tileSize, const uint32_t width, const uint32_t height)
+    {
+        if (tileSize == 0 || tileSize > TiledHeightMap::maxTileSize || (tileSize & (tileSize - 1)) != 0)
+        {
+            return false;
+        }
+
+        auto mapSize = 1U;
+
+        while (mapSize < std::max (width, height))
+        {
+            mapSize *= 2;
+        }
+
+        return tileSize <= mapSize;
+    }
+}
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+TiledHeightMap::TiledHeightMap (const std::string& file, const glm::vec3& worldScale, const size_t memoryBudget)
+    : m_memoryBudget (memoryBudget)
+{
+    if (!open (file, worldScale))
+    {
+        throw std::invalid_argument ("TiledHeightMap::TiledHeightMap(), unable to load from the given file location: \"" + file + "\"");
+    }
+}
+
+
+TiledHeightMap::TiledHeightMap (TiledHeightMap&& move)
+{
+    *this = std::move (move);
+}
+
+
+TiledHeightMap& TiledHeightMap::operator= (TiledHeightMap&& move)
+{
+    if (this != &move)
+    {
+        m_width        = move.m_width;
+        m_height       = move.m_height;
+        m_tileSize     = move.m_tileSize;
+        m_tilesX       = move.m_tilesX;
+        m_tilesZ       = move.m_tilesZ;
+        m_worldScale   = move.m_worldScale;
+
+        m_format       = move.m_format;
+        m_sampleScale  = move.m_sampleScale;
+        m_memoryBudget = move.m_memoryBudget;
+        m_offsets      = std::move (move.m_offsets);
+
+        // The mutex stays with its owner, list iterators remain valid when the list itself is moved.
+        m_file         = std::move (move.m_file);
+        m_tiles        = std::move (move.m_tiles);
+        m_recent       = std::move (move.m_recent);
+        m_tileLoads    = move.m_tileLoads;
+
+        // Reset primitives.
+        move.m_width       = 0;
+        move.m_height      = 0;
+        move.m_tileSize    = 0;
+        move.m_tilesX      = 0;
+        move.m_tilesZ      = 0;
+        move.m_sampleScale = 0.f;
+        move.m_tileLoads   = 0;
+    }
+
+    return *this;
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+size_t TiledHeightMap::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    return m_tiles.size() * tileBytes();
+}
+
+
+size_t TiledHeightMap::getTileLoads() const
+{
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    return m_tileLoads;
+}
+
+
+void TiledHeightMap::setMemoryBudget (const size_t memoryBudget)
+{
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    m_memoryBudget = memoryBudget;
+    evict (0);
+}
+
+
+float TiledHeightMap::getElevation (const size_t x, const size_t y) const
+{
+    // Ensure we are accessing valid data.
+    assert (x < m_width && y < m_height);
+
+    const auto tileX = x / m_tileSize,
+               tileZ = y / m_tileSize,
+               localX = x % m_tileSize,
+               localZ = y % m_tileSize;
+
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    return decode (acquireTile (tileX + tileZ * m_tilesX), localX + localZ * m_tileSize);
+}
+
+
+void TiledHeightMap::readElevations (const size_t x, const size_t y, const size_t width, const size_t height, float* const output) const
+{
+    // Ensure we are accessing valid data.
+    assert (x + width <= m_width && y + height <= m_height);
+
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    const auto firstTileX = x / m_tileSize,
+               firstTileZ = y / m_tileSize,
+               lastTileX  = (x + width - 1) / m_tileSize,
+               lastTileZ  = (y + height - 1) / m_tileSize;
+
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    // Visit each tile once so only a single tile needs to be resident at any time.
+    for (auto tileZ = firstTileZ; tileZ <= lastTileZ; ++tileZ)
+    {
+        for (auto tileX = firstTileX; tileX <= lastTileX; ++tileX)
+        {
+            const auto samples = acquireTile (tileX + tileZ * m_tilesX);
+
+            // Find the part of the rectangle which overlaps this tile.
+            const auto tileLeft   = tileX * m_tileSize,
+                       tileBottom = tileZ * m_tileSize;
+
+            const auto left   = std::max (x, tileLeft),
+                       right  = std::min (x + width, tileLeft + m_tileSize),
+                       bottom = std::max (y, tileBottom),
+                       top    = std::min (y + height, tileBottom + m_tileSize);
+
+            for (auto row = bottom; row < top; ++row)
+            {
+                const auto tileRow   = (row - tileBottom) * m_tileSize,
+                           outputRow = (row - y) * width;
+
+                for (auto column = left; column < right; ++column)
+                {
+                    output[outputRow + column - x] = decode (samples, tileRow + column - tileLeft);
+                }
+            }
+        }
+    }
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+bool TiledHeightMap::open (const std::string& file, const glm::vec3& worldScale)
+{
+    // Ensure valid parameters!
+    assert (worldScale.x != 0.f && worldScale.y != 0.f && worldScale.z != 0.f);
+
+    std::ifstream input { file, std::ios::binary | std::ios::ate };
+
+    const auto fileSize = (uint64_t) std::max ((std::streamoff) input.tellg(), (std::streamoff) 0);
+    input.seekg (0);
+
+    TiledHeader header { };
+
+    // The header is untrusted, the width and height must also be divisible by four for the height map to be valid. The
+    // dimensions and tile size are capped so the tile counts and sizes below can't wrap around.
+    if (!input.read ((char*) &header, sizeof (TiledHeader)) || !std::equal (tiledMagic, tiledMagic + 4, header.magic) ||
+        header.version != tiledVersion || header.format > (uint32_t) HeightMap::Format::Float ||
+        header.width < 4 || header.height < 4 || header.width % 4 != 0 || header.height % 4 != 0 ||
+        header.width > maxDimension || header.height > maxDimension || !isValidTileSize (header.tileSize, header.width, header.height))
+    {
+        return false;
+    }
+
+    const auto tilesX     = (header.width + header.tileSize - 1) / header.tileSize,
+               tilesZ     = (header.height + header.tileSize - 1) / header.tileSize;
+    const auto sampleSize = header.format == (uint32_t) HeightMap::Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
+    const auto tileSize   = (uint64_t) header.tileSize * header.tileSize * sampleSize,
+               tableSize  = (uint64_t) tilesX * tilesZ * sizeof (uint64_t);
+
+    // The offset table must be in the file before we make room for it.
+    if (sizeof (TiledHeader) + tableSize > fileSize)
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> offsets ((size_t) tilesX * tilesZ);
+
+    if (!input.read ((char*) offsets.data(), offsets.size() * sizeof (uint64_t)))
+    {
+        return false;
+    }
+
+    // Every tile must be in the file too, so reading one later can't fail.
+    for (const auto offset : offsets)
+    {
+        if (offset < sizeof (TiledHeader) + tableSize || offset > fileSize || fileSize - offset < tileSize)
+        {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    m_width       = header.width;
+    m_height      = header.height;
+    m_tileSize    = header.tileSize;
+    m_tilesX      = tilesX;
+    m_tilesZ      = tilesZ;
+    m_worldScale  = worldScale;
+    m_format      = (HeightMap::Format) header.format;
+    m_sampleScale = m_format == HeightMap::Format::UInt16 ? worldScale.y / std::numeric_limits<uint16_t>::max() : worldScale.y;
+    m_offsets     = std::move (offsets);
+
+    m_file        = std::move (input);
+    m_tiles.clear();
+    m_recent.clear();
+    m_tileLoads   = 0;
+
+    return true;
+}
+
+
+bool TiledHeightMap::convert (const HeightSource& source, const std::string& file, const unsigned int tileSize, const HeightMap::Format format)
+{
+    const auto width      = source.getWidth(),
+               height     = source.getHeight();
+
+    // Only write files which open() would accept.
+    if (width > maxDimension || height > maxDimension || !isValidTileSize (tileSize, width, height))
+    {
+        return false;
+    }
+
+    std::ofstream output { file, std::ios::binary };
+
+    if (!output)
+    {
+        return false;
+    }
+
+    const auto tilesX     = (width + tileSize - 1) / tileSize,
+               tilesZ     = (height + tileSize - 1) / tileSize;
+
+    const auto sampleSize = format == HeightMap::Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
+    const auto tileBytes  = (size_t) tileSize * tileSize * sampleSize;
+    const auto maxHeight  = source.getWorldScale().y;
+
+    TiledHeader header { };
+
+    std::copy (tiledMagic, tiledMagic + 4, header.magic);
+    header.version  = tiledVersion;
+    header.format   = (uint32_t) format;
+    header.width    = width;
+    header.height   = height;
+    header.tileSize = tileSize;
+
+    // Every tile is the same size so the index is simple, keeping it allows tiles to be reordered or compressed later.
+    std::vector<uint64_t> offsets (tilesX * tilesZ);
+
+    const auto firstTile = (uint64_t) sizeof (TiledHeader) + offsets.size() * sizeof (uint64_t);
+
+    for (auto i = 0U; i < offsets.size(); ++i)
+    {
+        offsets[i] = firstTile + i * tileBytes;
+    }
+
+    output.write ((const char*) &header, sizeof (TiledHeader));
+    output.write ((const char*) offsets.data(), offsets.size() * sizeof (uint64_t));
+
+    std::vector<float>   heights (tileSize * tileSize);
+    std::vector<uint8_t> samples (tileBytes);
+
+    for (auto tileZ = 0U; tileZ < tilesZ; ++tileZ)
+    {
+        for (auto tileX = 0U; tileX < tilesX; ++tileX)
+        {
+            const auto left    = tileX * tileSize,
+                       bottom  = tileZ * tileSize,
+                       columns = std::min (tileSize, width - left),
+                       rows    = std::min (tileSize, height - bottom);
+
+            source.readElevations (left, bottom, columns, rows, heights.data());
+
+            for (auto z = 0U; z < tileSize; ++z)
+            {
+                for (auto x = 0U; x < tileSize; ++x)
+                {
+                    // Pad the edge tiles by repeating the final height.
+                    const auto elevation   = heights[std::min (x, columns - 1) + std::min (z, rows - 1) * columns];
+                    const auto normalised  = elevation / maxHeight;
+                    const auto destination = samples.data() + (x + z * tileSize) * sampleSize;
+
+                    if (format == HeightMap::Format::UInt16)
+                    {
+                        const auto clamped = std::min (std::max (normalised, 0.f), 1.f);
+                        const auto sample  = (uint16_t) std::lround (clamped * std::numeric_limits<uint16_t>::max());
+
+                        std::memcpy (destination, &sample, sizeof (sample));
+                    }
+
+                    else
+                    {
+                        std::memcpy (destination, &normalised, sizeof (normalised));
+                    }
+                }
+            }
+
+            output.write ((const char*) samples.data(), samples.size());
+        }
+    }
+
+    return (bool) output;
+}
+
+
+/////////////
+// Caching //
+/////////////
+
+const uint8_t* TiledHeightMap::acquireTile (const size_t index) const
+{
+    assert (index < m_offsets.size());
+
+    // Move resident tiles to the front of the recently used list.
+    const auto resident = m_tiles.find (index);
+
+    if (resident != m_tiles.end())
+    {
+        m_recent.splice (m_recent.begin(), m_recent, resident->second.recent);
+        return resident->second.samples.data();
+    }
+
+    // Make room before reading so we never exceed the budget.
+    const auto bytes = tileBytes();
+    evict (bytes);
+
+    Tile tile { };
+    tile.samples.resize (bytes);
+
+    m_file.clear();
+    m_file.seekg ((std::streamoff) m_offsets[index]);
+
+    if (!m_file.read ((char*) tile.samples.data(), bytes))
+    {
+        throw std::runtime_error ("TiledHeightMap::acquireTile(), unable to read a tile, the file may be truncated.");
+    }
+
+    ++m_tileLoads;
+
+    m_recent.push_front (index);
+    tile.recent = m_recent.begin();
+
+    return m_tiles.emplace (index, std::move (tile)).first->second.samples.data();
+}
+
+
+void TiledHeightMap::evict (const size_t bytes) const
+{
+    const auto size = tileBytes();
+
+    // Callers never hold on to a tile whilst acquiring another so every tile can be evicted.
+    while (!m_tiles.empty() && m_tiles.size() * size + bytes > m_memoryBudget)
+    {
+        m_tiles.erase (m_recent.back());
+        m_recent.pop_back();
+    }
+}
+
+
+float TiledHeightMap::decode (const uint8_t* const samples, const size_t index) const
+{
+    // memcpy avoids alignment and aliasing issues and compiles down to a single load.
+    if (m_format == HeightMap::Format::UInt16)
+    {
+        uint16_t sample { 0 };
+        std::memcpy (&sample, samples + index * sizeof (uint16_t), sizeof (uint16_t));
+
+        return sample * m_sampleScale;
+    }
+
+    float sample { 0.f };
+    std::memcpy (&sample, samples + index * sizeof (float), sizeof (float));
+
+    return sample * m_sampleScale;
+}
+
+
+size_t TiledHeightMap::tileBytes() const
+{
+    const auto sampleSize = m_format == HeightMap::Format::UInt16 ? sizeof (uint16_t) : sizeof (float);
+
+    return (size_t) m_tileSize * m_tileSize * sampleSize;
+}
@@ -0,0 +1,166 @@
+#ifndef TILED_HEIGHT_MAP_3GP_HPP
+#define TILED_HEIGHT_MAP_3GP_HPP
+
+
+// STL headers.
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Personal headers.
+#include <Terrain/HeightMap.hpp>
+#include <Terrain/HeightSource.hpp>
+
+
+/// <summary>
+/// An out-of-core height map stored as fixed-size square tiles in a single indexed file. Tiles are read on demand and
+/// kept in a least-recently-used cache which never exceeds the memory budget, this allows terrain to be built from
+/// sources much larger than physical memory. Access is serialised internally so it is safe to share between threads.
+/// </summary>
+class TiledHeightMap final : public HeightSource
+{
+    public:
+
+        /// <summary> The memory budget used when none is specified, 256MiB. </summary>
+        static const size_t defaultBudget = 256 * 1024 * 1024;
+
+        /// <summary> The tile size used when converting when none is specified. </summary>
+        static const unsigned int defaultTileSize = 256;
+
+        /// <summary> The largest tile size allowed, tiles must also be a power of two. </summary>
+        static const unsigned int maxTileSize = 4096;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Opens a tiled height map file, throwing std::invalid_argument if it is invalid. </summary>
+        /// <param name="file"> The location of the tiled height map. </param>
+        /// <param name="worldScale"> The dimensions of the final terrain. </param>
+        /// <param name="memoryBudget"> The maximum number of bytes of tiles to keep in memory at once. </param>
+        TiledHeightMap (const std::string& file, const glm::vec3& worldScale, const size_t memoryBudget = defaultBudget);
+
+        /// <summary> Moving isn't thread-safe, ensure nothing is reading from either height map. </summary>
+        TiledHeightMap (TiledHeightMap&& move);
+        TiledHeightMap& operator= (TiledHeightMap&& move);
+        ~TiledHeightMap() override                              = default;
+
+        TiledHeightMap (const TiledHeightMap& copy)             = delete;
+        TiledHeightMap& operator= (const TiledHeightMap& copy)  = delete;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the width of the height map data. </summary>
+        unsigned int getWidth() const override          { return m_width; }
+
+        /// <summary> Gets the height of the height map data. </summary>
+        unsigned int getHeight() const override         { return m_height; }
+
+        /// <summary> Gets the world scale of the height map. </summary>
+        const glm::vec3& getWorldScale() const override { return m_worldScale; }
+
+        /// <summary> Gets how many heights wide and deep each tile is. </summary>
+        unsigned int getTileSize() const                { return m_tileSize; }
+
+        /// <summary> Gets the maximum number of bytes of tiles kept in memory. </summary>
+        size_t getMemoryBudget() const                  { return m_memoryBudget; }
+
+        /// <summary> Gets how many bytes of tiles are currently in memory. </summary>
+        size_t getResidentBytes() const;
+
+        /// <summary> Gets how many times a tile has been read from disk. </summary>
+        size_t getTileLoads() const;
+
+        /// <summary> Changes the memory budget, evicting tiles immediately. A single tile is still loaded if the budget is smaller. </summary>
+        /// <param name="memoryBudget"> The maximum number of bytes of tiles to keep in memory at once. </param>
+        void setMemoryBudget (const size_t memoryBudget);
+
+        /// <summary> Gets the height in world units at the given co-ordinates. </summary>
+        float getElevation (const size_t x, const size_t y) const override;
+
+        /// <summary> Copies a rectangle of heights in world units into the given array, one tile at a time. </summary>
+        void readElevations (const size_t x, const size_t y, const size_t width, const size_t height, float* const output) const override;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Opens a tiled height map file. If the file is invalid no data will be lost. </summary>
+        /// <param name="file"> The location of the tiled height map. </param>
+        /// <param name="worldScale"> The dimensions of the final terrain. </param>
+        /// <returns> Whether the file could be opened. </returns>
+        bool open (const std::string& file, const glm::vec3& worldScale);
+
+        /// <summary> Writes any height source to a tiled height map file, reading one tile at a time. </summary>
+        /// <param name="source"> The heights to write. </param>
+        /// <param name="file"> The location to write to. </param>
+        /// <param name="tileSize"> How many heights wide and deep each tile should be, a power of two up to maxTileSize. </param>
+        /// <param name="format"> How each height should be stored. </param>
+        /// <returns> Whether the file was written successfully, false if the tile size or source dimensions aren't supported. </returns>
+        static bool convert (const HeightSource& source, const std::string& file, const unsigned int tileSize = defaultTileSize,
+                             const HeightMap::Format format = HeightMap::Format::UInt16);
+
+    private:
+
+        /// <summary> A tile which is currently in memory. </summary>
+        struct Tile final
+        {
+            std::vector<uint8_t>        samples     { };    //!< Every height of the tile, row by row.
+            std::list<size_t>::iterator recent      { };    //!< The position of the tile in the recently used list.
+        };
+
+
+        /// <summary> Obtains the samples of a tile, reading it from disk if necessary. The mutex must be held. </summary>
+        /// <param name="index"> The index of the tile. </param>
+        const uint8_t* acquireTile (const size_t index) const;
+
+        /// <summary> Evicts the least recently used tiles until the given number of bytes can be added. The mutex must be held. </summary>
+        /// <param name="bytes"> How many bytes are about to be added to the cache. </param>
+        void evict (const size_t bytes) const;
+
+        /// <summary> Converts a stored height into world units. </summary>
+        /// <param name="samples"> The samples of the tile containing the height. </param>
+        /// <param name="index"> The index of the height within the tile. </param>
+        float decode (const uint8_t* const samples, const size_t index) const;
+
+        /// <summary> Gets how many bytes a single tile occupies. </summary>
+        size_t tileBytes() const;
+
+
+        using TileCache = std::unordered_map<size_t, Tile>;
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int                m_width         { 0 };                          //!< How many heights make up a row.
+        unsigned int                m_height        { 0 };                          //!< How many rows of heights there are.
+        unsigned int                m_tileSize      { 0 };                          //!< How many heights wide and deep each tile is.
+        unsigned int                m_tilesX        { 0 };                          //!< How many tiles span the width.
+        unsigned int                m_tilesZ        { 0 };                          //!< How many tiles span the height.
+        glm::vec3                   m_worldScale    { 0 };                          //!< The scale of the height map in world units.
+
+        HeightMap::Format           m_format        { HeightMap::Format::UInt16 };  //!< How each height is stored.
+        float                       m_sampleScale   { 0.f };                        //!< Converts a stored height into world units.
+        size_t                      m_memoryBudget  { defaultBudget };              //!< The maximum number of bytes of tiles to keep.
+        std::vector<uint64_t>       m_offsets       { };                            //!< Where each tile begins in the file.
+
+        mutable std::mutex          m_mutex         { };                            //!< Serialises access to the file and cache.
+        mutable std::ifstream       m_file          { };                            //!< The file tiles are read from.
+        mutable TileCache           m_tiles         { };                            //!< Every tile currently in memory.
+        mutable std::list<size_t>   m_recent        { };                            //!< Tile indices, most recently used first.
+        mutable size_t              m_tileLoads     { 0 };                          //!< How many times a tile has been read.
+};
+
+
+#endif // TILED_HEIGHT_MAP_3GP_HPP
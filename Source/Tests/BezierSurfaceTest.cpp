@@ -0,0 +1,143 @@
+// STL headers.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+// Personal headers.
+#include <Utility/BezierSurface.hpp>
+#include <Utility/SIMD.hpp>
+
+
+// Compares both outputs of BezierSurface::calculateRow() against the scalar BezierSurface::calculatePoint() for every
+// supported degree. Row lengths run past several SIMD groups so that every partial tail is written as well.
+namespace
+{
+    // The SIMD and scalar paths use different operation orders so they only need to agree within floating point error.
+    const float positionTolerance = 1e-4f;  //!< The largest error allowed in a position, relative to its size.
+    const float normalTolerance   = 1e-3f;  //!< The largest error allowed in each component of a unit normal.
+
+    /// <summary> Checks whether every component of two vectors is within the given distance of each other. </summary>
+    bool isClose (const glm::vec3& lhs, const glm::vec3& rhs, const float tolerance)
+    {
+        return std::abs (lhs.x - rhs.x) <= tolerance && std::abs (lhs.y - rhs.y) <= tolerance && std::abs (lhs.z - rhs.z) <= tolerance;
+    }
+
+
+    /// <summary> Compares a calculated point against the scalar path, reporting it if they differ. </summary>
+    /// <returns> Whether the point matches. </returns>
+    template <unsigned int Degree>
+    bool checkPoint (const util::BezierSurface::ControlNet<Degree>& controlPoints, const float u, const float v,
+                     const glm::vec3& position, const glm::vec3& normal, const char* const output)
+    {
+        const auto expected  = util::BezierSurface::calculatePoint<Degree> (controlPoints, u, v);
+
+        // Positions are compared relative to their size, normals are unit length so an absolute error will do.
+        const auto magnitude = std::max (std::max (std::abs (expected.position.x), std::abs (expected.position.y)),
+                                         std::max (std::abs (expected.position.z), 1.f));
+
+        if (isClose (position, expected.position, magnitude * positionTolerance) && isClose (normal, expected.normal, normalTolerance))
+        {
+            return true;
+        }
+
+        std::cerr << "Degree " << Degree << " " << output << " output differs at u = " << u << ", v = " << v << std::endl;
+        return false;
+    }
+
+
+    /// <summary> Evaluates random surfaces of the given degree with every row length up to a few SIMD groups. </summary>
+    /// <returns> How many points differed from the scalar path. </returns>
+    template <unsigned int Degree>
+    size_t testDegree (std::mt19937& generator)
+    {
+        std::uniform_real_distribution<float> jitter (-5.f, 5.f), height (-100.f, 100.f), parameter (0.f, 1.f);
+
+        const auto maxCount = (size_t) util::simd::width * 3 + 1;
+        const auto surfaces = 64U;
+        const auto spacing  = 10.f;
+        size_t     failures = 0;
+
+        std::vector<float>  u (maxCount), streams[6];
+        std::vector<Vertex> vertices (maxCount);
+
+        for (auto& stream : streams)
+        {
+            stream.resize (maxCount);
+        }
+
+        util::BezierSurface::SurfaceStreams output { };
+        output.positionX = streams[0].data();
+        output.positionY = streams[1].data();
+        output.positionZ = streams[2].data();
+        output.normalX   = streams[3].data();
+        output.normalY   = streams[4].data();
+        output.normalZ   = streams[5].data();
+
+        for (auto surface = 0U; surface < surfaces; ++surface)
+        {
+            // Control points sit on a jittered grid like those built from a height map.
+            util::BezierSurface::ControlNet<Degree> controlPoints { };
+
+            for (auto z = 0U; z <= Degree; ++z)
+            {
+                for (auto x = 0U; x <= Degree; ++x)
+                {
+                    controlPoints[x + z * (Degree + 1)] = glm::vec3 (x * spacing + jitter (generator), height (generator),
+                                                                     -(z * spacing + jitter (generator)));
+                }
+            }
+
+            // Every length, including those which leave a partial group at the end of the row.
+            for (size_t count = 1; count <= maxCount; ++count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    u[i] = count > 1 ? (float) i / (count - 1) : parameter (generator);
+                }
+
+                const auto v = surface % 8 == 0 ? (float) (surface / 8 % 2) : parameter (generator);
+
+                util::BezierSurface::calculateRow<Degree> (controlPoints, u.data(), v, count, vertices.data());
+                util::BezierSurface::calculateRow<Degree> (controlPoints, u.data(), v, count, output);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (!checkPoint<Degree> (controlPoints, u[i], v, vertices[i].position, vertices[i].normal, "interleaved"))
+                    {
+                        ++failures;
+                    }
+
+                    if (!checkPoint<Degree> (controlPoints, u[i], v, { streams[0][i], streams[1][i], streams[2][i] },
+                                             { streams[3][i], streams[4][i], streams[5][i] }, "stream"))
+                    {
+                        ++failures;
+                    }
+                }
+            }
+        }
+
+        return failures;
+    }
+}
+
+
+int main()
+{
+    // A fixed seed keeps any failure reproducible.
+    std::mt19937 generator { 1U };
+
+    const auto failures = testDegree<2> (generator) + testDegree<3> (generator);
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " points differ from BezierSurface::calculatePoint()" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "BezierSurface::calculateRow() matches BezierSurface::calculatePoint() with " << util::simd::width << " lanes" << std::endl;
+    return EXIT_SUCCESS;
+}
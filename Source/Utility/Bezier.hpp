@@ -0,0 +1,166 @@
+#ifndef UTILITY_BEZIER_3GP_HPP
+#define UTILITY_BEZIER_3GP_HPP
+
+
+// STL headers.
+#include <array>
+
+
+namespace util
+{
+    /// <summary>
+    /// A static class containing Bezier curve calculation functionality for a curve of the given degree. The Bernstein
+    /// polynominals are constexpr so when the degree and index are known the compiler can fold and unroll everything.
+    /// </summary>
+    template <unsigned int Degree> class Bezier final
+    {
+        public:
+
+            static_assert (Degree > 0, "Bezier curves must have a degree of at least one.");
+
+            /// <summary> How many control points make up a single curve of this degree. </summary>
+            static const unsigned int order = Degree + 1;
+
+            /// <summary> A fixed-size grid of order * order control points, used in the construction of Bezier surfaces. </summary>
+            template <typename T> using ControlNet = std::array<T, order * order>;
+
+            /// <summary> The Bernstein polynominal for every index at a single delta value. </summary>
+            template <typename T> using Weights = std::array<T, order>;
+
+            /// <summary>
+            /// An enumeration to represent which derivative is desired from a curve point on the path.
+            /// </summary>
+            enum class Derivative : int
+            {
+                None    = 0,    //!< Provides a position.
+                First   = 1     //!< Provides the tangent.
+            };
+
+            /// <summary> Obtain the Bernstein polynominal for the given index and delta value. </summary>
+            /// <param name="index"> An index from 0 - Degree, this indicates the polynominal desired. </param>
+            /// <param name="delta"> The delta value from 0 - 1 which acts as an interpolation factor. </param>
+            /// <param name="derivative"> Which polynominal derivative would you like? This effects how it can be used. </param>
+            /// <returns> The calculated polynominal. </returns>
+            template <typename T> constexpr static T bernstein (const unsigned int index, const T delta, const Derivative derivative = Derivative::None);
+
+            /// <summary> Obtains the Bernstein polynominal used in calculating positions on Bezier curves. </summary>
+            template <typename T> constexpr static T bernsteinPosition (const unsigned int index, const T delta);
+
+            /// <summary> Obtains the Bernstein polynominal used in calculating tangents on Bezier curves. </summary>
+            template <typename T> constexpr static T bernsteinTangent (const unsigned int index, const T delta);
+
+            /// <summary> Calculates the position polynominal of every index for the given delta value. </summary>
+            /// <param name="delta"> The delta value from 0 - 1 which acts as an interpolation factor. </param>
+            template <typename T> static Weights<T> positionWeights (const T delta);
+
+            /// <summary> Calculates the tangent polynominal of every index for the given delta value. </summary>
+            /// <param name="delta"> The delta value from 0 - 1 which acts as an interpolation factor. </param>
+            template <typename T> static Weights<T> tangentWeights (const T delta);
+
+            /// <summary> Calculates the binomial coefficient "n choose k". </summary>
+            constexpr static unsigned int binomial (const unsigned int n, const unsigned int k);
+
+        private:
+
+            /// <summary> Raises the value to a whole number exponent without touching std::pow. </summary>
+            template <typename T> constexpr static T power (const T value, const unsigned int exponent);
+
+            /// <summary> The Bernstein basis polynominal Bi,n(u) == (n choose i) * u^i * (1-u)^(n-i) for any degree. </summary>
+            template <typename T> constexpr static T basis (const unsigned int degree, const unsigned int index, const T delta);
+    };
+
+
+    // Aliases bro!
+    using QuadraticBezier = Bezier<2>;
+    using CubicBezier     = Bezier<3>;
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    constexpr T Bezier<Degree>::bernstein (const unsigned int index, const T delta, const Derivative derivative)
+    {
+        // Forward the data to the correct function.
+        return derivative == Derivative::First ? bernsteinTangent (index, delta) : bernsteinPosition (index, delta);
+    }
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    constexpr T Bezier<Degree>::bernsteinPosition (const unsigned int index, const T delta)
+    {
+        // Cubic:       B0,3 == (1-u)^3,  B1,3 == 3u(1-u)^2,  B2,3 == 3u^2 * (1-u),  B3,3 == u^3.
+        // Quadratic:   B0,2 == (1-u)^2,  B1,2 == 2u * (1-u), B2,2 == u^2.
+        return basis (Degree, index, delta);
+    }
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    constexpr T Bezier<Degree>::bernsteinTangent (const unsigned int index, const T delta)
+    {
+        // The derivative of any Bernstein polynominal is: B'i,n == n * (Bi-1,n-1 - Bi,n-1).
+        // Cubic:       B'0,3 == -3(1-u)^2,  B'1,3 == 3(1-u)^2 - 6u(1-u),  B'2,3 == 6u(1-u) - 3u^2,  B'3,3 == 3u^2.
+        // Quadratic:   B'0,2 == -2(1-u),    B'1,2 == 2-4u,                B'2,2 == 2u.
+        return (T) Degree * ((index > 0 ? basis (Degree - 1, index - 1, delta) : (T) 0) - basis (Degree - 1, index, delta));
+    }
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    typename Bezier<Degree>::template Weights<T> Bezier<Degree>::positionWeights (const T delta)
+    {
+        // The loop bound is a compile-time constant so this will be unrolled.
+        Weights<T> weights { };
+
+        for (auto i = 0U; i < order; ++i)
+        {
+            weights[i] = bernsteinPosition (i, delta);
+        }
+
+        return weights;
+    }
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    typename Bezier<Degree>::template Weights<T> Bezier<Degree>::tangentWeights (const T delta)
+    {
+        Weights<T> weights { };
+
+        for (auto i = 0U; i < order; ++i)
+        {
+            weights[i] = bernsteinTangent (i, delta);
+        }
+
+        return weights;
+    }
+
+
+    template <unsigned int Degree>
+    constexpr unsigned int Bezier<Degree>::binomial (const unsigned int n, const unsigned int k)
+    {
+        // (n choose k) == (n choose k-1) * (n-k+1) / k, the division is always exact.
+        return k == 0 ? 1 : binomial (n, k - 1) * (n - k + 1) / k;
+    }
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    constexpr T Bezier<Degree>::power (const T value, const unsigned int exponent)
+    {
+        return exponent == 0 ? (T) 1 : value * power (value, exponent - 1);
+    }
+
+
+    template <unsigned int Degree>
+    template <typename T>
+    constexpr T Bezier<Degree>::basis (const unsigned int degree, const unsigned int index, const T delta)
+    {
+        // Indices beyond the degree don't exist so they have no influence.
+        return index > degree ? (T) 0 :
+               (T) binomial (degree, index) * power (delta, index) * power ((T) 1 - delta, degree - index);
+    }
+}
+
+
+#endif // UTILITY_BEZIER_3GP_HPP
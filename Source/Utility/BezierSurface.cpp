@@ -1,59 +1,234 @@
 #include "BezierSurface.hpp"
 
 
+// STL headers.
+#include <algorithm>
+
+
 // Personal headers.
-#include <Utility/CubicBezier.hpp>
-#include <Utility/QuadraticBezier.hpp>
+#include <Utility/SIMD.hpp>
 
 
 
 namespace util
 {
-    Vertex BezierSurface::calculatePoint (const std::vector<glm::vec3>& controlPoints, const float u, const float v, const BezierAlgorithm mode)
+    namespace
     {
-        // We must have a valid sized grid.
-        const auto width  = (unsigned int) mode,
-                   height = (unsigned int) mode;
-
-        assert (controlPoints.size() == width * height);
+        /// <summary> A group of SIMD lanes, each containing a single component of a position or normal. </summary>
+        struct LaneGroup final
+        {
+            simd::Float positionX, positionY, positionZ,
+                        normalX, normalY, normalZ;
+        };
 
-        // We need to accumlate the position and two partial differentiated tangent vectors to calculate the final vertex.
-        glm::vec3 position { 0 },
-                  partialU { 0 },
-                  partialV { 0 };
 
-        // We need to loop through the control points calculating Bernstein polynominals.
-        for (auto j = 0U; j < height; ++j)
+        /// <summary>
+        /// Evaluates a row of points on a Bezier surface as many at a time as the SIMD width allows. The resulting groups
+        /// of lanes are handed to the given writer along with the index of the first point and how many lanes are valid.
+        /// </summary>
+        template <unsigned int Degree, typename Writer>
+        void evaluateRow (const BezierSurface::ControlNet<Degree>& controlPoints, const float* const u, const float v,
+                          const size_t count, const Writer& write)
         {
-            for (auto i = 0U; i < width; ++i)
+            const auto order = Bezier<Degree>::order;
+
+            // Every point shares the V co-ordinate so collapse the grid along the Z axis first. This leaves a single curve
+            // of positions and a single curve of V tangents which only need to be weighted by the U polynominals.
+            const auto bernsteinPositionV = Bezier<Degree>::positionWeights (v),
+                       bernsteinTangentV  = Bezier<Degree>::tangentWeights (v);
+
+            simd::Float curveX[order], curveY[order], curveZ[order],
+                        tangentX[order], tangentY[order], tangentZ[order];
+
+            for (auto i = 0U; i < order; ++i)
             {
-                // Obtain the control point we're currently using.
-                const auto& point = controlPoints[i + j * width];
-                
-                /*// Calculate the Bernstein polynominals required.
-                const auto  bernsteinPositionI = QuadraticBezier::bernstein (i, u),
-                            bernsteinPositionJ = QuadraticBezier::bernstein (j, v),
-                            bernsteinTangentI  = QuadraticBezier::bernstein (i, u, QuadraticBezier::Derivative::First),
-                            bernsteinTangentJ  = QuadraticBezier::bernstein (j, v, QuadraticBezier::Derivative::First);*/
-
-                // Calculate the Bernstein polynominals required.
-                const auto  bernsteinPositionI = CubicBezier::bernstein (i, u),
-                            bernsteinPositionJ = CubicBezier::bernstein (j, v),
-                            bernsteinTangentI  = CubicBezier::bernstein (i, u, CubicBezier::Derivative::First),
-                            bernsteinTangentJ  = CubicBezier::bernstein (j, v, CubicBezier::Derivative::First);
-                                    
-                // The formula for position is: += (Pij * Bi(u) * Bj(v)).
-                position += point * bernsteinPositionI * bernsteinPositionJ;
-           
-                // The partial derivative of u is: += (Pij * B'i(u) * Bj(v)).
-                partialU += point * bernsteinTangentI * bernsteinPositionJ;
-
-                // The partial derivative of v is: += (Pij * Bi(u) * B'j(v)).
-                partialV += point * bernsteinPositionI * bernsteinTangentJ;
+                glm::vec3 curve { 0 }, tangent { 0 };
+
+                for (auto j = 0U; j < order; ++j)
+                {
+                    const auto& point = controlPoints[i + j * order];
+
+                    curve   += point * bernsteinPositionV[j];
+                    tangent += point * bernsteinTangentV[j];
+                }
+
+                // Broadcast each component ready for the SIMD loop.
+                curveX[i]   = simd::set (curve.x);
+                curveY[i]   = simd::set (curve.y);
+                curveZ[i]   = simd::set (curve.z);
+                tangentX[i] = simd::set (tangent.x);
+                tangentY[i] = simd::set (tangent.y);
+                tangentZ[i] = simd::set (tangent.z);
+            }
+
+            const auto zero   = simd::set (0.f),
+                       one    = simd::set (1.f),
+                       degree = simd::set ((float) Degree);
+
+            for (size_t first = 0; first < count; first += simd::width)
+            {
+                const auto lanes = std::min ((size_t) simd::width, count - first);
+
+                // The final group may not fill every lane so pad it by repeating the last U value.
+                simd::Float delta;
+
+                if (lanes == simd::width)
+                {
+                    delta = simd::load (u + first);
+                }
+
+                else
+                {
+                    float padded[simd::width];
+
+                    for (size_t lane = 0; lane < simd::width; ++lane)
+                    {
+                        padded[lane] = u[first + std::min (lane, lanes - 1)];
+                    }
+
+                    delta = simd::load (padded);
+                }
+
+                // Build u^k and (1-u)^k once, every Bernstein polynominal is a product of the two.
+                simd::Float powerU[order], powerInverse[order];
+
+                powerU[0]       = one;
+                powerInverse[0] = one;
+
+                const auto inverse = simd::sub (one, delta);
+
+                for (auto k = 1U; k < order; ++k)
+                {
+                    powerU[k]       = simd::mul (powerU[k - 1], delta);
+                    powerInverse[k] = simd::mul (powerInverse[k - 1], inverse);
+                }
+
+                // Positions use the Bi,n polynominals, tangents use n * (Bi-1,n-1 - Bi,n-1).
+                simd::Float position[order], lower[order], tangent[order];
+
+                for (auto i = 0U; i < order; ++i)
+                {
+                    const auto binomial = simd::set ((float) Bezier<Degree>::binomial (Degree, i));
+                    position[i] = simd::mul (binomial, simd::mul (powerU[i], powerInverse[Degree - i]));
+
+                    lower[i] = i < Degree ? simd::mul (simd::set ((float) Bezier<Degree>::binomial (Degree - 1, i)),
+                                                       simd::mul (powerU[i], powerInverse[Degree - 1 - i]))
+                                          : zero;
+                }
+
+                for (auto i = 0U; i < order; ++i)
+                {
+                    tangent[i] = simd::mul (degree, simd::sub (i > 0 ? lower[i - 1] : zero, lower[i]));
+                }
+
+                // Now we can accumulate the position and both partial derivatives for every lane at once.
+                simd::Float px = zero, py = zero, pz = zero,
+                            ux = zero, uy = zero, uz = zero,
+                            vx = zero, vy = zero, vz = zero;
+
+                for (auto i = 0U; i < order; ++i)
+                {
+                    px = simd::madd (curveX[i], position[i], px);
+                    py = simd::madd (curveY[i], position[i], py);
+                    pz = simd::madd (curveZ[i], position[i], pz);
+
+                    ux = simd::madd (curveX[i], tangent[i], ux);
+                    uy = simd::madd (curveY[i], tangent[i], uy);
+                    uz = simd::madd (curveZ[i], tangent[i], uz);
+
+                    vx = simd::madd (tangentX[i], position[i], vx);
+                    vy = simd::madd (tangentY[i], position[i], vy);
+                    vz = simd::madd (tangentZ[i], position[i], vz);
+                }
+
+                // The normal is the normalised cross product of both partial derivatives.
+                const auto nx = simd::sub (simd::mul (uy, vz), simd::mul (uz, vy)),
+                           ny = simd::sub (simd::mul (uz, vx), simd::mul (ux, vz)),
+                           nz = simd::sub (simd::mul (ux, vy), simd::mul (uy, vx));
+
+                const auto length = simd::sqrt (simd::madd (nx, nx, simd::madd (ny, ny, simd::mul (nz, nz))));
+
+                const LaneGroup group { px, py, pz, simd::div (nx, length), simd::div (ny, length), simd::div (nz, length) };
+
+                write (first, lanes, group);
             }
         }
+    }
+
+
+    template <unsigned int Degree>
+    void BezierSurface::calculateRow (const ControlNet<Degree>& controlPoints, const float* const u, const float v,
+                                      const size_t count, Vertex* const output)
+    {
+        // Transpose each group of lanes back into interleaved vertices.
+        const auto interleave = [=] (const size_t first, const size_t lanes, const LaneGroup& group)
+        {
+            float px[simd::width], py[simd::width], pz[simd::width],
+                  nx[simd::width], ny[simd::width], nz[simd::width];
+
+            simd::store (px, group.positionX);
+            simd::store (py, group.positionY);
+            simd::store (pz, group.positionZ);
+            simd::store (nx, group.normalX);
+            simd::store (ny, group.normalY);
+            simd::store (nz, group.normalZ);
+
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                auto& vertex = output[first + lane];
+
+                vertex.position = { px[lane], py[lane], pz[lane] };
+                vertex.normal   = { nx[lane], ny[lane], nz[lane] };
+            }
+        };
 
-        // The position is fine, we need to calculate the tangent. The tangent is the cross product of both partial derivatives.
-        return { position, glm::normalize (glm::cross (partialU, partialV)) };
+        evaluateRow<Degree> (controlPoints, u, v, count, interleave);
     }
-}
\ No newline at end of file
+
+
+    template <unsigned int Degree>
+    void BezierSurface::calculateRow (const ControlNet<Degree>& controlPoints, const float* const u, const float v,
+                                      const size_t count, const SurfaceStreams& output)
+    {
+        const auto streams = [&] (const size_t first, const size_t lanes, const LaneGroup& group)
+        {
+            // Full groups can be written straight to the streams.
+            if (lanes == simd::width)
+            {
+                simd::store (output.positionX + first, group.positionX);
+                simd::store (output.positionY + first, group.positionY);
+                simd::store (output.positionZ + first, group.positionZ);
+                simd::store (output.normalX + first, group.normalX);
+                simd::store (output.normalY + first, group.normalY);
+                simd::store (output.normalZ + first, group.normalZ);
+            }
+
+            // Otherwise we must avoid writing past the end.
+            else
+            {
+                const auto partialStore = [=] (float* const stream, const simd::Float value)
+                {
+                    float lanesData[simd::width];
+                    simd::store (lanesData, value);
+                    std::copy (lanesData, lanesData + lanes, stream + first);
+                };
+
+                partialStore (output.positionX, group.positionX);
+                partialStore (output.positionY, group.positionY);
+                partialStore (output.positionZ, group.positionZ);
+                partialStore (output.normalX, group.normalX);
+                partialStore (output.normalY, group.normalY);
+                partialStore (output.normalZ, group.normalZ);
+            }
+        };
+
+        evaluateRow<Degree> (controlPoints, u, v, count, streams);
+    }
+
+
+    // The intrinsics are kept out of the header so explicitly instantiate the degrees we support.
+    template void BezierSurface::calculateRow<2> (const ControlNet<2>&, const float* const, const float, const size_t, Vertex* const);
+    template void BezierSurface::calculateRow<3> (const ControlNet<3>&, const float* const, const float, const size_t, Vertex* const);
+    template void BezierSurface::calculateRow<2> (const ControlNet<2>&, const float* const, const float, const size_t, const SurfaceStreams&);
+    template void BezierSurface::calculateRow<3> (const ControlNet<3>&, const float* const, const float, const size_t, const SurfaceStreams&);
+}
@@ -3,7 +3,7 @@
 
 
 // STL headers.
-#include <vector>
+#include <cstddef>
 
 
 // Engine headers.
@@ -12,6 +12,7 @@
 
 // Personal headers.
 #include <Renderer/Vertex.hpp>
+#include <Utility/Bezier.hpp>
 
 
 namespace util
@@ -23,23 +24,93 @@ namespace util
     {
         public:
 
-            /// <summary> Determines how the surface will be generated.
-            enum class BezierAlgorithm : unsigned int
+            /// <summary> A fixed-size grid of control points for a surface of the given degree, 4x4 for cubic and 3x3 for quadratic. </summary>
+            template <unsigned int Degree> using ControlNet = typename Bezier<Degree>::template ControlNet<glm::vec3>;
+
+            /// <summary>
+            /// Structure-of-arrays output for BezierSurface::calculateRow(), each pointer must have room for every point.
+            /// </summary>
+            struct SurfaceStreams final
             {
-                Quadratic = 3,  //!< 3x3 grid is required for quadratic Bezier.
-                Cubic     = 4   //!< 4x4 grid is required for cubic Bezier.
+                float*  positionX   { nullptr };    //!< The X component of each position.
+                float*  positionY   { nullptr };    //!< The Y component of each position.
+                float*  positionZ   { nullptr };    //!< The Z component of each position.
+                float*  normalX     { nullptr };    //!< The X component of each normal.
+                float*  normalY     { nullptr };    //!< The Y component of each normal.
+                float*  normalZ     { nullptr };    //!< The Z component of each normal.
             };
 
 
             /// <summary> Calculates the vertex of a point on a Bezier surface at the given U and V values. </summary>
-            /// <param name="controlPoints"> A vector of 16 control points which make up the curve grid. </param>
+            /// <param name="controlPoints"> The control points which make up the curve grid, stored row by row. </param>
             /// <param name="u"> The 0 - 1 U co-ordinate representing a parametric point along the X axis. </param>
             /// <param name="v"> The 0 - 1 V co-ordinate representing a parametric point along the Z axis. </param>
-            /// <param name="mode"> The desired Bezier algorithm to use when generating the surface. </param>
             /// <returns> The computed vertex. </returns>
-            static Vertex calculatePoint (const std::vector<glm::vec3>& controlPoints, const float u, const float v, const BezierAlgorithm mode);
+            template <unsigned int Degree> static Vertex calculatePoint (const ControlNet<Degree>& controlPoints, const float u, const float v);
+
+            /// <summary>
+            /// Calculates many vertices along a single row of a Bezier surface at once using SIMD, eight at a time with AVX
+            /// and four with SSE. The results match BezierSurface::calculatePoint() within floating point error.
+            /// </summary>
+            /// <param name="controlPoints"> The control points which make up the curve grid, stored row by row. </param>
+            /// <param name="u"> The 0 - 1 U co-ordinate of each point to calculate. </param>
+            /// <param name="v"> The 0 - 1 V co-ordinate shared by every point in the row. </param>
+            /// <param name="count"> How many points to calculate. </param>
+            /// <param name="output"> Where to write each interleaved vertex. </param>
+            template <unsigned int Degree> static void calculateRow (const ControlNet<Degree>& controlPoints, const float* const u, const float v, 
+                                                                     const size_t count, Vertex* const output);
+
+            /// <summary> Calculates many vertices along a single row of a Bezier surface, writing them as a structure of arrays. </summary>
+            /// <param name="controlPoints"> The control points which make up the curve grid, stored row by row. </param>
+            /// <param name="u"> The 0 - 1 U co-ordinate of each point to calculate. </param>
+            /// <param name="v"> The 0 - 1 V co-ordinate shared by every point in the row. </param>
+            /// <param name="count"> How many points to calculate. </param>
+            /// <param name="output"> The streams to write each component to. </param>
+            template <unsigned int Degree> static void calculateRow (const ControlNet<Degree>& controlPoints, const float* const u, const float v, 
+                                                                     const size_t count, const SurfaceStreams& output);
     };
+
+
+    template <unsigned int Degree>
+    Vertex BezierSurface::calculatePoint (const ControlNet<Degree>& controlPoints, const float u, const float v)
+    {
+        // The grid dimensions are known at compile-time so every loop here can be unrolled.
+        const auto width  = Bezier<Degree>::order,
+                   height = Bezier<Degree>::order;
+
+        // Each Bernstein polynominal only depends on one axis so calculate them upfront instead of per control point.
+        const auto bernsteinPositionU = Bezier<Degree>::positionWeights (u),
+                   bernsteinPositionV = Bezier<Degree>::positionWeights (v),
+                   bernsteinTangentU  = Bezier<Degree>::tangentWeights (u),
+                   bernsteinTangentV  = Bezier<Degree>::tangentWeights (v);
+
+        // We need to accumlate the position and two partial differentiated tangent vectors to calculate the final vertex.
+        glm::vec3 position { 0 },
+                  partialU { 0 },
+                  partialV { 0 };
+
+        for (auto j = 0U; j < height; ++j)
+        {
+            for (auto i = 0U; i < width; ++i)
+            {
+                // Obtain the control point we're currently using.
+                const auto& point = controlPoints[i + j * width];
+
+                // The formula for position is: += (Pij * Bi(u) * Bj(v)).
+                position += point * bernsteinPositionU[i] * bernsteinPositionV[j];
+
+                // The partial derivative of u is: += (Pij * B'i(u) * Bj(v)).
+                partialU += point * bernsteinTangentU[i] * bernsteinPositionV[j];
+
+                // The partial derivative of v is: += (Pij * Bi(u) * B'j(v)).
+                partialV += point * bernsteinPositionU[i] * bernsteinTangentV[j];
+            }
+        }
+
+        // The position is fine, we need to calculate the tangent. The tangent is the cross product of both partial derivatives.
+        return { position, glm::normalize (glm::cross (partialU, partialV)) };
+    }
 }
 
 
-#endif // UTILITY_BEZIER_SURFACE_3GP_HPP
\ No newline at end of file
+#endif // UTILITY_BEZIER_SURFACE_3GP_HPP
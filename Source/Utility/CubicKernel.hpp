@@ -0,0 +1,171 @@
+#ifndef UTILITY_CUBIC_KERNEL_3GP_HPP
+#define UTILITY_CUBIC_KERNEL_3GP_HPP
+
+
+// STL headers.
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <vector>
+
+
+// Personal headers.
+#include <Utility/Bezier.hpp>
+
+
+namespace util
+{
+    /// <summary>
+    /// A static class containing four tap, one dimensional, cubic reconstruction kernels. These can be applied separably
+    /// to a grid of scalars, once horizontally and once vertically, to upscale it with 8 taps per sample instead of 16.
+    /// </summary>
+    class CubicKernel final
+    {
+        public:
+
+            /// <summary>
+            /// Determines which reconstruction filter is used.
+            /// </summary>
+            enum class Type : int
+            {
+                CatmullRom, //!< An interpolating spline which passes through every sample.
+                BSpline,    //!< An approximating spline which is smoother but doesn't pass through the samples.
+                Bezier      //!< The cubic Bezier basis, every fourth sample is a shared control point like BezierSurface.
+            };
+
+            /// <summary>
+            /// The four samples which contribute to a single output sample and how much each contributes.
+            /// </summary>
+            struct Taps final
+            {
+                unsigned int            first       { 0 };  //!< The index of the first sample used.
+                std::array<float, 4>    weights     { };    //!< The weight of each sample.
+                std::array<float, 4>    derivatives { };    //!< The weight of each sample for the first derivative, per source sample.
+            };
+
+
+            /// <summary> Calculates the weights of each tap at the given fractional position between samples. </summary>
+            /// <param name="type"> The reconstruction filter to use. </param>
+            /// <param name="t"> The 0 - 1 position between the second and third tap, or along the curve when Bezier. </param>
+            /// <param name="weights"> The weight of each tap. </param>
+            /// <param name="derivatives"> The weight of each tap when calculating the derivative with respect to t. </param>
+            static void weights (const Type type, const float t, std::array<float, 4>& weights, std::array<float, 4>& derivatives);
+
+            /// <summary>
+            /// Calculates the taps of every output sample when resampling an axis of sourceCount samples to outputCount
+            /// samples. Output sample i lies at i / outputCount * (sourceCount - 1), matching the Bezier upscaler.
+            /// </summary>
+            /// <param name="type"> The reconstruction filter to use. </param>
+            /// <param name="sourceCount"> How many samples there are in the source data. </param>
+            /// <param name="outputCount"> How many samples should be produced. </param>
+            /// <returns> The taps of each output sample. Taps beyond the edge of the source data are clamped. </returns>
+            static std::vector<Taps> buildTaps (const Type type, const unsigned int sourceCount, const unsigned int outputCount);
+    };
+
+
+    inline void CubicKernel::weights (const Type type, const float t, std::array<float, 4>& weights, std::array<float, 4>& derivatives)
+    {
+        const auto t2 = t * t,
+                   t3 = t2 * t,
+                   s  = 1.f - t;
+
+        switch (type)
+        {
+            case Type::CatmullRom:
+                weights     = {{ 0.5f * (-t3 + 2.f * t2 - t),   0.5f * (3.f * t3 - 5.f * t2 + 2.f),
+                                 0.5f * (-3.f * t3 + 4.f * t2 + t), 0.5f * (t3 - t2) }};
+
+                derivatives = {{ 0.5f * (-3.f * t2 + 4.f * t - 1.f), 0.5f * (9.f * t2 - 10.f * t),
+                                 0.5f * (-9.f * t2 + 8.f * t + 1.f), 0.5f * (3.f * t2 - 2.f * t) }};
+                break;
+
+            case Type::BSpline:
+                weights     = {{ s * s * s / 6.f,                     (3.f * t3 - 6.f * t2 + 4.f) / 6.f,
+                                 (-3.f * t3 + 3.f * t2 + 3.f * t + 1.f) / 6.f, t3 / 6.f }};
+
+                derivatives = {{ -s * s / 2.f,                        (3.f * t2 - 4.f * t) / 2.f,
+                                 (-3.f * t2 + 2.f * t + 1.f) / 2.f,   t2 / 2.f }};
+                break;
+
+            default:
+                weights     = CubicBezier::positionWeights (t);
+                derivatives = CubicBezier::tangentWeights (t);
+                break;
+        }
+    }
+
+
+    inline std::vector<CubicKernel::Taps> CubicKernel::buildTaps (const Type type, const unsigned int sourceCount, const unsigned int outputCount)
+    {
+        // We need at least four samples to fill every tap.
+        assert (sourceCount >= 4);
+
+        std::vector<Taps> taps (outputCount);
+
+        const auto maxSample = sourceCount - 1;
+
+        for (auto i = 0U; i < outputCount; ++i)
+        {
+            auto&      tap    = taps[i];
+            const auto sample = (float) i / outputCount * maxSample;
+            const auto whole  = (unsigned int) sample;
+
+            // The spline kernels are centred between the second and third tap, Bezier curves instead begin every
+            // third sample and span four samples, the same as the control points of BezierSurface.
+            auto       first  = 0,
+                       step   = 1;
+            auto       t      = 0.f;
+
+            if (type == Type::Bezier)
+            {
+                // Vertices are never generated at the final sample so the last curve always begins before it.
+                const auto curve = std::min (whole / 3, (maxSample - 1) / 3);
+
+                first = (int) curve * 3;
+                step  = 3;
+                t     = (sample - first) / step;
+            }
+
+            else
+            {
+                first = (int) whole - 1;
+                t     = sample - whole;
+            }
+
+            weights (type, t, tap.weights, tap.derivatives);
+
+            // The derivative is with respect to t so convert it to be per source sample.
+            for (auto& derivative : tap.derivatives)
+            {
+                derivative /= step;
+            }
+
+            // Keep every tap inside of the source data by folding the weights of overhanging taps onto the edge.
+            if (first < 0 || first + 3 > (int) maxSample)
+            {
+                const auto clamped = std::max (0, std::min (first, (int) maxSample - 3));
+
+                std::array<float, 4> weights { }, derivatives { };
+
+                for (auto k = 0; k < 4; ++k)
+                {
+                    const auto index = std::max (0, std::min (first + k, (int) maxSample)) - clamped;
+
+                    weights[index]     += tap.weights[k];
+                    derivatives[index] += tap.derivatives[k];
+                }
+
+                tap.weights     = weights;
+                tap.derivatives = derivatives;
+                first           = clamped;
+            }
+
+            tap.first = (unsigned int) first;
+        }
+
+        return taps;
+    }
+}
+
+
+#endif // UTILITY_CUBIC_KERNEL_3GP_HPP
@@ -38,6 +38,111 @@ namespace util
     }
 
 
+    void triangleStripAlgorithm (std::vector<unsigned int>& elements, 
+                                 const unsigned int offset, const unsigned int width, const unsigned int depth, 
+                                 const unsigned int increment, const unsigned int lineIncrement, 
+                                 const bool startMirrored, const bool primitiveRestart, const unsigned int restartIndex)
+    {
+        /// Strips alternate the winding of each triangle. A mirrored quad needs its bottom-left vertex followed by its
+        /// top-left vertex on an odd triangle, an unmirrored quad needs top-left then bottom-left on an even triangle,
+        /// both keep the winding of triangleAlgorithm(). Repeating the second to last vertex swaps the order and parity.
+
+        // Where the current strip began, this determines whether the next triangle is odd or even.
+        auto stripStart = elements.size();
+        auto mirrorZ    = startMirrored;
+
+        for (auto z = 0U; z < depth; ++z)
+        {
+            auto       mirror = mirrorZ;
+            const auto bottom = offset + z * lineIncrement,
+                       top    = bottom + lineIncrement;
+
+            // Each row begins with the left edge of its first quad.
+            const auto first  = mirror ? bottom : top,
+                       second = mirror ? top : bottom;
+
+            if (z > 0)
+            {
+                if (primitiveRestart)
+                {
+                    elements.push_back (restartIndex);
+                    stripStart = elements.size();
+                }
+
+                else
+                {
+                    // Every triangle between the two rows contains a repeated vertex so nothing is drawn.
+                    elements.push_back (elements.back());
+                    elements.push_back (first);
+                }
+            }
+
+            // Pad with a degenerate triangle if the first quad would begin on the wrong parity.
+            if (((elements.size() - stripStart) % 2 == 1) != mirror)
+            {
+                elements.push_back (first);
+            }
+
+            elements.push_back (first);
+            elements.push_back (second);
+
+            for (auto x = 0U; x < width; ++x)
+            {
+                const auto nextBottom = bottom + (x + 1) * increment,
+                           nextTop    = top + (x + 1) * increment;
+
+                elements.push_back (mirror ? nextBottom : nextTop);
+                elements.push_back (mirror ? nextTop : nextBottom);
+
+                // The next quad uses the other diagonal.
+                if (x + 1 < width)
+                {
+                    elements.push_back (elements[elements.size() - 2]);
+                }
+
+                mirror = !mirror;
+            }
+
+            mirrorZ = !mirrorZ;
+        }
+    }
+
+
+    void triangleStripToList (std::vector<unsigned int>& list, const std::vector<unsigned int>& strip, 
+                              const bool primitiveRestart, const unsigned int restartIndex)
+    {
+        // Triangles are counted from the start of each strip to find which ones are odd.
+        size_t stripStart = 0;
+
+        for (size_t i = 0; i < strip.size(); ++i)
+        {
+            if (primitiveRestart && strip[i] == restartIndex)
+            {
+                stripStart = i + 1;
+                continue;
+            }
+
+            if (i < stripStart + 2)
+            {
+                continue;
+            }
+
+            const auto a = strip[i - 2],
+                       b = strip[i - 1],
+                       c = strip[i];
+
+            if (a != b && b != c && a != c)
+            {
+                const auto isOdd = (i - stripStart) % 2 == 1;
+
+                list.push_back (isOdd ? b : a);
+                list.push_back (isOdd ? a : b);
+                list.push_back (c);
+            }
+        }
+    }
+
+
     void lowerTriangle (std::vector<unsigned int>& elements, 
                         const unsigned int current, const unsigned int increment, const unsigned int width, 
                         const bool mirror)
@@ -60,4 +165,20 @@ namespace util
         elements.push_back (current + width);
         elements.push_back (triangleEnd);
     }
+
+
+    bool isQuadMirrored (const unsigned int x, const unsigned int z, const unsigned int divisor)
+    {
+        const auto localX = x % divisor,
+                   localZ = z % divisor;
+
+        // The corner stitching starts mirrored against the pattern, this only shows with an odd divisor.
+        if (localX == divisor - 1 && localZ == divisor - 1)
+        {
+            return divisor % 2 != 0;
+        }
+
+        // Every patch starts unmirrored and alternates along both axes, stitching continues the pattern of its patch.
+        return ((localX + localZ) & 1) != 0;
+    }
 }
\ No newline at end of file
@@ -24,6 +24,37 @@ namespace util
                             const unsigned int increment, const unsigned int lineIncrement,
                             const bool startMirrored = false);
 
+    /// <summary> 
+    /// Creates the same triangular pattern as triangleAlgorithm() as a single triangle strip, using roughly half of the 
+    /// elements. Strips can't alternate their diagonal so each change of direction repeats a vertex to form a degenerate
+    /// triangle. Rows are joined with the primitive restart index if enabled, otherwise with degenerate triangles.
+    /// </summary>
+    /// <param name="elements"> The elements vector to add to. </param>
+    /// <param name="offset"> The starting offset of every element. </param>
+    /// <param name="width"> How many elements wide the pattern should be. </param>
+    /// <param name="depth"> How many elements deep the pattern should be. </param>
+    /// <param name="increment"> How much to increment by to obtain an element to the right. </param>
+    /// <param name="lineIncrement"> How much to increment by to reach the element directly above. </param>
+    /// <param name="startMirrored"> Whether the triangle pattern should start mirrored or not. </param>
+    /// <param name="primitiveRestart"> Whether rows should be separated by the restart index. </param>
+    /// <param name="restartIndex"> The primitive restart index, it must not be used by any vertex. </param>
+    void triangleStripAlgorithm (std::vector<unsigned int>& elements, 
+                                 const unsigned int offset, const unsigned int width, const unsigned int depth, 
+                                 const unsigned int increment, const unsigned int lineIncrement,
+                                 const bool startMirrored = false, const bool primitiveRestart = false, 
+                                 const unsigned int restartIndex = 0);
+
+    /// <summary> 
+    /// Converts a triangle strip into the triangle list it draws, skipping degenerate triangles and flipping every odd
+    /// triangle so they all keep the winding of the strip. Used to measure strips with tools which expect lists.
+    /// </summary>
+    /// <param name="list"> The triangle list to add to. </param>
+    /// <param name="strip"> The elements of the triangle strip. </param>
+    /// <param name="primitiveRestart"> Whether the restart index begins a new strip. </param>
+    /// <param name="restartIndex"> The primitive restart index. </param>
+    void triangleStripToList (std::vector<unsigned int>& list, const std::vector<unsigned int>& strip, 
+                              const bool primitiveRestart = false, const unsigned int restartIndex = 0);
+
     /// <summary> Adds the elements to the given vector which create a /| or \| triangle depending on the mirror flag. </summary>
     /// <param name="elements"> The vector to modify. </param>
     /// <param name="current"> The starting element number. </param>
@@ -43,6 +74,16 @@ namespace util
     void upperTriangle (std::vector<unsigned int>& elements, 
                         const unsigned int current, const unsigned int increment, const unsigned int width, 
                         const bool mirror);
+
+    /// <summary> 
+    /// Determines whether the quad at the given terrain co-ordinates uses the mirrored \| diagonal, matching the pattern 
+    /// created by triangleAlgorithm() across both patches and the stitching between them.
+    /// </summary>
+    /// <param name="x"> The X co-ordinate of the first vertex of the quad. </param>
+    /// <param name="z"> The Z co-ordinate of the first vertex of the quad. </param>
+    /// <param name="divisor"> How many vertices wide and deep each patch is. </param>
+    /// <returns> True if the diagonal joins (x + 1, z) to (x, z + 1), false if it joins (x, z) to (x + 1, z + 1). </returns>
+    bool isQuadMirrored (const unsigned int x, const unsigned int z, const unsigned int divisor);
     
 }
 
@@ -0,0 +1,102 @@
+#include "Frustum.hpp"
+
+
+// STL headers.
+#include <cmath>
+
+
+
+namespace util
+{
+    /////////////////////////////////
+    // Constructors and destructor //
+    /////////////////////////////////
+
+    Frustum::Frustum (const glm::mat4& projectionView)
+    {
+        // Matrices are column-major so gather each row first. A point is inside when -w <= x, y, z <= w in clip space,
+        // which gives each plane as the sum or difference of the fourth row with one of the others.
+        glm::vec4 rows[4];
+
+        for (auto row = 0; row < 4; ++row)
+        {
+            rows[row] = glm::vec4 (projectionView[0][row], projectionView[1][row], projectionView[2][row], projectionView[3][row]);
+        }
+
+        m_planes[0] = rows[3] + rows[0];
+        m_planes[1] = rows[3] - rows[0];
+        m_planes[2] = rows[3] + rows[1];
+        m_planes[3] = rows[3] - rows[1];
+        m_planes[4] = rows[3] + rows[2];
+        m_planes[5] = rows[3] - rows[2];
+
+        // Normalise the planes so they give real distances.
+        for (auto& plane : m_planes)
+        {
+            const auto length = std::sqrt (plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+
+            if (length > 0.f)
+            {
+                plane = plane * (1.f / length);
+            }
+        }
+    }
+
+
+    //////////////////////
+    // Public interface //
+    //////////////////////
+
+    bool Frustum::intersects (const glm::vec3& minimum, const glm::vec3& maximum) const
+    {
+        for (const auto& plane : m_planes)
+        {
+            // Only the corner furthest along the normal needs testing, if that is outside then so is the whole box.
+            const auto corner = glm::vec3 (plane.x >= 0.f ? maximum.x : minimum.x,
+                                           plane.y >= 0.f ? maximum.y : minimum.y,
+                                           plane.z >= 0.f ? maximum.z : minimum.z);
+
+            if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    Frustum::Containment Frustum::classify (const glm::vec3& minimum, const glm::vec3& maximum, unsigned int& planes) const
+    {
+        for (size_t i = 0; i < planeCount; ++i)
+        {
+            const auto bit = 1U << i;
+
+            if ((planes & bit) == 0)
+            {
+                continue;
+            }
+
+            // The corner furthest along the normal decides if the box is outside, the nearest decides if it's inside.
+            const auto& plane    = m_planes[i];
+            const auto  furthest = glm::vec3 (plane.x >= 0.f ? maximum.x : minimum.x,
+                                              plane.y >= 0.f ? maximum.y : minimum.y,
+                                              plane.z >= 0.f ? maximum.z : minimum.z);
+            const auto  nearest  = glm::vec3 (plane.x >= 0.f ? minimum.x : maximum.x,
+                                              plane.y >= 0.f ? minimum.y : maximum.y,
+                                              plane.z >= 0.f ? minimum.z : maximum.z);
+
+            if (plane.x * furthest.x + plane.y * furthest.y + plane.z * furthest.z + plane.w < 0.f)
+            {
+                return Containment::Outside;
+            }
+
+            if (plane.x * nearest.x + plane.y * nearest.y + plane.z * nearest.z + plane.w >= 0.f)
+            {
+                planes &= ~bit;
+            }
+        }
+
+        return planes == 0 ? Containment::Inside : Containment::Intersects;
+    }
+}
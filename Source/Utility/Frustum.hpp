@@ -0,0 +1,92 @@
+#ifndef UTILITY_FRUSTUM_3GP_HPP
+#define UTILITY_FRUSTUM_3GP_HPP
+
+
+// STL headers.
+#include <array>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+namespace util
+{
+    /// <summary>
+    /// The six planes which bound the volume a camera can see. Each plane faces into the volume so a point is inside
+    /// when its signed distance from every plane is positive.
+    /// </summary>
+    class Frustum final
+    {
+        public:
+
+            /// <summary> The number of planes in a frustum. </summary>
+            static const size_t planeCount = 6;
+
+            /// <summary> A plane stored as its normal in XYZ and its distance from the origin in W. </summary>
+            using Planes = std::array<glm::vec4, planeCount>;
+
+            /// <summary> A mask with a bit set for every plane, in the order of the planes. </summary>
+            static const unsigned int allPlanes = (1 << planeCount) - 1;
+
+            /// <summary>
+            /// Where a box lies relative to the frustum.
+            /// </summary>
+            enum class Containment : int
+            {
+                Outside,    //!< The box is entirely outside of at least one plane.
+                Intersects, //!< The box crosses at least one plane.
+                Inside      //!< The box is entirely inside of every plane.
+            };
+
+
+            /////////////////////////////////
+            // Constructors and destructor //
+            /////////////////////////////////
+
+            /// <summary> Extracts the planes of the volume visible through the given transform. </summary>
+            /// <param name="projectionView"> The projection transform multiplied by the view transform. </param>
+            Frustum (const glm::mat4& projectionView);
+
+            Frustum()                                   = default;
+            Frustum (const Frustum& copy)               = default;
+            Frustum& operator= (const Frustum& copy)    = default;
+            ~Frustum()                                  = default;
+
+
+            /////////////////////////
+            // Getters and setters //
+            /////////////////////////
+
+            /// <summary> Gets the normalised planes, left, right, bottom, top, near and then far. </summary>
+            const Planes& getPlanes() const { return m_planes; }
+
+
+            //////////////////////
+            // Public interface //
+            //////////////////////
+
+            /// <summary> Tests whether any part of an axis-aligned bounding box may be inside the frustum. </summary>
+            /// <param name="minimum"> The minimum corner of the box. </param>
+            /// <param name="maximum"> The maximum corner of the box. </param>
+            /// <returns> False if the box is entirely outside of a plane, true otherwise. </returns>
+            bool intersects (const glm::vec3& minimum, const glm::vec3& maximum) const;
+
+            /// <summary> 
+            /// Finds where a box lies relative to the frustum, only testing the given planes. A box inside a plane has
+            /// its bit removed from the mask, so the mask can be passed on when testing boxes contained by this box.
+            /// </summary>
+            /// <param name="minimum"> The minimum corner of the box. </param>
+            /// <param name="maximum"> The maximum corner of the box. </param>
+            /// <param name="planes"> The planes to test, updated to only contain the planes the box crosses. </param>
+            /// <returns> Inside when the box is inside of every plane in the mask. </returns>
+            Containment classify (const glm::vec3& minimum, const glm::vec3& maximum, unsigned int& planes) const;
+
+        private:
+
+            Planes  m_planes    { };    //!< The planes of the frustum, an empty frustum contains everything.
+    };
+}
+
+
+#endif // UTILITY_FRUSTUM_3GP_HPP
@@ -0,0 +1,182 @@
+#include "MappedFile.hpp"
+
+
+// STL headers.
+#include <utility>
+
+
+// Engine headers.
+#if defined (_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+
+namespace util
+{
+    /////////////////////////////////
+    // Constructors and destructor //
+    /////////////////////////////////
+
+    MappedFile::MappedFile (const std::string& file)
+    {
+        open (file);
+    }
+
+
+    MappedFile::MappedFile (MappedFile&& move)
+    {
+        *this = std::move (move);
+    }
+
+
+    MappedFile& MappedFile::operator= (MappedFile&& move)
+    {
+        if (this != &move)
+        {
+            // Ensure we don't leak our own mapping.
+            close();
+
+            m_data = move.m_data;
+            m_size = move.m_size;
+
+            #if defined (_WIN32)
+                m_file         = move.m_file;
+                m_mapping      = move.m_mapping;
+                move.m_file    = nullptr;
+                move.m_mapping = nullptr;
+            #endif
+
+            // Reset primitives.
+            move.m_data = nullptr;
+            move.m_size = 0;
+        }
+
+        return *this;
+    }
+
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+
+    //////////////////////
+    // Public interface //
+    //////////////////////
+
+    #if defined (_WIN32)
+
+        bool MappedFile::open (const std::string& file)
+        {
+            close();
+
+            // Sequential scanning lets the cache manager read ahead when the heights are streamed through.
+            const auto handle = CreateFileA (file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 
+                                             FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+            if (handle == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            LARGE_INTEGER size { };
+
+            if (GetFileSizeEx (handle, &size) && size.QuadPart > 0)
+            {
+                const auto mapping = CreateFileMappingA (handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+                if (mapping)
+                {
+                    const auto view = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+
+                    if (view)
+                    {
+                        m_file    = handle;
+                        m_mapping = mapping;
+                        m_data    = (const uint8_t*) view;
+                        m_size    = (size_t) size.QuadPart;
+
+                        return true;
+                    }
+
+                    CloseHandle (mapping);
+                }
+            }
+
+            CloseHandle (handle);
+            return false;
+        }
+
+
+        void MappedFile::close()
+        {
+            if (m_data)
+            {
+                UnmapViewOfFile (m_data);
+                CloseHandle (m_mapping);
+                CloseHandle (m_file);
+            }
+
+            m_data    = nullptr;
+            m_size    = 0;
+            m_file    = nullptr;
+            m_mapping = nullptr;
+        }
+
+    #else
+
+        bool MappedFile::open (const std::string& file)
+        {
+            close();
+
+            const auto handle = ::open (file.c_str(), O_RDONLY);
+
+            if (handle == -1)
+            {
+                return false;
+            }
+
+            struct stat status { };
+
+            if (fstat (handle, &status) == 0 && status.st_size > 0)
+            {
+                const auto size = (size_t) status.st_size;
+                const auto view = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, handle, 0);
+
+                if (view != MAP_FAILED)
+                {
+                    // Sequential access lets the kernel read ahead, the mapping stays valid once the descriptor is closed.
+                    madvise (view, size, MADV_SEQUENTIAL);
+
+                    m_data = (const uint8_t*) view;
+                    m_size = size;
+                }
+            }
+
+            ::close (handle);
+            return m_data != nullptr;
+        }
+
+
+        void MappedFile::close()
+        {
+            if (m_data)
+            {
+                munmap ((void*) m_data, m_size);
+            }
+
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+    #endif
+}
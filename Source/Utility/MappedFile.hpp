@@ -0,0 +1,82 @@
+#ifndef UTILITY_MAPPED_FILE_3GP_HPP
+#define UTILITY_MAPPED_FILE_3GP_HPP
+
+
+// STL headers.
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace util
+{
+    /// <summary>
+    /// A read-only view of an entire file which has been mapped into memory by the operating system. Pages are only read
+    /// from disk when they are first touched so opening a file costs the same regardless of its size.
+    /// </summary>
+    class MappedFile final
+    {
+        public:
+
+            /////////////////////////////////
+            // Constructors and destructor //
+            /////////////////////////////////
+
+            MappedFile()                                    = default;
+
+            /// <summary> Attempts to map the given file, check MappedFile::isOpen() to see if it succeeded. </summary>
+            /// <param name="file"> The location of the file to map. </param>
+            MappedFile (const std::string& file);
+
+            MappedFile (MappedFile&& move);
+            MappedFile& operator= (MappedFile&& move);
+            ~MappedFile();
+
+            MappedFile (const MappedFile& copy)             = delete;
+            MappedFile& operator= (const MappedFile& copy)  = delete;
+
+
+            /////////////////////////
+            // Getters and setters //
+            /////////////////////////
+
+            /// <summary> Checks whether a file is currently mapped. </summary>
+            bool isOpen() const                 { return m_data != nullptr; }
+
+            /// <summary> Gets the first byte of the mapped file. </summary>
+            const uint8_t* getData() const      { return m_data; }
+
+            /// <summary> Gets how many bytes the mapped file contains. </summary>
+            size_t getSize() const              { return m_size; }
+
+
+            //////////////////////
+            // Public interface //
+            //////////////////////
+
+            /// <summary> Maps the given file into memory, unmapping any previously opened file. </summary>
+            /// <param name="file"> The location of the file to map. </param>
+            /// <returns> Whether the file could be mapped. Empty files can't be mapped. </returns>
+            bool open (const std::string& file);
+
+            /// <summary> Unmaps the file, invalidating any pointers to its data. </summary>
+            void close();
+
+        private:
+
+            ///////////////////
+            // Internal data //
+            ///////////////////
+
+            const uint8_t*  m_data      { nullptr };    //!< The start of the mapped view.
+            size_t          m_size      { 0 };          //!< The size of the mapped view in bytes.
+
+            #if defined (_WIN32)
+                void*       m_file      { nullptr };    //!< The handle of the opened file.
+                void*       m_mapping   { nullptr };    //!< The handle of the file mapping object.
+            #endif
+    };
+}
+
+
+#endif // UTILITY_MAPPED_FILE_3GP_HPP
@@ -0,0 +1,39 @@
+#ifndef UTILITY_MORTON_3GP_HPP
+#define UTILITY_MORTON_3GP_HPP
+
+
+// STL headers.
+#include <cstdint>
+
+
+namespace util
+{
+    /// <summary> Spreads the lower 16 bits of a value apart so that there's an empty bit between each of them. </summary>
+    /// <param name="value"> The value to spread, the upper 16 bits are ignored. </param>
+    inline uint32_t mortonSpread (const uint32_t value)
+    {
+        auto spread = value & 0x0000FFFF;
+
+        spread = (spread | (spread << 8)) & 0x00FF00FF;
+        spread = (spread | (spread << 4)) & 0x0F0F0F0F;
+        spread = (spread | (spread << 2)) & 0x33333333;
+        spread = (spread | (spread << 1)) & 0x55555555;
+
+        return spread;
+    }
+
+
+    /// <summary>
+    /// Calculates the Morton (Z-order) index of a 2D co-ordinate by interleaving the bits of each axis. Co-ordinates
+    /// which are close together usually have indices which are close together, sorting by them keeps squares together.
+    /// </summary>
+    /// <param name="x"> The X co-ordinate, it occupies the even bits. Only the lower 16 bits are used. </param>
+    /// <param name="z"> The Z co-ordinate, it occupies the odd bits. Only the lower 16 bits are used. </param>
+    inline uint32_t mortonEncode (const uint32_t x, const uint32_t z)
+    {
+        return mortonSpread (x) | (mortonSpread (z) << 1);
+    }
+}
+
+
+#endif // UTILITY_MORTON_3GP_HPP
@@ -0,0 +1,387 @@
+#include "OcclusionBuffer.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+
+// Personal headers.
+#include <Utility/Parallel.hpp>
+#include <Utility/SIMD.hpp>
+
+
+
+namespace
+{
+    /// <summary> The offset of each SIMD lane from the first pixel of a group. </summary>
+    const float laneOffsets[] = { 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f };
+
+    /// <summary> Pixels which have never been drawn to hide nothing. </summary>
+    const float emptyDepth = std::numeric_limits<float>::max();
+}
+
+
+namespace util
+{
+    /////////////////////////////////
+    // Constructors and destructor //
+    /////////////////////////////////
+
+    OcclusionBuffer::OcclusionBuffer (const unsigned int width, const unsigned int height)
+        : m_width (width), m_height (height), m_tilesX (width / tileWidth)
+    {
+        assert (width > 0 && height > 0 && width % tileWidth == 0 && height % tileHeight == 0);
+        static_assert (tileWidth % simd::width == 0, "Each row of a tile must be a whole number of SIMD groups.");
+
+        const auto tiles = (size_t) m_tilesX * (height / tileHeight);
+
+        m_depths.assign ((size_t) width * height, emptyDepth);
+        m_tileDepths.assign (tiles, emptyDepth);
+        m_bins.resize (tiles);
+    }
+
+
+    OcclusionBuffer::OcclusionBuffer (OcclusionBuffer&& move)
+    {
+        *this = std::move (move);
+    }
+
+
+    OcclusionBuffer& OcclusionBuffer::operator= (OcclusionBuffer&& move)
+    {
+        if (this != &move)
+        {
+            m_width      = move.m_width;
+            m_height     = move.m_height;
+            m_tilesX     = move.m_tilesX;
+            m_transform  = move.m_transform;
+            m_depths     = std::move (move.m_depths);
+            m_tileDepths = std::move (move.m_tileDepths);
+            m_triangles  = std::move (move.m_triangles);
+            m_bins       = std::move (move.m_bins);
+            m_statistics = move.m_statistics;
+
+            // Reset primitives.
+            move.m_width  = 0;
+            move.m_height = 0;
+            move.m_tilesX = 0;
+        }
+
+        return *this;
+    }
+
+
+    //////////////////////
+    // Public interface //
+    //////////////////////
+
+    void OcclusionBuffer::begin (const glm::mat4& projectionView)
+    {
+        m_transform  = projectionView;
+        m_statistics = Statistics { };
+
+        std::fill (m_depths.begin(), m_depths.end(), emptyDepth);
+        std::fill (m_tileDepths.begin(), m_tileDepths.end(), emptyDepth);
+
+        m_triangles.clear();
+
+        for (auto& bin : m_bins)
+        {
+            bin.clear();
+        }
+    }
+
+
+    void OcclusionBuffer::addTriangles (const glm::vec3* positions, const size_t count)
+    {
+        for (size_t triangle = 0; triangle < count; ++triangle)
+        {
+            glm::vec4 corners[3];
+
+            for (auto i = 0U; i < 3; ++i)
+            {
+                corners[i] = m_transform * glm::vec4 (positions[triangle * 3 + i], 1.f);
+            }
+
+            // Skip triangles which are entirely outside of a side of the view.
+            const auto outside = [&] (const int axis, const float sign)
+            {
+                return corners[0][axis] * sign > corners[0].w && corners[1][axis] * sign > corners[1].w && corners[2][axis] * sign > corners[2].w;
+            };
+
+            if (outside (0, 1.f) || outside (0, -1.f) || outside (1, 1.f) || outside (1, -1.f))
+            {
+                continue;
+            }
+
+            // Clip against the near plane, where z = -w, so every corner can be divided by a positive W. A triangle
+            // becomes a quad at most, which is split back into triangles around its first corner.
+            glm::vec4 clipped[4];
+            auto      clippedCount = 0U;
+
+            for (auto i = 0U; i < 3; ++i)
+            {
+                const auto& current  = corners[i];
+                const auto& next     = corners[(i + 1) % 3];
+                const auto  distance = current.z + current.w,
+                            nextDistance = next.z + next.w;
+
+                if (distance >= 0.f)
+                {
+                    clipped[clippedCount++] = current;
+                }
+
+                if ((distance >= 0.f) != (nextDistance >= 0.f))
+                {
+                    clipped[clippedCount++] = glm::mix (current, next, distance / (distance - nextDistance));
+                }
+            }
+
+            for (auto i = 2U; i < clippedCount; ++i)
+            {
+                addTriangle (clipped[0], clipped[i - 1], clipped[i]);
+            }
+        }
+    }
+
+
+    void OcclusionBuffer::rasterise()
+    {
+        // Starting a thread costs more than drawing a few thousand small triangles, and this runs every frame. Each
+        // thread is given tiles worth at least minimumThreadWork binned triangles so a light frame stays on this thread.
+        const auto tiles   = m_bins.size(),
+                   binned  = std::max (m_statistics.binned, (size_t) 1),
+                   minimum = std::max (tiles * minimumThreadWork / binned, (size_t) 1);
+
+        util::parallelFor (0, tiles, [this] (const size_t tile) { rasteriseTile (tile); }, minimum);
+    }
+
+
+    bool OcclusionBuffer::isOccluded (const glm::vec3& minimum, const glm::vec3& maximum) const
+    {
+        const auto size = glm::vec2 (m_width, m_height);
+
+        auto lowest  = glm::vec2 (std::numeric_limits<float>::max()),
+             highest = -lowest;
+        auto nearest = std::numeric_limits<float>::max();
+
+        for (auto corner = 0U; corner < 8; ++corner)
+        {
+            const auto position = glm::vec3 (corner & 1 ? maximum.x : minimum.x,
+                                             corner & 2 ? maximum.y : minimum.y,
+                                             corner & 4 ? maximum.z : minimum.z);
+            const auto clip     = m_transform * glm::vec4 (position, 1.f);
+
+            // Boxes crossing the near plane surround the camera so nothing can be in front of them.
+            if (clip.z < -clip.w || clip.w <= 0.f)
+            {
+                return false;
+            }
+
+            const auto screen = (glm::vec2 (clip.x, clip.y) / clip.w * 0.5f + 0.5f) * size;
+
+            lowest  = glm::min (lowest, screen);
+            highest = glm::max (highest, screen);
+            nearest = std::min (nearest, clip.z / clip.w);
+        }
+
+        // Occluders are sampled at pixel centres so an edge may leave part of a covered pixel open. Every pixel the
+        // rectangle touches must be covered, along with the pixels around them.
+        const auto minX = std::max ((int) std::floor (lowest.x) - 1, 0),
+                   minY = std::max ((int) std::floor (lowest.y) - 1, 0),
+                   maxX = std::min ((int) std::floor (highest.x) + 1, (int) m_width - 1),
+                   maxY = std::min ((int) std::floor (highest.y) + 1, (int) m_height - 1);
+
+        // Boxes off the screen are left to the frustum.
+        if (minX > maxX || minY > maxY)
+        {
+            return false;
+        }
+
+        for (auto tileY = minY / (int) tileHeight; tileY <= maxY / (int) tileHeight; ++tileY)
+        {
+            for (auto tileX = minX / (int) tileWidth; tileX <= maxX / (int) tileWidth; ++tileX)
+            {
+                // A tile which is entirely nearer than the box needs no further testing.
+                if (m_tileDepths[tileX + tileY * m_tilesX] < nearest)
+                {
+                    continue;
+                }
+
+                const auto firstX = std::max (minX, tileX * (int) tileWidth),
+                           lastX  = std::min (maxX, (tileX + 1) * (int) tileWidth - 1),
+                           firstY = std::max (minY, tileY * (int) tileHeight),
+                           lastY  = std::min (maxY, (tileY + 1) * (int) tileHeight - 1);
+
+                for (auto y = firstY; y <= lastY; ++y)
+                {
+                    const auto row = m_depths.data() + y * m_width;
+
+                    for (auto x = firstX; x <= lastX; ++x)
+                    {
+                        if (row[x] >= nearest)
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    /////////////////////
+    // Private methods //
+    /////////////////////
+
+    void OcclusionBuffer::addTriangle (const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+    {
+        const auto size = glm::vec2 (m_width, m_height);
+
+        glm::vec3 screen[3];
+        const glm::vec4* corners[] = { &a, &b, &c };
+
+        for (auto i = 0U; i < 3; ++i)
+        {
+            const auto& corner = *corners[i];
+            const auto  xy     = (glm::vec2 (corner.x, corner.y) / corner.w * 0.5f + 0.5f) * size;
+
+            screen[i] = glm::vec3 (xy, corner.z / corner.w);
+        }
+
+        // Faces aren't culled so clockwise triangles are turned around, leaving the inside of every edge positive.
+        auto       first  = screen[1] - screen[0],
+                   second = screen[2] - screen[0];
+        const auto area   = first.x * second.y - second.x * first.y;
+
+        if (std::abs (area) < 1e-6f)
+        {
+            return;
+        }
+
+        if (area < 0.f)
+        {
+            std::swap (screen[1], screen[2]);
+            std::swap (first, second);
+        }
+
+        // Pixels are sampled at their centres.
+        const auto lowest  = glm::min (glm::min (screen[0], screen[1]), screen[2]),
+                   highest = glm::max (glm::max (screen[0], screen[1]), screen[2]);
+
+        Triangle triangle { };
+
+        triangle.minX = std::max ((int) std::ceil (lowest.x - 0.5f), 0);
+        triangle.minY = std::max ((int) std::ceil (lowest.y - 0.5f), 0);
+        triangle.maxX = std::min ((int) std::floor (highest.x - 0.5f), (int) m_width - 1);
+        triangle.maxY = std::min ((int) std::floor (highest.y - 0.5f), (int) m_height - 1);
+
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        {
+            return;
+        }
+
+        // Each edge function is positive on the inside of its edge. Measuring from the first corner keeps the values
+        // small when clipping has left corners far outside of the screen.
+        triangle.origin = glm::vec2 (screen[0]);
+
+        for (auto i = 0U; i < 3; ++i)
+        {
+            const auto& start = screen[i];
+            const auto& end   = screen[(i + 1) % 3];
+
+            triangle.edges[i] = glm::vec3 (start.y - end.y, end.x - start.x,
+                                           (end.x - start.x) * (screen[0].y - start.y) - (end.y - start.y) * (screen[0].x - start.x));
+        }
+
+        // Depth is linear in screen space after the perspective divide. Each pixel stores the furthest depth the
+        // triangle reaches within it rather than the depth at its centre.
+        const auto signedArea = first.x * second.y - second.x * first.y,
+                   gradientX  = (first.z * second.y - second.z * first.y) / signedArea,
+                   gradientY  = (second.z * first.x - first.z * second.x) / signedArea;
+
+        triangle.depth = glm::vec3 (screen[0].z + 0.5f * (std::abs (gradientX) + std::abs (gradientY)), gradientX, gradientY);
+
+        const auto index = (unsigned int) m_triangles.size();
+        m_triangles.push_back (triangle);
+        ++m_statistics.triangles;
+
+        for (auto tileY = triangle.minY / (int) tileHeight; tileY <= triangle.maxY / (int) tileHeight; ++tileY)
+        {
+            for (auto tileX = triangle.minX / (int) tileWidth; tileX <= triangle.maxX / (int) tileWidth; ++tileX)
+            {
+                m_bins[tileX + tileY * m_tilesX].push_back (index);
+                ++m_statistics.binned;
+            }
+        }
+    }
+
+
+    void OcclusionBuffer::rasteriseTile (const size_t tile)
+    {
+        const auto tileX = (int) (tile % m_tilesX) * (int) tileWidth,
+                   tileY = (int) (tile / m_tilesX) * (int) tileHeight;
+
+        const auto zero    = simd::set (0.f),
+                   offsets = simd::load (laneOffsets);
+
+        for (const auto index : m_bins[tile])
+        {
+            const auto& triangle = m_triangles[index];
+
+            // Start at the group containing the first column so every group stays within the tile.
+            const auto firstX = tileX + (std::max (triangle.minX, tileX) - tileX) / (int) simd::width * (int) simd::width,
+                       lastX  = std::min (triangle.maxX, tileX + (int) tileWidth - 1),
+                       firstY = std::max (triangle.minY, tileY),
+                       lastY  = std::min (triangle.maxY, tileY + (int) tileHeight - 1);
+
+            const auto edgeX0 = simd::set (triangle.edges[0].x), edgeY0 = simd::set (triangle.edges[0].y),
+                       edgeX1 = simd::set (triangle.edges[1].x), edgeY1 = simd::set (triangle.edges[1].y),
+                       edgeX2 = simd::set (triangle.edges[2].x), edgeY2 = simd::set (triangle.edges[2].y),
+                       depthX = simd::set (triangle.depth.y),    depthY = simd::set (triangle.depth.z);
+
+            for (auto y = firstY; y <= lastY; ++y)
+            {
+                const auto dy   = simd::set (y + 0.5f - triangle.origin.y);
+                const auto row  = m_depths.data() + y * m_width;
+
+                const auto rowEdge0 = simd::madd (edgeY0, dy, simd::set (triangle.edges[0].z)),
+                           rowEdge1 = simd::madd (edgeY1, dy, simd::set (triangle.edges[1].z)),
+                           rowEdge2 = simd::madd (edgeY2, dy, simd::set (triangle.edges[2].z)),
+                           rowDepth = simd::madd (depthY, dy, simd::set (triangle.depth.x));
+
+                for (auto x = firstX; x <= lastX; x += simd::width)
+                {
+                    const auto dx = simd::add (simd::set (x + 0.5f - triangle.origin.x), offsets);
+
+                    // A pixel is inside when no edge function is negative.
+                    const auto inside = simd::min (simd::madd (edgeX0, dx, rowEdge0),
+                                        simd::min (simd::madd (edgeX1, dx, rowEdge1),
+                                                   simd::madd (edgeX2, dx, rowEdge2)));
+
+                    const auto current = simd::load (row + x);
+                    const auto nearer  = simd::min (current, simd::madd (depthX, dx, rowDepth));
+
+                    simd::store (row + x, simd::select (simd::less (inside, zero), current, nearer));
+                }
+            }
+        }
+
+        // The furthest depth lets boxes behind the whole tile skip testing each pixel.
+        auto furthest = -emptyDepth;
+
+        for (auto y = tileY; y < tileY + (int) tileHeight; ++y)
+        {
+            const auto row = m_depths.data() + y * m_width + tileX;
+            furthest = std::max (furthest, *std::max_element (row, row + tileWidth));
+        }
+
+        m_tileDepths[tile] = furthest;
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef UTILITY_OCCLUSION_BUFFER_3GP_HPP
+#define UTILITY_OCCLUSION_BUFFER_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+namespace util
+{
+    /// <summary>
+    /// A small depth buffer rendered on the CPU so that objects hidden behind large occluders can be skipped before they
+    /// reach the GPU. Occluding triangles are clipped against the near plane and sorted into screen tiles, then each tile
+    /// is rasterised independently across every thread, filling several pixels of a row at once with SIMD. Boxes are
+    /// tested by comparing the nearest depth of their corners against every pixel their screen rectangle covers. Faces
+    /// are never culled, occluders are expected to be solid and entirely within the objects they stand in for.
+    /// </summary>
+    class OcclusionBuffer final
+    {
+        public:
+
+            /// <summary> The default resolution of the buffer, which is stretched over the whole view. </summary>
+            static const unsigned int defaultWidth = 256, defaultHeight = 128;
+
+            /// <summary> How many pixels wide and tall each tile is, the width must be a multiple of the SIMD width. </summary>
+            static const unsigned int tileWidth = 32, tileHeight = 16;
+
+            /// <summary> How many binned triangles a thread must be given before rasterising is split across threads. </summary>
+            static const size_t minimumThreadWork = 2048;
+
+            /// <summary>
+            /// The amount of work done since the last call to begin().
+            /// </summary>
+            struct Statistics final
+            {
+                size_t  triangles   { 0 };  //!< How many triangles were set up after clipping.
+                size_t  binned      { 0 };  //!< How many times a triangle was added to a tile.
+            };
+
+
+            /////////////////////////////////
+            // Constructors and destructor //
+            /////////////////////////////////
+
+            /// <summary> Creates an empty buffer, the width and height must be multiples of the tile size. </summary>
+            /// <param name="width"> How many pixels wide the buffer is. </param>
+            /// <param name="height"> How many pixels tall the buffer is. </param>
+            OcclusionBuffer (const unsigned int width = defaultWidth, const unsigned int height = defaultHeight);
+
+            OcclusionBuffer (OcclusionBuffer&& move);
+            OcclusionBuffer& operator= (OcclusionBuffer&& move);
+
+            OcclusionBuffer (const OcclusionBuffer& copy)               = default;
+            OcclusionBuffer& operator= (const OcclusionBuffer& copy)    = default;
+            ~OcclusionBuffer()                                          = default;
+
+
+            /////////////////////////
+            // Getters and setters //
+            /////////////////////////
+
+            /// <summary> Gets how many pixels wide the buffer is. </summary>
+            unsigned int getWidth() const                   { return m_width; }
+
+            /// <summary> Gets how many pixels tall the buffer is. </summary>
+            unsigned int getHeight() const                  { return m_height; }
+
+            /// <summary> Gets the normalised device depth of every pixel, stored row by row from the bottom of the view. </summary>
+            const std::vector<float>& getDepths() const     { return m_depths; }
+
+            /// <summary> Gets the amount of work done since the last call to begin(). </summary>
+            const Statistics& getStatistics() const         { return m_statistics; }
+
+
+            //////////////////////
+            // Public interface //
+            //////////////////////
+
+            /// <summary> Clears the buffer and removes every occluder, ready to render the view of a new transform. </summary>
+            /// <param name="projectionView"> The projection transform multiplied by the view transform. </param>
+            void begin (const glm::mat4& projectionView);
+
+            /// <summary> Clips and bins a list of occluding triangles, they aren't drawn until rasterise() is called. </summary>
+            /// <param name="positions"> The world position of each corner, three for every triangle. </param>
+            /// <param name="count"> How many triangles there are. </param>
+            void addTriangles (const glm::vec3* positions, const size_t count);
+
+            /// <summary> Draws every binned triangle into the buffer, one tile at a time across as many threads as the work warrants. </summary>
+            void rasterise();
+
+            /// <summary> Tests whether an axis-aligned bounding box is entirely hidden behind the occluders. </summary>
+            /// <param name="minimum"> The minimum corner of the box. </param>
+            /// <param name="maximum"> The maximum corner of the box. </param>
+            /// <returns> True only if every pixel the box may cover has an occluder in front of it. </returns>
+            bool isOccluded (const glm::vec3& minimum, const glm::vec3& maximum) const;
+
+        private:
+
+            /// <summary> A triangle prepared for rasterising, each value is relative to its first corner. </summary>
+            struct Triangle final
+            {
+                glm::vec2   origin;     //!< The screen position of the first corner.
+                glm::vec3   edges[3];   //!< The X and Y gradients of each edge function and its value at the origin.
+                glm::vec3   depth;      //!< The furthest depth of a pixel centred on the origin and its X and Y gradients.
+                int         minX;       //!< The first column of pixels covered.
+                int         minY;       //!< The first row of pixels covered.
+                int         maxX;       //!< The last column of pixels covered.
+                int         maxY;       //!< The last row of pixels covered.
+            };
+
+            /// <summary> Prepares a triangle which is in front of the near plane and adds it to every tile it covers. </summary>
+            /// <param name="a"> The clip space position of the first corner. </param>
+            /// <param name="b"> The clip space position of the second corner. </param>
+            /// <param name="c"> The clip space position of the third corner. </param>
+            void addTriangle (const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+            /// <summary> Draws every triangle binned into a tile and finds the furthest depth left in it. </summary>
+            /// <param name="tile"> The index of the tile. </param>
+            void rasteriseTile (const size_t tile);
+
+
+            unsigned int                            m_width         { defaultWidth };   //!< How many pixels wide the buffer is.
+            unsigned int                            m_height        { defaultHeight };  //!< How many pixels tall the buffer is.
+            unsigned int                            m_tilesX        { 0 };              //!< How many tiles make up each row.
+            glm::mat4                               m_transform     { 1.f };            //!< Transforms world positions into clip space.
+            std::vector<float>                      m_depths        { };                //!< The depth of every pixel.
+            std::vector<float>                      m_tileDepths    { };                //!< The furthest depth within each tile.
+            std::vector<Triangle>                   m_triangles     { };                //!< Every triangle waiting to be rasterised.
+            std::vector<std::vector<unsigned int>>  m_bins          { };                //!< The triangles covering each tile.
+            Statistics                              m_statistics    { };                //!< The work done since the buffer was cleared.
+    };
+}
+
+
+#endif // UTILITY_OCCLUSION_BUFFER_3GP_HPP
@@ -0,0 +1,55 @@
+#ifndef UTILITY_OCTAHEDRAL_3GP_HPP
+#define UTILITY_OCTAHEDRAL_3GP_HPP
+
+
+// STL headers.
+#include <cmath>
+
+
+// Engine headers.
+#include <glm/gtc/type_ptr.hpp>
+
+
+namespace util
+{
+    /// <summary>
+    /// Maps a unit vector onto the unit square by projecting it onto an octahedron and folding the lower half over the
+    /// upper half. The two components quantise far better than three, which makes this ideal for compact normals.
+    /// </summary>
+    /// <param name="normal"> A unit vector. </param>
+    /// <returns> The encoded vector, each component is within -1 and 1. </returns>
+    inline glm::vec2 octahedralEncode (const glm::vec3& normal)
+    {
+        const auto sum     = std::abs (normal.x) + std::abs (normal.y) + std::abs (normal.z);
+        const auto encoded = glm::vec2 (normal.x, normal.y) / sum;
+
+        if (normal.z >= 0.f)
+        {
+            return encoded;
+        }
+
+        // Fold the lower hemisphere over the diagonals.
+        return glm::vec2 ((1.f - std::abs (encoded.y)) * (encoded.x >= 0.f ? 1.f : -1.f),
+                          (1.f - std::abs (encoded.x)) * (encoded.y >= 0.f ? 1.f : -1.f));
+    }
+
+
+    /// <summary> Reverses octahedralEncode(), this must match the decoding in the terrain vertex shader. </summary>
+    /// <param name="encoded"> An encoded vector, each component should be within -1 and 1. </param>
+    /// <returns> The decoded unit vector. </returns>
+    inline glm::vec3 octahedralDecode (const glm::vec2& encoded)
+    {
+        auto normal = glm::vec3 (encoded.x, encoded.y, 1.f - std::abs (encoded.x) - std::abs (encoded.y));
+
+        if (normal.z < 0.f)
+        {
+            normal.x = (1.f - std::abs (encoded.y)) * (encoded.x >= 0.f ? 1.f : -1.f);
+            normal.y = (1.f - std::abs (encoded.x)) * (encoded.y >= 0.f ? 1.f : -1.f);
+        }
+
+        return glm::normalize (normal);
+    }
+}
+
+
+#endif // UTILITY_OCTAHEDRAL_3GP_HPP
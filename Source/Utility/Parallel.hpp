@@ -0,0 +1,64 @@
+#ifndef UTILITY_PARALLEL_3GP_HPP
+#define UTILITY_PARALLEL_3GP_HPP
+
+
+// STL headers.
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+
+namespace util
+{
+    /// <summary>
+    /// Calls the given function for every index from begin up to, but not including, end. The range is split into one
+    /// contiguous chunk per hardware thread and the call blocks until every chunk has finished. The function must be safe
+    /// to call concurrently for different indices.
+    /// </summary>
+    /// <param name="begin"> The first index. </param>
+    /// <param name="end"> One past the last index. </param>
+    /// <param name="function"> Called with each index. </param>
+    /// <param name="minimumChunk"> Ranges smaller than this are never split, avoiding thread overhead for small jobs. </param>
+    template <typename Function>
+    void parallelFor (const size_t begin, const size_t end, const Function& function, const size_t minimumChunk = 1)
+    {
+        if (begin >= end)
+        {
+            return;
+        }
+
+        const auto count   = end - begin,
+                   threads = std::min ((size_t) std::max (std::thread::hardware_concurrency(), 1U), 
+                                       std::max (count / std::max (minimumChunk, (size_t) 1), (size_t) 1)),
+                   chunk   = (count + threads - 1) / threads;
+
+        // The calling thread takes the first chunk so a single chunk never spawns a thread.
+        const auto runChunk = [&] (const size_t first)
+        {
+            const auto last = std::min (first + chunk, end);
+
+            for (auto i = first; i < last; ++i)
+            {
+                function (i);
+            }
+        };
+
+        std::vector<std::thread> workers { };
+        workers.reserve (threads - 1);
+
+        for (auto first = begin + chunk; first < end; first += chunk)
+        {
+            workers.emplace_back (runChunk, first);
+        }
+
+        runChunk (begin);
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+}
+
+
+#endif // UTILITY_PARALLEL_3GP_HPP
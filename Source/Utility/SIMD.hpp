@@ -0,0 +1,126 @@
+#ifndef UTILITY_SIMD_3GP_HPP
+#define UTILITY_SIMD_3GP_HPP
+
+
+// STL headers.
+#include <cmath>
+
+
+// Engine headers.
+#if defined (__AVX__)
+    #include <immintrin.h>
+    #define UTIL_SIMD_AVX
+#elif defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define UTIL_SIMD_SSE
+#endif
+
+
+namespace util
+{
+    /// <summary>
+    /// A very thin wrapper around the widest float vector instructions the project is compiled with. AVX builds process
+    /// eight lanes at once, SSE2 builds process four and everything else falls back to a single scalar lane.
+    /// </summary>
+    namespace simd
+    {
+        #if defined (UTIL_SIMD_AVX)
+
+            using Float = __m256;                   //!< A vector of floats.
+            const unsigned int width = 8;           //!< How many lanes are processed at once.
+
+            inline Float load (const float* data)           { return _mm256_loadu_ps (data); }
+            inline void  store (float* data, const Float v) { _mm256_storeu_ps (data, v); }
+            inline Float set (const float value)            { return _mm256_set1_ps (value); }
+
+            inline Float add (const Float a, const Float b) { return _mm256_add_ps (a, b); }
+            inline Float sub (const Float a, const Float b) { return _mm256_sub_ps (a, b); }
+            inline Float mul (const Float a, const Float b) { return _mm256_mul_ps (a, b); }
+            inline Float div (const Float a, const Float b) { return _mm256_div_ps (a, b); }
+            inline Float min (const Float a, const Float b) { return _mm256_min_ps (a, b); }
+            inline Float max (const Float a, const Float b) { return _mm256_max_ps (a, b); }
+            inline Float sqrt (const Float a)               { return _mm256_sqrt_ps (a); }
+            inline Float floor (const Float a)              { return _mm256_floor_ps (a); }
+
+            /// <summary> Returns a mask of each lane where a < b. </summary>
+            inline Float less (const Float a, const Float b)            { return _mm256_cmp_ps (a, b, _CMP_LT_OQ); }
+
+            /// <summary> Returns a mask of each lane where a > b. </summary>
+            inline Float greater (const Float a, const Float b)         { return _mm256_cmp_ps (a, b, _CMP_GT_OQ); }
+
+            /// <summary> Combines two masks. </summary>
+            inline Float both (const Float a, const Float b)            { return _mm256_and_ps (a, b); }
+
+            /// <summary> Takes each lane from a where the mask is set and from b where it isn't. </summary>
+            inline Float select (const Float mask, const Float a, const Float b)    { return _mm256_blendv_ps (b, a, mask); }
+
+            /// <summary> Packs the sign of each lane of the mask into the low bits of an integer. </summary>
+            inline int   bits (const Float mask)                        { return _mm256_movemask_ps (mask); }
+
+        #elif defined (UTIL_SIMD_SSE)
+
+            using Float = __m128;
+            const unsigned int width = 4;
+
+            inline Float load (const float* data)           { return _mm_loadu_ps (data); }
+            inline void  store (float* data, const Float v) { _mm_storeu_ps (data, v); }
+            inline Float set (const float value)            { return _mm_set1_ps (value); }
+
+            inline Float add (const Float a, const Float b) { return _mm_add_ps (a, b); }
+            inline Float sub (const Float a, const Float b) { return _mm_sub_ps (a, b); }
+            inline Float mul (const Float a, const Float b) { return _mm_mul_ps (a, b); }
+            inline Float div (const Float a, const Float b) { return _mm_div_ps (a, b); }
+            inline Float min (const Float a, const Float b) { return _mm_min_ps (a, b); }
+            inline Float max (const Float a, const Float b) { return _mm_max_ps (a, b); }
+            inline Float sqrt (const Float a)               { return _mm_sqrt_ps (a); }
+
+            inline Float floor (const Float a)
+            {
+                // SSE2 has no rounding instruction so truncate and correct negative values.
+                const auto truncated = _mm_cvtepi32_ps (_mm_cvttps_epi32 (a));
+                return _mm_sub_ps (truncated, _mm_and_ps (_mm_cmpgt_ps (truncated, a), _mm_set1_ps (1.f)));
+            }
+
+            inline Float less (const Float a, const Float b)            { return _mm_cmplt_ps (a, b); }
+            inline Float greater (const Float a, const Float b)         { return _mm_cmpgt_ps (a, b); }
+            inline Float both (const Float a, const Float b)            { return _mm_and_ps (a, b); }
+            inline Float select (const Float mask, const Float a, const Float b)    { return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b)); }
+            inline int   bits (const Float mask)                        { return _mm_movemask_ps (mask); }
+
+        #else
+
+            using Float = float;
+            const unsigned int width = 1;
+
+            inline Float load (const float* data)           { return *data; }
+            inline void  store (float* data, const Float v) { *data = v; }
+            inline Float set (const float value)            { return value; }
+
+            inline Float add (const Float a, const Float b) { return a + b; }
+            inline Float sub (const Float a, const Float b) { return a - b; }
+            inline Float mul (const Float a, const Float b) { return a * b; }
+            inline Float div (const Float a, const Float b) { return a / b; }
+            inline Float min (const Float a, const Float b) { return a < b ? a : b; }
+            inline Float max (const Float a, const Float b) { return a > b ? a : b; }
+            inline Float sqrt (const Float a)               { return std::sqrt (a); }
+            inline Float floor (const Float a)              { return std::floor (a); }
+
+            // Masks are represented by -1 for true and 0 for false so "bits" reads the sign like the intrinsics do.
+            inline Float less (const Float a, const Float b)            { return a < b ? -1.f : 0.f; }
+            inline Float greater (const Float a, const Float b)         { return a > b ? -1.f : 0.f; }
+            inline Float both (const Float a, const Float b)            { return a != 0.f && b != 0.f ? -1.f : 0.f; }
+            inline Float select (const Float mask, const Float a, const Float b)    { return mask != 0.f ? a : b; }
+            inline int   bits (const Float mask)                        { return mask != 0.f ? 1 : 0; }
+
+        #endif
+
+        /// <summary> Calculates a * b + c. </summary>
+        inline Float madd (const Float a, const Float b, const Float c) { return add (mul (a, b), c); }
+
+        /// <summary> A mask with every lane set, as returned by simd::bits() when a comparison passes for all lanes. </summary>
+        const int allLanes = (1 << width) - 1;
+    }
+}
+
+
+#endif // UTILITY_SIMD_3GP_HPP
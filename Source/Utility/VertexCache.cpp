@@ -0,0 +1,254 @@
+#include "VertexCache.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+
+
+namespace util
+{
+    namespace
+    {
+        /// <summary> Scores a vertex, higher scores are drawn sooner. </summary>
+        /// <param name="position"> The position of the vertex in the cache, negative if it isn't cached. </param>
+        /// <param name="remaining"> How many triangles still need the vertex. </param>
+        /// <param name="cacheSize"> How many vertices the targeted cache holds. </param>
+        float vertexScore (const int position, const unsigned int remaining, const unsigned int cacheSize)
+        {
+            // Nothing needs the vertex any more.
+            if (remaining == 0)
+            {
+                return -1.f;
+            }
+
+            auto score = 0.f;
+
+            if (position >= 0)
+            {
+                // The vertices of the previous triangle get a fixed score so that strip-like orders aren't favoured.
+                if (position < 3)
+                {
+                    score = 0.75f;
+                }
+
+                else
+                {
+                    const auto scale = 1.f / (cacheSize - 3);
+                    score = std::pow (1.f - (position - 3) * scale, 1.5f);
+                }
+            }
+
+            // Vertices with few triangles left are finished off first so they can leave the cache.
+            return score + 2.f / std::sqrt ((float) remaining);
+        }
+    }
+
+
+    VertexCache::Statistics VertexCache::analyse (const std::vector<unsigned int>& elements, const Model model, const unsigned int cacheSize)
+    {
+        Statistics statistics { };
+
+        if (elements.empty())
+        {
+            return statistics;
+        }
+
+        std::deque<unsigned int> cache { };
+        auto misses = 0U;
+
+        for (const auto element : elements)
+        {
+            const auto cached = std::find (cache.begin(), cache.end(), element);
+
+            if (cached == cache.end())
+            {
+                ++misses;
+                cache.push_front (element);
+
+                if (cache.size() > cacheSize)
+                {
+                    cache.pop_back();
+                }
+            }
+
+            else if (model == Model::LRU)
+            {
+                cache.erase (cached);
+                cache.push_front (element);
+            }
+        }
+
+        // Count the unique vertices without modifying the elements.
+        auto unique = elements;
+        std::sort (unique.begin(), unique.end());
+
+        const auto vertexCount = std::unique (unique.begin(), unique.end()) - unique.begin();
+
+        statistics.acmr = (float) misses / (elements.size() / 3);
+        statistics.atvr = (float) misses / vertexCount;
+
+        return statistics;
+    }
+
+
+    void VertexCache::optimise (std::vector<unsigned int>& elements, const unsigned int cacheSize)
+    {
+        assert (elements.size() % 3 == 0 && cacheSize > 3);
+
+        const auto triangleCount = elements.size() / 3;
+        const auto none          = std::numeric_limits<size_t>::max();
+
+        // Stitching references vertices of other patches so map every index onto a dense range first.
+        auto vertices = elements;
+        std::sort (vertices.begin(), vertices.end());
+        vertices.erase (std::unique (vertices.begin(), vertices.end()), vertices.end());
+
+        std::vector<unsigned int> local (elements.size());
+
+        for (size_t i = 0; i < elements.size(); ++i)
+        {
+            local[i] = (unsigned int) (std::lower_bound (vertices.cbegin(), vertices.cend(), elements[i]) - vertices.cbegin());
+        }
+
+        // Build the triangles which use each vertex. Used triangles are swapped beyond the remaining count of a vertex.
+        const auto vertexCount = vertices.size();
+
+        std::vector<unsigned int> remaining (vertexCount, 0), first (vertexCount + 1, 0), adjacency (elements.size());
+
+        for (const auto vertex : local)
+        {
+            ++remaining[vertex];
+        }
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            first[i + 1] = first[i] + remaining[i];
+        }
+
+        {
+            auto fill = first;
+
+            for (size_t i = 0; i < local.size(); ++i)
+            {
+                adjacency[fill[local[i]]++] = (unsigned int) (i / 3);
+            }
+        }
+
+        // Score everything before any triangles are drawn.
+        std::vector<float> vertexScores (vertexCount), triangleScores (triangleCount, 0.f);
+        std::vector<bool>  added (triangleCount, false);
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            vertexScores[i] = vertexScore (-1, remaining[i], cacheSize);
+        }
+
+        for (size_t i = 0; i < local.size(); ++i)
+        {
+            triangleScores[i / 3] += vertexScores[local[i]];
+        }
+
+        auto best = (size_t) (std::max_element (triangleScores.cbegin(), triangleScores.cend()) - triangleScores.cbegin());
+
+        // The cache briefly holds three extra vertices while a triangle is added.
+        std::vector<unsigned int> cache { }, nextCache { };
+        cache.reserve (cacheSize + 3);
+        nextCache.reserve (cacheSize + 3);
+
+        std::vector<unsigned int> output { };
+        output.reserve (elements.size());
+
+        auto scan = size_t { 0 };
+
+        for (size_t drawn = 0; drawn < triangleCount; ++drawn)
+        {
+            // When the cache offers nothing fall back to the first triangle which hasn't been drawn.
+            if (best == none)
+            {
+                while (added[scan])
+                {
+                    ++scan;
+                }
+
+                best = scan;
+            }
+
+            added[best] = true;
+
+            const auto corners = &local[best * 3];
+
+            for (auto i = 0U; i < 3; ++i)
+            {
+                const auto vertex = corners[i];
+
+                output.push_back (elements[best * 3 + i]);
+
+                // Remove the triangle from the remaining triangles of the vertex.
+                const auto begin = adjacency.begin() + first[vertex],
+                           end   = begin + remaining[vertex];
+
+                std::iter_swap (std::find (begin, end, (unsigned int) best), end - 1);
+                --remaining[vertex];
+            }
+
+            // The triangle's vertices move to the front of the cache, pushing everything else back.
+            nextCache.assign (corners, corners + 3);
+
+            for (const auto vertex : cache)
+            {
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+                {
+                    nextCache.push_back (vertex);
+                }
+            }
+
+            std::swap (cache, nextCache);
+
+            // Rescore every vertex whose position changed, including those which fell out of the cache.
+            for (size_t i = 0; i < cache.size(); ++i)
+            {
+                const auto vertex   = cache[i];
+                const auto position = i < cacheSize ? (int) i : -1;
+                const auto score    = vertexScore (position, remaining[vertex], cacheSize);
+                const auto change   = score - vertexScores[vertex];
+
+                vertexScores[vertex]   = score;
+
+                for (auto j = first[vertex]; j < first[vertex] + remaining[vertex]; ++j)
+                {
+                    triangleScores[adjacency[j]] += change;
+                }
+            }
+
+            if (cache.size() > cacheSize)
+            {
+                cache.resize (cacheSize);
+            }
+
+            // The next triangle must use a cached vertex, anything else would almost certainly score lower.
+            best = none;
+            auto bestScore = 0.f;
+
+            for (const auto vertex : cache)
+            {
+                for (auto j = first[vertex]; j < first[vertex] + remaining[vertex]; ++j)
+                {
+                    const auto triangle = adjacency[j];
+
+                    if (best == none || triangleScores[triangle] > bestScore)
+                    {
+                        best      = triangle;
+                        bestScore = triangleScores[triangle];
+                    }
+                }
+            }
+        }
+
+        elements = std::move (output);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef UTILITY_VERTEX_CACHE_3GP_HPP
+#define UTILITY_VERTEX_CACHE_3GP_HPP
+
+
+// STL headers.
+#include <vector>
+
+
+namespace util
+{
+    /// <summary>
+    /// A static class which measures and improves how well a triangle list uses the post-transform vertex cache of the
+    /// GPU. Everything runs on the CPU using a simulated cache so results are repeatable on any machine.
+    /// </summary>
+    class VertexCache final
+    {
+        public:
+
+            /// <summary> The cache size used when none is specified, typical of desktop GPUs. </summary>
+            static const unsigned int defaultSize = 32;
+
+            /// <summary>
+            /// Determines how the simulated cache replaces vertices.
+            /// </summary>
+            enum class Model : int
+            {
+                FIFO,   //!< Hits don't change the order of the cache, the oldest vertex is always replaced. Most GPUs work like this.
+                LRU     //!< Hits move the vertex to the front of the cache, the least recently used vertex is replaced.
+            };
+
+            /// <summary>
+            /// How efficiently a triangle list uses the cache.
+            /// </summary>
+            struct Statistics final
+            {
+                float   acmr    { 0.f };    //!< Average cache miss ratio, transformed vertices per triangle. 0.5 is ideal for a grid, 3 is the worst.
+                float   atvr    { 0.f };    //!< Average transform to vertex ratio, how many times each vertex is transformed. 1 is ideal.
+            };
+
+
+            /// <summary> Simulates drawing a triangle list and measures how often vertices miss the cache. </summary>
+            /// <param name="elements"> The triangle list to measure. </param>
+            /// <param name="model"> How the simulated cache replaces vertices. </param>
+            /// <param name="cacheSize"> How many vertices the simulated cache holds. </param>
+            static Statistics analyse (const std::vector<unsigned int>& elements, const Model model = Model::FIFO,
+                                       const unsigned int cacheSize = defaultSize);
+
+            /// <summary>
+            /// Reorders the triangles of a list using Tom Forsyth's linear-speed vertex cache optimisation. Each vertex is
+            /// scored by how recently it was used and how many triangles still need it, then the triangle with the highest
+            /// total score is drawn next. Triangles keep their winding and indices can be sparse.
+            /// </summary>
+            /// <param name="elements"> The triangle list to reorder. </param>
+            /// <param name="cacheSize"> How many vertices the targeted cache holds. </param>
+            static void optimise (std::vector<unsigned int>& elements, const unsigned int cacheSize = defaultSize);
+    };
+}
+
+
+#endif // UTILITY_VERTEX_CACHE_3GP_HPP
@@ -1,5 +1,7 @@
 #include <crtdbg.h>
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 #include <Framework/MyController.hpp>
 #include <tygra/Window.hpp>
@@ -9,7 +11,10 @@ int main(int argc, char *argv[])
     // enable debug memory checks
     _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
-	std::shared_ptr<MyController> controller = std::make_shared<MyController>();
+    // pass any command line options on to the controller
+    const std::vector<std::string> arguments(argv + 1, argv + argc);
+
+	std::shared_ptr<MyController> controller = std::make_shared<MyController>(arguments);
     std::shared_ptr<tygra::Window> window = tygra::Window::mainWindow();
     window->setController(controller);
 